@@ -0,0 +1,102 @@
+#ifndef NAUGHTY_BUFFERS_ARENA_H
+#define NAUGHTY_BUFFERS_ARENA_H
+
+/**
+ * @file arena.h
+ * This file contains a bump (arena) allocator usable as a ::nb_buffer_memory_context.
+ *
+ * @defgroup arena Arena
+ * An arena hands out memory by bumping a pointer inside big chunks and releases everything at once with
+ * ::nb_arena_reset. Reallocating the most recent allocation grows it in place, which makes it a good fit for the last
+ * buffer being filled. Releasing memory is a no-op, except for the most recent allocation, which is given back.
+ *
+ * Use it for short-lived (e.g, request-scoped) buffers: initialize them with the memory context returned by
+ * ::nb_arena_memory_context and reset the arena when all of them are done. There's no need to call ::nb_release on
+ * them, but it is harmless to do so.
+ *
+ * An arena is not thread-safe.
+ */
+
+#include "naughty-buffers/buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief An opaque arena allocator. Create it with ::nb_arena_create.
+ * @ingroup arena
+ */
+struct nb_arena;
+
+/**
+ * @brief Creates an arena that allocates memory from the system in chunks of at least `chunk_size` bytes.
+ *
+ * **Example**
+ * @code
+  int main(void) {
+    struct nb_arena * arena = nb_arena_create(64 * 1024);
+
+    for (int request = 0; request < 1000; request++) {
+      struct nb_buffer scratch;
+      nb_init_advanced(&scratch, sizeof(int), nb_arena_memory_context(arena));
+
+      int value = request;
+      nb_push(&scratch, &value);
+
+      nb_arena_reset(arena); // scratch is gone
+    }
+
+    nb_arena_destroy(arena);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param chunk_size Minimum size, in bytes, of each chunk requested to the system
+ * @return A pointer to the new arena or NULL if out of memory
+ * @ingroup arena
+ */
+NAUGHTY_BUFFERS_EXPORT struct nb_arena * nb_arena_create(size_t chunk_size);
+
+/**
+ * @brief Returns a memory context that allocates from the arena, to be used with ::nb_init_advanced and friends.
+ *
+ * The returned pointer is valid until the arena is destroyed.
+ *
+ * @param arena A pointer returned by ::nb_arena_create
+ * @return A pointer to the arena memory context
+ * @ingroup arena
+ */
+NAUGHTY_BUFFERS_EXPORT struct nb_buffer_memory_context * nb_arena_memory_context(struct nb_arena * arena);
+
+/**
+ * @brief Releases, in constant time, all memory allocated from the arena.
+ *
+ * Chunks are kept and reused by later allocations. All buffers using the arena become invalid and must not be used,
+ * except for being initialized again.
+ *
+ * @param arena A pointer returned by ::nb_arena_create
+ * @ingroup arena
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_arena_reset(struct nb_arena * arena);
+
+/**
+ * @brief Returns the amount of bytes allocated from the arena since it was created or last reset.
+ * @param arena A pointer returned by ::nb_arena_create
+ * @return Allocated bytes, including per-allocation headers and padding
+ * @ingroup arena
+ */
+NAUGHTY_BUFFERS_EXPORT size_t nb_arena_used(const struct nb_arena * arena);
+
+/**
+ * @brief Gives all arena chunks back to the system and destroys the arena.
+ * @param arena A pointer returned by ::nb_arena_create
+ * @ingroup arena
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_arena_destroy(struct nb_arena * arena);
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif // NAUGHTY_BUFFERS_ARENA_H
@@ -45,6 +45,10 @@
  * Most useful when the block size is at most `sizeof(ptrdiff_t)`.
  * - `void T_push_ptr(struct T_array *, const T *)`, analogous to ::nb_push and useful when the block size is greater
  * than `sizeof(ptrdiff_t)`.
+ * - `void T_push_many(struct T_array *, const T *, size_t)`, analogous to ::nb_push_many.
+ * - `size_t T_pop_many(struct T_array *, T *, size_t)`, analogous to ::nb_pop_many.
+ * - `T * T_push_uninit(struct T_array *, size_t)`, analogous to ::nb_push_uninit.
+ * - `T * T_emplace_back(struct T_array *)`, analogous to ::nb_emplace_back.
  * - `void T_assign(struct T_array *, size_t, const T)`, analogous to ::nb_assign but accepting a copy of the item as an
  * argument. Most useful when the block size is at most `sizeof(ptrdiff_t)`.
  * - `void T_assign_ptr(struct T_array *, size_t, const T *)`, analogous to ::nb_assign and useful when the block
@@ -53,6 +57,8 @@
  * argument. Most useful when the block size is at most `sizeof(ptrdiff_t)`.
  * - `void T_insert_ptr(struct T_array *, size_t, const T *)`, analogous to ::nb_insert and useful when the block
  * size is greater than `sizeof(ptrdiff_t)`.
+ * - `void T_insert_many(struct T_array *, size_t, const T *, size_t)`, analogous to ::nb_insert_many.
+ * - `void T_insert_batch(struct T_array *, const size_t *, const T *, size_t)`, analogous to ::nb_insert_batch.
  * - `size_t T_count(struct T_array *)`, analogous to ::nb_block_count
  * - `T T_at(struct T_array *, size_t)`, analogous to ::nb_at but returning a copy of the block in the array. Most
  * useful when the block size is at most `sizeof(ptrdiff_t)`.
@@ -67,13 +73,37 @@
  * - `T * T_back_ptr(struct T_array *)`, analogous to ::nb_back but returning a pointer to the data directly in the
  * array. Useful when the block size is greater than `sizeof(ptrdiff_t)`.
  * - `void T_remove_at(struct T *, size_t)`, analogous to ::nb_remove_at.
+ * - `void T_swap_remove(struct T *, size_t)`, analogous to ::nb_swap_remove.
+ * - `size_t T_remove_range(struct T *, size_t, size_t)`, analogous to ::nb_remove_range.
+ * - `size_t T_remove_if(struct T *, nb_predicate_fn, void *)`, analogous to ::nb_remove_if. The predicate receives
+ * pointers to `T`.
+ * - `size_t T_remove_indices(struct T *, const size_t *, size_t)`, analogous to ::nb_remove_indices.
  * - `void T_remove_back(struct T *)`, analogous to ::nb_remove_back
  * - `void T_remove_front(struct T *)`, analogous to ::nb_remove_front
  * - `void T_sort(struct T *, nb_compare_fn)`, analogous to ::nb_sort
  * - `void T_release(struct T *)`, analogous to ::nb_release
+ *
+ * **Inline storage**
+ *
+ * `NAUGHTY_BUFFERS_INLINE_ARRAY_DECLARATION(T_array, T, N)` and `NAUGHTY_BUFFERS_INLINE_ARRAY_DEFINITION(T_array, T, N)`
+ * generate the same functions, but `struct T_array` also holds room for `N` blocks and memory is only allocated once
+ * the array grows past them (see ::nb_init_inline).
+ *
+ * **Specialized sort**
+ *
+ * `NAUGHTY_BUFFERS_ARRAY_SORT_DECLARATION(T_array, T)` and `NAUGHTY_BUFFERS_ARRAY_SORT_DEFINITION(T_array, T, less)`
+ * add `void T_introsort(struct T_array *)`, a sort written for `T` with the `less` expression inlined into it. It is
+ * usually about twice as fast as `T_sort`.
+ *
+ * **Specialized search**
+ *
+ * `NAUGHTY_BUFFERS_ARRAY_SEARCH_DECLARATION(T_array, T)` and `NAUGHTY_BUFFERS_ARRAY_SEARCH_DEFINITION(T_array, T, less)`
+ * add `T_lower_bound`, `T_upper_bound`, `T_equal_range` and `T_insert_sorted`, binary searches with the `less`
+ * expression inlined and no branches in their loop.
  */
 
 #include "naughty-buffers/buffer.h"
+#include "naughty-buffers/search.h"
 
 /**
  * @brief Declares a struct named using `__NB_ARRAY_TYPE__` to handle blocks of type `__NB_ARRAY_BLOCK_TYPE__`.
@@ -83,12 +113,51 @@
   struct __NB_ARRAY_TYPE__ {                                                                                           \
     struct nb_buffer buffer;                                                                                           \
   };                                                                                                                   \
+  NAUGHTY_BUFFERS_ARRAY_FUNCTIONS_DECLARATION(__NB_ARRAY_TYPE__, __NB_ARRAY_BLOCK_TYPE__)
+
+/**
+ * @brief Declares a struct named using `__NB_ARRAY_TYPE__` to handle blocks of type `__NB_ARRAY_BLOCK_TYPE__` keeping
+ * the first `__NB_ARRAY_INLINE_COUNT__` blocks inside the struct itself.
+ *
+ * The generated struct has an extra `inline_blocks` member and the generated functions are the same as the ones
+ * from `NAUGHTY_BUFFERS_ARRAY_DECLARATION`. No memory is allocated until the array holds more than
+ * `__NB_ARRAY_INLINE_COUNT__` blocks. See ::nb_init_inline.
+ *
+ * @warning The struct must not be copied or moved after being initialized.
+ * @ingroup array-generator
+ */
+#define NAUGHTY_BUFFERS_INLINE_ARRAY_DECLARATION(__NB_ARRAY_TYPE__, __NB_ARRAY_BLOCK_TYPE__, __NB_ARRAY_INLINE_COUNT__) \
+  struct __NB_ARRAY_TYPE__ {                                                                                           \
+    struct nb_buffer buffer;                                                                                           \
+    __NB_ARRAY_BLOCK_TYPE__ inline_blocks[__NB_ARRAY_INLINE_COUNT__];                                                  \
+  };                                                                                                                   \
+  NAUGHTY_BUFFERS_ARRAY_FUNCTIONS_DECLARATION(__NB_ARRAY_TYPE__, __NB_ARRAY_BLOCK_TYPE__)
+
+/**
+ * @brief Declares the functions shared by `NAUGHTY_BUFFERS_ARRAY_DECLARATION` and
+ * `NAUGHTY_BUFFERS_INLINE_ARRAY_DECLARATION`. Not meant to be used directly.
+ * @ingroup array-generator
+ */
+#define NAUGHTY_BUFFERS_ARRAY_FUNCTIONS_DECLARATION(__NB_ARRAY_TYPE__, __NB_ARRAY_BLOCK_TYPE__)                        \
   void __NB_ARRAY_TYPE__##_init(struct __NB_ARRAY_TYPE__ * array);                                                     \
   void __NB_ARRAY_TYPE__##_init_advanced(struct __NB_ARRAY_TYPE__ * array, struct nb_buffer_memory_context * ctx);     \
   enum NB_PUSH_RESULT __NB_ARRAY_TYPE__##_push(struct __NB_ARRAY_TYPE__ * array, const __NB_ARRAY_BLOCK_TYPE__ item);  \
   enum NB_PUSH_RESULT __NB_ARRAY_TYPE__##_push_ptr(                                                                    \
       struct __NB_ARRAY_TYPE__ * array, const __NB_ARRAY_BLOCK_TYPE__ * item                                           \
   );                                                                                                                   \
+  enum NB_PUSH_RESULT __NB_ARRAY_TYPE__##_push_many(                                                                   \
+      struct __NB_ARRAY_TYPE__ * array, const __NB_ARRAY_BLOCK_TYPE__ * items, size_t count                            \
+  );                                                                                                                   \
+  size_t __NB_ARRAY_TYPE__##_pop_many(                                                                                 \
+      struct __NB_ARRAY_TYPE__ * array, __NB_ARRAY_BLOCK_TYPE__ * items, size_t count                                  \
+  );                                                                                                                   \
+  __NB_ARRAY_BLOCK_TYPE__ * __NB_ARRAY_TYPE__##_push_uninit(struct __NB_ARRAY_TYPE__ * array, size_t count);           \
+  __NB_ARRAY_BLOCK_TYPE__ * __NB_ARRAY_TYPE__##_emplace_back(struct __NB_ARRAY_TYPE__ * array);                        \
+  enum NB_PUSH_RESULT __NB_ARRAY_TYPE__##_push_front(                                                                  \
+      struct __NB_ARRAY_TYPE__ * array, const __NB_ARRAY_BLOCK_TYPE__ item                                             \
+  );                                                                                                                   \
+  enum NB_POP_RESULT __NB_ARRAY_TYPE__##_pop_front(struct __NB_ARRAY_TYPE__ * array, __NB_ARRAY_BLOCK_TYPE__ * item);  \
+  enum NB_POP_RESULT __NB_ARRAY_TYPE__##_pop_back(struct __NB_ARRAY_TYPE__ * array, __NB_ARRAY_BLOCK_TYPE__ * item);   \
   enum NB_ASSIGN_RESULT __NB_ARRAY_TYPE__##_assign(                                                                    \
       struct __NB_ARRAY_TYPE__ * array, size_t index, const __NB_ARRAY_BLOCK_TYPE__ item                               \
   );                                                                                                                   \
@@ -101,6 +170,15 @@
   enum NB_INSERT_RESULT __NB_ARRAY_TYPE__##_insert_ptr(                                                                \
       struct __NB_ARRAY_TYPE__ * array, size_t index, const __NB_ARRAY_BLOCK_TYPE__ * item                             \
   );                                                                                                                   \
+  enum NB_INSERT_RESULT __NB_ARRAY_TYPE__##_insert_many(                                                               \
+      struct __NB_ARRAY_TYPE__ * array, size_t index, const __NB_ARRAY_BLOCK_TYPE__ * items, size_t count              \
+  );                                                                                                                   \
+  enum NB_INSERT_RESULT __NB_ARRAY_TYPE__##_insert_batch(                                                              \
+      struct __NB_ARRAY_TYPE__ * array,                                                                                \
+      const size_t * sorted_indices,                                                                                   \
+      const __NB_ARRAY_BLOCK_TYPE__ * items,                                                                           \
+      size_t count                                                                                                     \
+  );                                                                                                                   \
   size_t __NB_ARRAY_TYPE__##_count(struct __NB_ARRAY_TYPE__ * array);                                                  \
   __NB_ARRAY_BLOCK_TYPE__ __NB_ARRAY_TYPE__##_at(struct __NB_ARRAY_TYPE__ * buffer, size_t index);                     \
   __NB_ARRAY_BLOCK_TYPE__ * __NB_ARRAY_TYPE__##_at_ptr(struct __NB_ARRAY_TYPE__ * buffer, size_t index);               \
@@ -109,10 +187,18 @@
   __NB_ARRAY_BLOCK_TYPE__ __NB_ARRAY_TYPE__##_front(struct __NB_ARRAY_TYPE__ * buffer);                                \
   __NB_ARRAY_BLOCK_TYPE__ __NB_ARRAY_TYPE__##_back(struct __NB_ARRAY_TYPE__ * buffer);                                 \
   void __NB_ARRAY_TYPE__##_remove_at(struct __NB_ARRAY_TYPE__ * buffer, size_t index);                                 \
+  void __NB_ARRAY_TYPE__##_swap_remove(struct __NB_ARRAY_TYPE__ * array, size_t index);                                \
+  size_t __NB_ARRAY_TYPE__##_remove_range(struct __NB_ARRAY_TYPE__ * array, size_t first_index, size_t count);         \
+  size_t __NB_ARRAY_TYPE__##_remove_if(                                                                                \
+      struct __NB_ARRAY_TYPE__ * array, nb_predicate_fn predicate_fn, void * context                                   \
+  );                                                                                                                   \
+  size_t __NB_ARRAY_TYPE__##_remove_indices(                                                                           \
+      struct __NB_ARRAY_TYPE__ * array, const size_t * sorted_indices, size_t index_count                              \
+  );                                                                                                                   \
   void __NB_ARRAY_TYPE__##_remove_front(struct __NB_ARRAY_TYPE__ * buffer);                                            \
   void __NB_ARRAY_TYPE__##_remove_back(struct __NB_ARRAY_TYPE__ * buffer);                                             \
   void __NB_ARRAY_TYPE__##_sort(struct __NB_ARRAY_TYPE__ * buffer, nb_compare_fn compare_fn);                          \
-  void __NB_ARRAY__TYPE__##_release(struct __NB_ARRAY_TYPE__ * array);
+  void __NB_ARRAY_TYPE__##_release(struct __NB_ARRAY_TYPE__ * array);
 
 /**
  * @brief Generates definitions for functions declared with `NAUGHTY_BUFFERS_ARRAY_DECLARATION`.
@@ -125,6 +211,31 @@
   void __NB_ARRAY_TYPE__##_init_advanced(struct __NB_ARRAY_TYPE__ * array, struct nb_buffer_memory_context * ctx) {    \
     nb_init_advanced(&array->buffer, sizeof(__NB_ARRAY_BLOCK_TYPE__), ctx);                                            \
   }                                                                                                                    \
+  NAUGHTY_BUFFERS_ARRAY_FUNCTIONS_DEFINITION(__NB_ARRAY_TYPE__, __NB_ARRAY_BLOCK_TYPE__)
+
+/**
+ * @brief Generates definitions for functions declared with `NAUGHTY_BUFFERS_INLINE_ARRAY_DECLARATION`.
+ * @ingroup array-generator
+ */
+#define NAUGHTY_BUFFERS_INLINE_ARRAY_DEFINITION(__NB_ARRAY_TYPE__, __NB_ARRAY_BLOCK_TYPE__, __NB_ARRAY_INLINE_COUNT__) \
+  void __NB_ARRAY_TYPE__##_init(struct __NB_ARRAY_TYPE__ * array) {                                                    \
+    nb_init_inline(                                                                                                    \
+        &array->buffer, sizeof(__NB_ARRAY_BLOCK_TYPE__), array->inline_blocks, __NB_ARRAY_INLINE_COUNT__               \
+    );                                                                                                                 \
+  }                                                                                                                    \
+  void __NB_ARRAY_TYPE__##_init_advanced(struct __NB_ARRAY_TYPE__ * array, struct nb_buffer_memory_context * ctx) {    \
+    nb_init_inline_advanced(                                                                                           \
+        &array->buffer, sizeof(__NB_ARRAY_BLOCK_TYPE__), array->inline_blocks, __NB_ARRAY_INLINE_COUNT__, ctx          \
+    );                                                                                                                 \
+  }                                                                                                                    \
+  NAUGHTY_BUFFERS_ARRAY_FUNCTIONS_DEFINITION(__NB_ARRAY_TYPE__, __NB_ARRAY_BLOCK_TYPE__)
+
+/**
+ * @brief Generates the definitions shared by `NAUGHTY_BUFFERS_ARRAY_DEFINITION` and
+ * `NAUGHTY_BUFFERS_INLINE_ARRAY_DEFINITION`. Not meant to be used directly.
+ * @ingroup array-generator
+ */
+#define NAUGHTY_BUFFERS_ARRAY_FUNCTIONS_DEFINITION(__NB_ARRAY_TYPE__, __NB_ARRAY_BLOCK_TYPE__)                         \
   enum NB_PUSH_RESULT __NB_ARRAY_TYPE__##_push(struct __NB_ARRAY_TYPE__ * array, const __NB_ARRAY_BLOCK_TYPE__ item) { \
     return nb_push(&array->buffer, (void *)&item);                                                                     \
   }                                                                                                                    \
@@ -133,6 +244,33 @@
   ) {                                                                                                                  \
     return nb_push(&array->buffer, (void *)item);                                                                      \
   }                                                                                                                    \
+  enum NB_PUSH_RESULT __NB_ARRAY_TYPE__##_push_many(                                                                   \
+      struct __NB_ARRAY_TYPE__ * array, const __NB_ARRAY_BLOCK_TYPE__ * items, size_t count                            \
+  ) {                                                                                                                  \
+    return nb_push_many(&array->buffer, (void *)items, count);                                                         \
+  }                                                                                                                    \
+  size_t __NB_ARRAY_TYPE__##_pop_many(                                                                                 \
+      struct __NB_ARRAY_TYPE__ * array, __NB_ARRAY_BLOCK_TYPE__ * items, size_t count                                  \
+  ) {                                                                                                                  \
+    return nb_pop_many(&array->buffer, (void *)items, count);                                                          \
+  }                                                                                                                    \
+  __NB_ARRAY_BLOCK_TYPE__ * __NB_ARRAY_TYPE__##_push_uninit(struct __NB_ARRAY_TYPE__ * array, size_t count) {          \
+    return (__NB_ARRAY_BLOCK_TYPE__ *)nb_push_uninit(&array->buffer, count);                                           \
+  }                                                                                                                    \
+  __NB_ARRAY_BLOCK_TYPE__ * __NB_ARRAY_TYPE__##_emplace_back(struct __NB_ARRAY_TYPE__ * array) {                       \
+    return (__NB_ARRAY_BLOCK_TYPE__ *)nb_emplace_back(&array->buffer);                                                 \
+  }                                                                                                                    \
+  enum NB_PUSH_RESULT __NB_ARRAY_TYPE__##_push_front(                                                                  \
+      struct __NB_ARRAY_TYPE__ * array, const __NB_ARRAY_BLOCK_TYPE__ item                                             \
+  ) {                                                                                                                  \
+    return nb_push_front(&array->buffer, (void *)&item);                                                               \
+  }                                                                                                                    \
+  enum NB_POP_RESULT __NB_ARRAY_TYPE__##_pop_front(struct __NB_ARRAY_TYPE__ * array, __NB_ARRAY_BLOCK_TYPE__ * item) { \
+    return nb_pop_front(&array->buffer, (void *)item);                                                                 \
+  }                                                                                                                    \
+  enum NB_POP_RESULT __NB_ARRAY_TYPE__##_pop_back(struct __NB_ARRAY_TYPE__ * array, __NB_ARRAY_BLOCK_TYPE__ * item) {  \
+    return nb_pop_back(&array->buffer, (void *)item);                                                                  \
+  }                                                                                                                    \
   enum NB_ASSIGN_RESULT __NB_ARRAY_TYPE__##_assign(                                                                    \
       struct __NB_ARRAY_TYPE__ * array, size_t index, const __NB_ARRAY_BLOCK_TYPE__ item                               \
   ) {                                                                                                                  \
@@ -153,6 +291,19 @@
       struct __NB_ARRAY_TYPE__ * array, size_t index, const __NB_ARRAY_BLOCK_TYPE__ * item                             \
   ) {                                                                                                                  \
     return nb_insert(&array->buffer, index, (void *)item);                                                             \
+  }                                                                                                                    \
+  enum NB_INSERT_RESULT __NB_ARRAY_TYPE__##_insert_many(                                                               \
+      struct __NB_ARRAY_TYPE__ * array, size_t index, const __NB_ARRAY_BLOCK_TYPE__ * items, size_t count              \
+  ) {                                                                                                                  \
+    return nb_insert_many(&array->buffer, index, (void *)items, count);                                                \
+  }                                                                                                                    \
+  enum NB_INSERT_RESULT __NB_ARRAY_TYPE__##_insert_batch(                                                              \
+      struct __NB_ARRAY_TYPE__ * array,                                                                                \
+      const size_t * sorted_indices,                                                                                   \
+      const __NB_ARRAY_BLOCK_TYPE__ * items,                                                                           \
+      size_t count                                                                                                     \
+  ) {                                                                                                                  \
+    return nb_insert_batch(&array->buffer, sorted_indices, (void *)items, count);                                      \
   }                                                                                                                    \
                                                                                                                        \
   __NB_ARRAY_BLOCK_TYPE__ * __NB_ARRAY_TYPE__##_front_ptr(struct __NB_ARRAY_TYPE__ * array) {                          \
@@ -175,6 +326,26 @@
     nb_remove_at(&array->buffer, index);                                                                               \
   }                                                                                                                    \
                                                                                                                        \
+  void __NB_ARRAY_TYPE__##_swap_remove(struct __NB_ARRAY_TYPE__ * array, size_t index) {                               \
+    nb_swap_remove(&array->buffer, index);                                                                             \
+  }                                                                                                                    \
+                                                                                                                       \
+  size_t __NB_ARRAY_TYPE__##_remove_range(struct __NB_ARRAY_TYPE__ * array, size_t first_index, size_t count) {        \
+    return nb_remove_range(&array->buffer, first_index, count);                                                        \
+  }                                                                                                                    \
+                                                                                                                       \
+  size_t __NB_ARRAY_TYPE__##_remove_if(                                                                                \
+      struct __NB_ARRAY_TYPE__ * array, nb_predicate_fn predicate_fn, void * context                                   \
+  ) {                                                                                                                  \
+    return nb_remove_if(&array->buffer, predicate_fn, context);                                                        \
+  }                                                                                                                    \
+                                                                                                                       \
+  size_t __NB_ARRAY_TYPE__##_remove_indices(                                                                           \
+      struct __NB_ARRAY_TYPE__ * array, const size_t * sorted_indices, size_t index_count                              \
+  ) {                                                                                                                  \
+    return nb_remove_indices(&array->buffer, sorted_indices, index_count);                                             \
+  }                                                                                                                    \
+                                                                                                                       \
   void __NB_ARRAY_TYPE__##_remove_back(struct __NB_ARRAY_TYPE__ * array) { nb_remove_back(&array->buffer); }           \
                                                                                                                        \
   void __NB_ARRAY_TYPE__##_remove_front(struct __NB_ARRAY_TYPE__ * array) { nb_remove_front(&array->buffer); }         \
@@ -195,4 +366,216 @@
                                                                                                                        \
   void __NB_ARRAY_TYPE__##_release(struct __NB_ARRAY_TYPE__ * array) { nb_release(&array->buffer); }
 
+/**
+ * @brief Declares `__NB_ARRAY_TYPE__##_introsort`, a sort specialized for arrays of `__NB_ARRAY_BLOCK_TYPE__`. See
+ * `NAUGHTY_BUFFERS_ARRAY_SORT_DEFINITION`.
+ * @ingroup array-generator
+ */
+#define NAUGHTY_BUFFERS_ARRAY_SORT_DECLARATION(__NB_ARRAY_TYPE__, __NB_ARRAY_BLOCK_TYPE__)                             \
+  void __NB_ARRAY_TYPE__##_introsort(struct __NB_ARRAY_TYPE__ * array);
+
+/**
+ * @brief Generates `__NB_ARRAY_TYPE__##_introsort`, which sorts the array in ascending order according to `__NB_LESS__`.
+ *
+ * `__NB_LESS__` is an expression over `a` and `b`, both `const __NB_ARRAY_BLOCK_TYPE__ *`, that is true when `*a` must
+ * come before `*b`. It is pasted into the generated code, so the compiler can inline it and move whole blocks instead
+ * of calling a comparison function through a pointer and swapping bytes like ::nb_sort does. Wrap it in parentheses if
+ * it has commas outside of parentheses.
+ *
+ * The sort is an introsort: a median-of-three quicksort that switches to heapsort when the recursion gets too deep and
+ * to insertion sort for small ranges, running in O(n log n) in the worst case. It is not stable. The array type must
+ * have been declared and defined with any of the other array generator macros.
+ *
+ * **Example**
+ * @code
+ * // file: int-array.h
+ * NAUGHTY_BUFFERS_ARRAY_DECLARATION(int_array, int)
+ * NAUGHTY_BUFFERS_ARRAY_SORT_DECLARATION(int_array, int)
+ *
+ * // file: int-array.c
+ * NAUGHTY_BUFFERS_ARRAY_DEFINITION(int_array, int)
+ * NAUGHTY_BUFFERS_ARRAY_SORT_DEFINITION(int_array, int, *a < *b)
+ *
+ * // later: int_array_introsort(&array);
+ * @endcode
+ * @ingroup array-generator
+ */
+#define NAUGHTY_BUFFERS_ARRAY_SORT_DEFINITION(__NB_ARRAY_TYPE__, __NB_ARRAY_BLOCK_TYPE__, __NB_LESS__)                 \
+  static int __NB_ARRAY_TYPE__##_introsort_less(const __NB_ARRAY_BLOCK_TYPE__ * a, const __NB_ARRAY_BLOCK_TYPE__ * b) { \
+    return (__NB_LESS__);                                                                                              \
+  }                                                                                                                    \
+                                                                                                                       \
+  static void __NB_ARRAY_TYPE__##_introsort_swap(__NB_ARRAY_BLOCK_TYPE__ * a, __NB_ARRAY_BLOCK_TYPE__ * b) {           \
+    __NB_ARRAY_BLOCK_TYPE__ swapped = *a;                                                                              \
+    *a = *b;                                                                                                           \
+    *b = swapped;                                                                                                      \
+  }                                                                                                                    \
+                                                                                                                       \
+  static void __NB_ARRAY_TYPE__##_introsort_insertion(__NB_ARRAY_BLOCK_TYPE__ * blocks, size_t count) {                \
+    for (size_t i = 1; i < count; i++) {                                                                               \
+      __NB_ARRAY_BLOCK_TYPE__ value = blocks[i];                                                                       \
+      size_t j = i;                                                                                                    \
+      for (; j > 0 && __NB_ARRAY_TYPE__##_introsort_less(&value, blocks + j - 1); j--) blocks[j] = blocks[j - 1];      \
+      blocks[j] = value;                                                                                               \
+    }                                                                                                                  \
+  }                                                                                                                    \
+                                                                                                                       \
+  static void __NB_ARRAY_TYPE__##_introsort_sift(__NB_ARRAY_BLOCK_TYPE__ * blocks, size_t root, size_t count) {        \
+    for (;;) {                                                                                                         \
+      size_t child = root * 2 + 1;                                                                                     \
+      if (child >= count) return;                                                                                      \
+      if (child + 1 < count && __NB_ARRAY_TYPE__##_introsort_less(blocks + child, blocks + child + 1)) child++;        \
+      if (!__NB_ARRAY_TYPE__##_introsort_less(blocks + root, blocks + child)) return;                                  \
+      __NB_ARRAY_TYPE__##_introsort_swap(blocks + root, blocks + child);                                               \
+      root = child;                                                                                                    \
+    }                                                                                                                  \
+  }                                                                                                                    \
+                                                                                                                       \
+  static void __NB_ARRAY_TYPE__##_introsort_heap(__NB_ARRAY_BLOCK_TYPE__ * blocks, size_t count) {                     \
+    for (size_t i = count / 2; i > 0; i--) __NB_ARRAY_TYPE__##_introsort_sift(blocks, i - 1, count);                   \
+    for (size_t end = count - 1; end > 0; end--) {                                                                     \
+      __NB_ARRAY_TYPE__##_introsort_swap(blocks, blocks + end);                                                        \
+      __NB_ARRAY_TYPE__##_introsort_sift(blocks, 0, end);                                                              \
+    }                                                                                                                  \
+  }                                                                                                                    \
+                                                                                                                       \
+  static void __NB_ARRAY_TYPE__##_introsort_loop(__NB_ARRAY_BLOCK_TYPE__ * blocks, size_t count, size_t depth) {       \
+    while (count > 16) {                                                                                               \
+      if (depth-- == 0) {                                                                                              \
+        __NB_ARRAY_TYPE__##_introsort_heap(blocks, count);                                                             \
+        return;                                                                                                        \
+      }                                                                                                                \
+                                                                                                                       \
+      /* orders first, middle and last so they stop the partition scans without bound checks */                        \
+      __NB_ARRAY_BLOCK_TYPE__ * middle = blocks + count / 2;                                                           \
+      __NB_ARRAY_BLOCK_TYPE__ * last = blocks + count - 1;                                                             \
+      if (__NB_ARRAY_TYPE__##_introsort_less(middle, blocks)) __NB_ARRAY_TYPE__##_introsort_swap(middle, blocks);      \
+      if (__NB_ARRAY_TYPE__##_introsort_less(last, middle)) {                                                          \
+        __NB_ARRAY_TYPE__##_introsort_swap(last, middle);                                                              \
+        if (__NB_ARRAY_TYPE__##_introsort_less(middle, blocks)) __NB_ARRAY_TYPE__##_introsort_swap(middle, blocks);    \
+      }                                                                                                                \
+                                                                                                                       \
+      const __NB_ARRAY_BLOCK_TYPE__ pivot = *middle;                                                                   \
+      size_t i = 0;                                                                                                    \
+      size_t j = count - 1;                                                                                            \
+      for (;;) {                                                                                                       \
+        while (__NB_ARRAY_TYPE__##_introsort_less(blocks + i, &pivot)) i++;                                            \
+        while (__NB_ARRAY_TYPE__##_introsort_less(&pivot, blocks + j)) j--;                                            \
+        if (i >= j) break;                                                                                             \
+        __NB_ARRAY_TYPE__##_introsort_swap(blocks + i, blocks + j);                                                    \
+        i++;                                                                                                           \
+        j--;                                                                                                           \
+      }                                                                                                                \
+                                                                                                                       \
+      /* recurses into the smaller side and loops over the bigger one, keeping the stack at O(log n) */                \
+      if (i < count - i) {                                                                                             \
+        __NB_ARRAY_TYPE__##_introsort_loop(blocks, i, depth);                                                          \
+        blocks += i;                                                                                                   \
+        count -= i;                                                                                                    \
+      } else {                                                                                                         \
+        __NB_ARRAY_TYPE__##_introsort_loop(blocks + i, count - i, depth);                                              \
+        count = i;                                                                                                     \
+      }                                                                                                                \
+    }                                                                                                                  \
+    __NB_ARRAY_TYPE__##_introsort_insertion(blocks, count);                                                            \
+  }                                                                                                                    \
+                                                                                                                       \
+  void __NB_ARRAY_TYPE__##_introsort(struct __NB_ARRAY_TYPE__ * array) {                                               \
+    size_t count = nb_block_count(&array->buffer);                                                                     \
+    size_t depth = 0;                                                                                                  \
+    for (size_t n = count; n > 1; n >>= 1) depth += 2;                                                                 \
+    __NB_ARRAY_TYPE__##_introsort_loop((__NB_ARRAY_BLOCK_TYPE__ *)nb_at(&array->buffer, 0), count, depth);             \
+    nb_set_sorted_count(&array->buffer, count);                                                                        \
+  }
+
+/**
+ * @brief Declares `__NB_ARRAY_TYPE__##_lower_bound`, `_upper_bound`, `_equal_range` and `_insert_sorted`, searches
+ * specialized for arrays of `__NB_ARRAY_BLOCK_TYPE__`. See `NAUGHTY_BUFFERS_ARRAY_SEARCH_DEFINITION`.
+ * @ingroup array-generator
+ */
+#define NAUGHTY_BUFFERS_ARRAY_SEARCH_DECLARATION(__NB_ARRAY_TYPE__, __NB_ARRAY_BLOCK_TYPE__)                           \
+  size_t __NB_ARRAY_TYPE__##_lower_bound(struct __NB_ARRAY_TYPE__ * array, const __NB_ARRAY_BLOCK_TYPE__ * key);       \
+  size_t __NB_ARRAY_TYPE__##_upper_bound(struct __NB_ARRAY_TYPE__ * array, const __NB_ARRAY_BLOCK_TYPE__ * key);       \
+  struct nb_index_range __NB_ARRAY_TYPE__##_equal_range(                                                               \
+      struct __NB_ARRAY_TYPE__ * array, const __NB_ARRAY_BLOCK_TYPE__ * key                                            \
+  );                                                                                                                   \
+  enum NB_INSERT_RESULT __NB_ARRAY_TYPE__##_insert_sorted(                                                             \
+      struct __NB_ARRAY_TYPE__ * array, const __NB_ARRAY_BLOCK_TYPE__ item                                             \
+  );
+
+/**
+ * @brief Generates binary searches over arrays sorted in ascending order according to `__NB_LESS__`.
+ *
+ * `__NB_LESS__` is an expression over `a` and `b`, both `const __NB_ARRAY_BLOCK_TYPE__ *`, that is true when `*a` must
+ * come before `*b`, like in `NAUGHTY_BUFFERS_ARRAY_SORT_DEFINITION`. It is pasted into the generated code, and the
+ * search loop picks the next half with a conditional expression instead of a branch, so compilers emit conditional
+ * moves and lookups do not suffer from branch mispredictions. The generated functions are:
+ *
+ * - `size_t T_lower_bound(struct T_array *, const T *)`, analogous to ::nb_lower_bound
+ * - `size_t T_upper_bound(struct T_array *, const T *)`, analogous to ::nb_upper_bound
+ * - `struct nb_index_range T_equal_range(struct T_array *, const T *)`, analogous to ::nb_equal_range
+ * - `enum NB_INSERT_RESULT T_insert_sorted(struct T_array *, const T)`, analogous to ::nb_insert_sorted
+ *
+ * The key is a whole `__NB_ARRAY_BLOCK_TYPE__`, of which only the fields used by `__NB_LESS__` need to be set.
+ *
+ * **Example**
+ * @code
+ * NAUGHTY_BUFFERS_ARRAY_SEARCH_DEFINITION(int_array, int, *a < *b)
+ *
+ * // later: int key = 42; size_t index = int_array_lower_bound(&array, &key);
+ * @endcode
+ * @ingroup array-generator
+ */
+#define NAUGHTY_BUFFERS_ARRAY_SEARCH_DEFINITION(__NB_ARRAY_TYPE__, __NB_ARRAY_BLOCK_TYPE__, __NB_LESS__)               \
+  static int __NB_ARRAY_TYPE__##_search_less(const __NB_ARRAY_BLOCK_TYPE__ * a, const __NB_ARRAY_BLOCK_TYPE__ * b) {   \
+    return (__NB_LESS__);                                                                                              \
+  }                                                                                                                    \
+                                                                                                                       \
+  static size_t __NB_ARRAY_TYPE__##_search_partition(                                                                  \
+      const __NB_ARRAY_BLOCK_TYPE__ * blocks, size_t count, const __NB_ARRAY_BLOCK_TYPE__ * key, int upper             \
+  ) {                                                                                                                  \
+    const __NB_ARRAY_BLOCK_TYPE__ * base = blocks;                                                                     \
+    if (count == 0) return 0;                                                                                          \
+    while (count > 1) {                                                                                                \
+      const size_t half = count / 2;                                                                                   \
+      const __NB_ARRAY_BLOCK_TYPE__ * probe = base + half;                                                             \
+      const int after = upper ? !__NB_ARRAY_TYPE__##_search_less(key, probe)                                           \
+                              : __NB_ARRAY_TYPE__##_search_less(probe, key);                                           \
+      base = after ? probe : base;                                                                                     \
+      count -= half;                                                                                                   \
+    }                                                                                                                  \
+    const int after = upper ? !__NB_ARRAY_TYPE__##_search_less(key, base) : __NB_ARRAY_TYPE__##_search_less(base, key); \
+    return (size_t)(base - blocks) + (size_t)after;                                                                    \
+  }                                                                                                                    \
+                                                                                                                       \
+  size_t __NB_ARRAY_TYPE__##_lower_bound(struct __NB_ARRAY_TYPE__ * array, const __NB_ARRAY_BLOCK_TYPE__ * key) {      \
+    const __NB_ARRAY_BLOCK_TYPE__ * blocks = (const __NB_ARRAY_BLOCK_TYPE__ *)array->buffer.data;                      \
+    return __NB_ARRAY_TYPE__##_search_partition(blocks, nb_block_count(&array->buffer), key, 0);                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  size_t __NB_ARRAY_TYPE__##_upper_bound(struct __NB_ARRAY_TYPE__ * array, const __NB_ARRAY_BLOCK_TYPE__ * key) {      \
+    const __NB_ARRAY_BLOCK_TYPE__ * blocks = (const __NB_ARRAY_BLOCK_TYPE__ *)array->buffer.data;                      \
+    return __NB_ARRAY_TYPE__##_search_partition(blocks, nb_block_count(&array->buffer), key, 1);                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  struct nb_index_range __NB_ARRAY_TYPE__##_equal_range(                                                               \
+      struct __NB_ARRAY_TYPE__ * array, const __NB_ARRAY_BLOCK_TYPE__ * key                                            \
+  ) {                                                                                                                  \
+    const __NB_ARRAY_BLOCK_TYPE__ * blocks = (const __NB_ARRAY_BLOCK_TYPE__ *)array->buffer.data;                      \
+    const size_t count = nb_block_count(&array->buffer);                                                               \
+    const size_t first = __NB_ARRAY_TYPE__##_search_partition(blocks, count, key, 0);                                  \
+    const size_t end = first + __NB_ARRAY_TYPE__##_search_partition(blocks + first, count - first, key, 1);            \
+    return (struct nb_index_range){.first = first, .end = end};                                                        \
+  }                                                                                                                    \
+                                                                                                                       \
+  enum NB_INSERT_RESULT __NB_ARRAY_TYPE__##_insert_sorted(                                                             \
+      struct __NB_ARRAY_TYPE__ * array, const __NB_ARRAY_BLOCK_TYPE__ item                                             \
+  ) {                                                                                                                  \
+    const size_t sorted_count = nb_sorted_count(&array->buffer);                                                       \
+    const size_t index = __NB_ARRAY_TYPE__##_upper_bound(array, &item);                                                \
+    const enum NB_INSERT_RESULT result = nb_insert(&array->buffer, index, (void *)&item);                              \
+    if (result == NB_INSERT_OK && index <= sorted_count) nb_set_sorted_count(&array->buffer, sorted_count + 1);        \
+    return result;                                                                                                     \
+  }
+
 #endif // NAUGHTY_BUFFERS_ARRAY_GENERATOR_H
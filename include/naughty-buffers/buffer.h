@@ -7,7 +7,8 @@
  *
  * @defgroup buffer Buffer
  * All the functions and types to manage a buffer are here. Buffers can automatically grow to handle pushes and
- * insertions. They start with enough space for 2 blocks and grow by powers of 2 (4, 8, 16, 32, etc)
+ * insertions. They start with enough space for 2 blocks and, by default, grow by powers of 2 (4, 8, 16, 32, etc). The
+ * growth can be customized per memory context with a ::nb_buffer_growth_policy.
  */
 
 /**
@@ -27,6 +28,21 @@ standard
 functions.
  * - The <a href="group__array-generator.html">Array Generator</a> section is the API reference for the type-safe
 wrapper generator macros.
+ * - The <a href="group__compact-buffer.html">Compact Buffer</a> section is the API reference for the 16-byte buffer
+ * variant meant for huge amounts of small buffers.
+ * - The <a href="group__arena.html">Arena</a> section is the API reference for the bump allocator memory context.
+ * - The <a href="group__pool.html">Pool</a> section is the API reference for the thread-caching memory context.
+ * - The <a href="group__virtual-memory.html">Virtual Memory</a> section is the API reference for memory contexts that
+ * map memory directly from the operating system.
+ * - The <a href="group__sort.html">Sort</a> section is the API reference for the specialized sorting functions.
+ * - The <a href="group__search.html">Search</a> section is the API reference for searching sorted buffers.
+ * - The <a href="group__queue.html">Queue</a> section is the API reference for the lock-free queue.
+ * - The <a href="group__concurrent-buffer.html">Concurrent Buffer</a> section is the API reference for the buffer that
+ * many threads can append to at the same time.
+ * - The <a href="group__channel.html">Channel</a> section is the API reference for the bounded channel between any
+ * number of threads.
+ * - The <a href="group__sharded-buffer.html">Sharded Buffer</a> section is the API reference for the buffer with one
+ * shard per producing thread.
  * - Installation instructions can be found in the
  * <a href="https://github.com/mobius3/naughty-buffers#integrating-with-your-code" target=_blank>README</a>
  */
@@ -82,6 +98,48 @@ typedef void (*nb_free_fn)(void * ptr, void * context);
  */
 typedef int (*nb_compare_fn)(const void * ptr_a, const void * ptr_b);
 
+/**
+ * @brief Type of a function that tells whether a block matches some condition, returning non-zero if it does.
+ * @ingroup buffer
+ */
+typedef int (*nb_predicate_fn)(const void * block, void * context);
+
+/**
+ * @brief Type of a function able to report how many bytes are really usable in a memory block returned by
+ * `alloc_fn` or `realloc_fn`. It should function like `malloc_usable_size`. Returning 0 means unknown.
+ * @ingroup buffer
+ */
+typedef size_t (*nb_usable_size_fn)(void * ptr, void * context);
+
+/**
+ * @brief Type of a function that decides the new block capacity of a buffer that needs to grow.
+ *
+ * It receives the current block capacity and the minimum capacity required by the operation being made and should
+ * return the new block capacity. Values smaller than `required_capacity` are ignored and `required_capacity` is used
+ * instead.
+ * @ingroup buffer
+ */
+typedef size_t (*nb_growth_fn)(size_t block_capacity, size_t required_capacity, void * context);
+
+/**
+ * @brief A structure containing a growth function and its context
+ *
+ * Set it in the `growth_policy` member of a ::nb_buffer_memory_context. Buffers whose memory context has no growth
+ * policy double their capacity each time they grow.
+ *
+ * @sa nb_buffer_memory_context
+ * @sa nb_growth_fn
+ * @sa nb_parametric_growth
+ * @ingroup buffer
+ */
+struct nb_buffer_growth_policy {
+  /** A function to compute the new block capacity of a buffer */
+  nb_growth_fn growth_fn;
+
+  /** A pointer to a user-data that will be passed to `growth_fn` */
+  void * context;
+};
+
 /**
  * @brief A structure containing memory-related pointers
  *
@@ -122,6 +180,46 @@ struct nb_buffer_memory_context {
 
   /** A pointer to a user-data that will be passed in every memory-related call */
   void * context;
+
+  /**
+   * Optional. A function returning the real usable size of a block allocated by `alloc_fn` or `realloc_fn`. When
+   * present, buffers use any slack left by the allocator as extra capacity. Needs to have the same semantics of
+   * `malloc_usable_size`
+   */
+  nb_usable_size_fn usable_size_fn;
+
+  /**
+   * Optional. Non-zero if `realloc_fn` never moves a block. Buffers then never move their blocks inside their storage
+   * to reuse room left by removals either, so growing, reserving and shrinking keep the address of every block.
+   */
+  uint8_t keeps_addresses;
+
+  /**
+   * Optional. The growth policy of every buffer using this memory context. When NULL, buffers double their capacity
+   * each time they grow.
+   */
+  const struct nb_buffer_growth_policy * growth_policy;
+};
+
+/**
+ * @brief Parameters understood by ::nb_parametric_growth
+ *
+ * - Geometric growth: set `factor` to a value greater than 1 (e.g, 1.5) and `linear_threshold` to 0
+ * - Fixed increments: set `factor` to 0 and `increment` to the amount of blocks to add each time
+ * - Capped geometric growth: set `factor`, `linear_threshold` and `increment`. The capacity will grow geometrically until
+ * it reaches `linear_threshold` blocks and by `increment` blocks after that
+ *
+ * @ingroup buffer
+ */
+struct nb_growth_parameters {
+  /** The capacity is multiplied by this factor when growing. Values less or equal than 1 disable geometric growth */
+  double factor;
+
+  /** Amount of blocks added when growing linearly. If 0, `linear_threshold` is used instead */
+  size_t increment;
+
+  /** Capacity, in blocks, past which growth becomes linear. 0 means that it never does */
+  size_t linear_threshold;
 };
 
 /**
@@ -146,11 +244,21 @@ struct nb_buffer_iterator {
  *
  * It should be treated as an opaque structure and be access through naughty-buffers functions.
  *
- * Initialize it by using ::nb_init or ::nb_init_advanced. Don't use before initialization.
+ * Initialize it by using ::nb_init, ::nb_init_advanced, ::nb_init_lazy, ::nb_init_inline or their `_advanced`
+ * variants. Don't use before initialization.
+ *
+ * Removing blocks from the front of any buffer (not only the ones used as deques) leaves free room before the first
+ * block instead of moving the others. When the buffer grows and that room is at least as large as the block count,
+ * the blocks are slid back into it inside the same storage, so growing can move blocks even when the memory context
+ * would not have moved the storage. Memory contexts with `keeps_addresses` set turn the sliding off.
+ *
+ * Settings shared by many buffers, like the growth policy, live in the memory context to keep this struct small. When
+ * even that is too large (e.g, millions of buffers that hold a handful of blocks), see ::nb_compact_buffer.
  *
  * @ingroup buffer
  * @sa ::nb_init
  * @sa ::nb_init_advanced
+ * @sa ::nb_init_inline
  * @sa ::nb_release
  */
 struct nb_buffer {
@@ -161,6 +269,12 @@ struct nb_buffer {
   struct nb_buffer_memory_context * memory_context;
 
   void * data;
+
+  size_t block_offset;
+
+  size_t sorted_count;
+
+  uint8_t uses_inline_storage;
 };
 
 /**
@@ -179,7 +293,34 @@ enum NB_ASSIGN_RESULT { NB_ASSIGN_OUT_OF_MEMORY, NB_ASSIGN_OK };
  * @brief Result of calling ::nb_insert
  * @ingroup buffer
  */
-enum NB_INSERT_RESULT { NB_INSERT_OUT_OF_MEMORY, NB_INSERT_OK };
+enum NB_INSERT_RESULT {
+  NB_INSERT_OUT_OF_MEMORY,
+  NB_INSERT_OK,
+
+  /**
+   * The indices passed to ::nb_insert_batch are out of order or greater than the block count. It comes after
+   * ::NB_INSERT_OK to keep the values callers of ::nb_insert were built with.
+   */
+  NB_INSERT_INVALID_INDICES
+};
+
+/**
+ * @brief Result of calling ::nb_reserve
+ * @ingroup buffer
+ */
+enum NB_RESERVE_RESULT { NB_RESERVE_OUT_OF_MEMORY, NB_RESERVE_OK };
+
+/**
+ * @brief Result of calling ::nb_shrink_to_fit
+ * @ingroup buffer
+ */
+enum NB_SHRINK_RESULT { NB_SHRINK_OUT_OF_MEMORY, NB_SHRINK_OK };
+
+/**
+ * @brief Result of calling ::nb_pop_front and ::nb_pop_back
+ * @ingroup buffer
+ */
+enum NB_POP_RESULT { NB_POP_EMPTY, NB_POP_OK };
 
 /**
  * @brief Initializes a ::nb_buffer struct with default values and pointers.
@@ -255,6 +396,192 @@ NAUGHTY_BUFFERS_EXPORT void nb_init_advanced(
     struct nb_buffer_memory_context * memory_context
 );
 
+/**
+ * @brief Initializes a ::nb_buffer struct without allocating any memory.
+ *
+ * Memory is only allocated when the first block is pushed, assigned or inserted, so buffers that are never written
+ * cost nothing but their struct. All memory functions will be set to end up calling the default ones
+ * (malloc/realloc/etc).
+ *
+ * @param buffer A pointer to a ::nb_buffer struct to be initialized
+ * @param block_size The size, in bytes, for each buffer block
+ * @ingroup buffer
+ * @sa nb_init_lazy_advanced
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_init_lazy(struct nb_buffer * buffer, size_t block_size);
+
+/**
+ * @brief Initializes a ::nb_buffer struct with custom memory functions without allocating any memory.
+ *
+ * `alloc_fn` will be called when the first block is pushed, assigned or inserted.
+ *
+ * @param buffer A pointer to a ::nb_buffer struct to be initialized
+ * @param block_size Size, in bytes, for each buffer block
+ * @param memory_context A pointer to a `struct nb_buffer_memory_context` that will be used when memory management is
+ * needed.
+ * @ingroup buffer
+ * @sa nb_init_lazy
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_init_lazy_advanced(
+    struct nb_buffer * buffer,
+    size_t block_size,
+    struct nb_buffer_memory_context * memory_context
+);
+
+/**
+ * @brief Initializes a ::nb_buffer struct that keeps its first blocks in caller-provided storage.
+ *
+ * No memory is allocated by this function: blocks are stored in `storage` until the buffer needs more than
+ * `storage_capacity` blocks, at which point they are moved to memory allocated with the default memory functions.
+ * Everything else (::nb_at, ::nb_iterator, growing and ::nb_release) works as with any other buffer.
+ *
+ * @param buffer A pointer to a ::nb_buffer struct to be initialized
+ * @param block_size The size, in bytes, for each buffer block
+ * @param storage A pointer to memory with room for at least `storage_capacity` blocks, suitably aligned for them
+ * @param storage_capacity How many blocks fit in `storage`
+ * @warning `storage` is never released by the buffer and must outlive it. If `storage` lives inside the same struct as
+ * the buffer, that struct must not be copied or moved while the buffer is in use.
+ *
+ * **Example**
+ * @code
+  struct entity {
+    struct nb_buffer children;
+    int inline_children[4];
+  };
+
+  int main(void) {
+    struct entity entity;
+    nb_init_inline(&entity.children, sizeof(int), entity.inline_children, 4);
+
+    int value = 10;
+    nb_push(&entity.children, &value); // no allocation
+    assert(nb_is_inline(&entity.children));
+
+    nb_release(&entity.children);
+    return 0;
+  }
+ * @endcode
+ *
+ * @ingroup buffer
+ * @sa nb_init_inline_advanced
+ * @sa nb_is_inline
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_init_inline(
+    struct nb_buffer * buffer,
+    size_t block_size,
+    void * storage,
+    size_t storage_capacity
+);
+
+/**
+ * @brief Initializes a ::nb_buffer struct that keeps its first blocks in caller-provided storage and uses custom memory
+ * functions once it outgrows it.
+ *
+ * @param buffer A pointer to a ::nb_buffer struct to be initialized
+ * @param block_size The size, in bytes, for each buffer block
+ * @param storage A pointer to memory with room for at least `storage_capacity` blocks, suitably aligned for them
+ * @param storage_capacity How many blocks fit in `storage`
+ * @param memory_context A pointer to a `struct nb_buffer_memory_context` that will be used when memory management is
+ * needed.
+ * @ingroup buffer
+ * @sa nb_init_inline
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_init_inline_advanced(
+    struct nb_buffer * buffer,
+    size_t block_size,
+    void * storage,
+    size_t storage_capacity,
+    struct nb_buffer_memory_context * memory_context
+);
+
+/**
+ * @brief Tells if the buffer blocks are still kept in the storage given to ::nb_init_inline.
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @return 1 if the blocks are in the inline storage, 0 otherwise
+ * @ingroup buffer
+ */
+NAUGHTY_BUFFERS_EXPORT uint8_t nb_is_inline(const struct nb_buffer * buffer);
+
+/**
+ * @brief Initializes a ::nb_buffer_memory_context with the default memory functions (malloc/realloc/etc).
+ *
+ * Useful to give buffers a growth policy without replacing the memory functions. The growth policy is not copied, it
+ * needs to outlive the buffers using the memory context, and so does the memory context itself.
+ *
+ * @param memory_context A pointer to a ::nb_buffer_memory_context struct to be initialized
+ *
+ * **Example**
+ * @code
+  struct nb_growth_parameters parameters = { .factor = 2.0, .linear_threshold = 1 << 20, .increment = 1 << 20 };
+  struct nb_buffer_growth_policy policy = { .growth_fn = nb_parametric_growth, .context = &parameters };
+
+  int main(void) {
+    struct nb_buffer_memory_context memory_context;
+    nb_memory_context_init(&memory_context);
+    memory_context.growth_policy = &policy;
+
+    struct nb_buffer buffer;
+    nb_init_advanced(&buffer, sizeof(int), &memory_context);
+
+    nb_release(&buffer);
+    return 0;
+  }
+ * @endcode
+ *
+ * @ingroup buffer
+ * @sa nb_parametric_growth
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_memory_context_init(struct nb_buffer_memory_context * memory_context);
+
+/**
+ * @brief A ::nb_growth_fn that grows geometrically, linearly or geometrically up to a threshold and linearly past it.
+ *
+ * @param block_capacity The current block capacity
+ * @param required_capacity The minimum block capacity needed
+ * @param context A pointer to a ::nb_growth_parameters struct
+ * @return The new block capacity
+ * @ingroup buffer
+ * @sa nb_growth_parameters
+ */
+NAUGHTY_BUFFERS_EXPORT size_t nb_parametric_growth(size_t block_capacity, size_t required_capacity, void * context);
+
+/**
+ * @brief Makes sure the buffer has room for at least `block_capacity` blocks without growing again.
+ *
+ * Unlike automatic growth, the growth policy is not consulted and the buffer is resized to exactly `block_capacity`
+ * blocks (plus any slack reported by the allocator). Nothing is done if the buffer already has enough capacity.
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param block_capacity The desired capacity, in blocks
+ * @return `NB_RESERVE_OK` if successful, `NB_RESERVE_OUT_OF_MEMORY` if no more memory could be allocated.
+ * @warning Because the buffer when reallocated can change places, all previous pointers returned by ::nb_at may be
+ * invalid after calling this function.
+ * @ingroup buffer
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_RESERVE_RESULT nb_reserve(struct nb_buffer * buffer, size_t block_capacity);
+
+/**
+ * @brief Returns how many blocks the buffer can hold before it needs to grow.
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @return The block capacity of the buffer
+ * @ingroup buffer
+ */
+NAUGHTY_BUFFERS_EXPORT size_t nb_block_capacity(const struct nb_buffer * buffer);
+
+/**
+ * @brief Releases unused capacity, reallocating the buffer to hold just its current blocks.
+ *
+ * Does nothing while the blocks are kept in inline storage (see ::nb_init_inline).
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @return `NB_SHRINK_OK` if successful, `NB_SHRINK_OUT_OF_MEMORY` if the memory could not be reallocated, in which
+ * case the buffer is left untouched.
+ * @warning Because the buffer when reallocated can change places, all previous pointers returned by ::nb_at may be
+ * invalid after calling this function.
+ * @ingroup buffer
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_SHRINK_RESULT nb_shrink_to_fit(struct nb_buffer * buffer);
+
 /**
  * @brief Copies data to the end of the buffer, possibly reallocating it if more space needed.
  *
@@ -283,6 +610,210 @@ NAUGHTY_BUFFERS_EXPORT void nb_init_advanced(
  */
 NAUGHTY_BUFFERS_EXPORT enum NB_PUSH_RESULT nb_push(struct nb_buffer * buffer, void * data);
 
+/**
+ * @brief Copies `block_count` blocks from `data` to the end of the buffer, growing it at most once.
+ *
+ * This is equivalent to calling ::nb_push `block_count` times but the buffer is resized a single time and all blocks
+ * are copied with a single call to the `copy_fn` of the memory context.
+ *
+ * Caller is expected to ensure that `data` points at the first block to be copied from and that it has
+ * at least `block_count * block_size` bytes.
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param data A pointer to the first block to copy.
+ * @param block_count Amount of blocks to copy from `data` into the buffer
+ * @return `NB_PUSH_OK` if successful, `NB_PUSH_OUT_OF_MEMORY` if no more memory could be allocated. In the later case
+ * the buffer is left untouched.
+ * @warning Because the buffer when reallocated can change places, all previous pointers returned by ::nb_at may be
+ * invalid after calling this function.
+ *
+ * **Example**
+ * @code
+  int main(void) {
+    struct nb_buffer buffer;
+    nb_init(&buffer, sizeof(int));
+
+    int values[3] = { 10, 20, 30 };
+    nb_push_many(&buffer, values, 3);
+    assert(nb_block_count(&buffer) == 3);
+
+    nb_release(&buffer);
+    return 0;
+  }
+ * @endcode
+ *
+ * @ingroup buffer
+ * @sa nb_pop_many
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_PUSH_RESULT nb_push_many(struct nb_buffer * buffer, void * data, size_t block_count);
+
+/**
+ * @brief Removes up to `block_count` blocks from the end of the buffer, copying them to `destination`.
+ *
+ * The removed blocks are copied in the same order they were in the buffer with a single call to the `copy_fn` of the
+ * memory context. If the buffer holds less than `block_count` blocks, all of them are removed.
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param destination Where to copy the removed blocks to. It must have room for at least `block_count * block_size`
+ * bytes. Can be `NULL`, in which case the blocks are just discarded.
+ * @param block_count Maximum amount of blocks to remove
+ * @return The amount of blocks effectively removed
+ * @warning This function will invalidate pointers to the removed blocks previously returned by `nb_at`
+ *
+ * **Example**
+ * @code
+  int main(void) {
+    struct nb_buffer buffer;
+    nb_init(&buffer, sizeof(int));
+
+    int values[3] = { 10, 20, 30 };
+    int popped[2];
+    nb_push_many(&buffer, values, 3);
+    nb_pop_many(&buffer, popped, 2);
+    assert(popped[0] == 20 && popped[1] == 30);
+    assert(nb_block_count(&buffer) == 1);
+
+    nb_release(&buffer);
+    return 0;
+  }
+ * @endcode
+ *
+ * @ingroup buffer
+ * @sa nb_push_many
+ */
+NAUGHTY_BUFFERS_EXPORT size_t nb_pop_many(struct nb_buffer * buffer, void * destination, size_t block_count);
+
+/**
+ * @brief Adds `block_count` uninitialized blocks to the end of the buffer and returns a pointer to the first of them.
+ *
+ * Use it to build blocks directly in the buffer instead of building them somewhere else and copying them with
+ * ::nb_push. Nothing is copied: the new blocks hold whatever was in memory before.
+ *
+ * **Example**
+ * @code
+  struct big_struct {
+    char name[256];
+    double matrix[16];
+  };
+
+  int main(void) {
+    struct nb_buffer buffer;
+    nb_init(&buffer, sizeof(struct big_struct));
+
+    struct big_struct * item = nb_push_uninit(&buffer, 1);
+    if (item == NULL) return 1;
+    snprintf(item->name, sizeof(item->name), "identity");
+    for (int i = 0; i < 16; i++) item->matrix[i] = i % 5 == 0;
+
+    nb_release(&buffer);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param block_count The amount of blocks to add
+ * @return A pointer to the first new block or `NULL` if no more memory could be allocated. In the later case the buffer
+ * is left untouched.
+ * @warning Because the buffer when reallocated can change places, all previous pointers returned by ::nb_at may be
+ * invalid after calling this function.
+ * @ingroup buffer
+ * @sa nb_emplace_back
+ */
+NAUGHTY_BUFFERS_EXPORT void * nb_push_uninit(struct nb_buffer * buffer, size_t block_count);
+
+/**
+ * @brief Adds one uninitialized block to the end of the buffer and returns a pointer to it.
+ *
+ * This is equivalent to calling ::nb_push_uninit with a `block_count` of 1.
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @return A pointer to the new block or `NULL` if no more memory could be allocated
+ * @ingroup buffer
+ * @sa nb_push_uninit
+ */
+NAUGHTY_BUFFERS_EXPORT void * nb_emplace_back(struct nb_buffer * buffer);
+
+/**
+ * @brief Copies the block pointed by `data` to the beginning of the buffer in amortized O(1).
+ *
+ * Blocks are never moved one by one to make room: when there is no free room before the first block, the buffer
+ * grows (or slides its blocks) leaving free room at both of its ends. Together with ::nb_pop_front, ::nb_push and
+ * ::nb_pop_back this allows using a buffer as a double-ended queue while its blocks stay contiguous, so ::nb_at and
+ * ::nb_iterator keep working as usual.
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param data A pointer to the block to copy
+ * @return `NB_PUSH_OK` if successful, `NB_PUSH_OUT_OF_MEMORY` if no more memory could be allocated. In the later case
+ * the buffer is left untouched.
+ * @warning This function may invalidate all previous pointers returned by ::nb_at
+ *
+ * **Example**
+ * @code
+  int main(void) {
+    struct nb_buffer buffer;
+    nb_init(&buffer, sizeof(int));
+
+    int value = 10;
+    nb_push(&buffer, &value);
+    value = 20;
+    nb_push_front(&buffer, &value);
+    assert(*(int *) nb_front(&buffer) == 20);
+
+    nb_release(&buffer);
+    return 0;
+  }
+ * @endcode
+ *
+ * @ingroup buffer
+ * @sa nb_pop_front
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_PUSH_RESULT nb_push_front(struct nb_buffer * buffer, void * data);
+
+/**
+ * @brief Removes the first block of the buffer in O(1), copying it to `destination`.
+ *
+ * The other blocks are not moved: the room left by the removed block is reused by ::nb_push_front or reclaimed when the
+ * buffer grows.
+ *
+ * **Example**
+ * @code
+  int main(void) {
+    struct nb_buffer buffer;
+    nb_init(&buffer, sizeof(int));
+
+    for (int i = 0; i < 10; i++) nb_push(&buffer, &i);
+
+    int value;
+    while (nb_pop_front(&buffer, &value) == NB_POP_OK) printf("%d\n", value); // 0 to 9, in order
+
+    nb_release(&buffer);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param destination Where to copy the removed block to. Can be `NULL`, in which case the block is just discarded.
+ * @return `NB_POP_OK` if a block was removed, `NB_POP_EMPTY` if the buffer was empty
+ * @warning This function will invalidate pointers to the removed block previously returned by `nb_at`
+ * @ingroup buffer
+ * @sa nb_push_front
+ * @sa nb_pop_back
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_POP_RESULT nb_pop_front(struct nb_buffer * buffer, void * destination);
+
+/**
+ * @brief Removes the last block of the buffer, copying it to `destination`.
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param destination Where to copy the removed block to. Can be `NULL`, in which case the block is just discarded.
+ * @return `NB_POP_OK` if a block was removed, `NB_POP_EMPTY` if the buffer was empty
+ * @warning This function will invalidate pointers to the removed block previously returned by `nb_at`
+ * @ingroup buffer
+ * @sa nb_pop_front
+ * @sa nb_pop_many
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_POP_RESULT nb_pop_back(struct nb_buffer * buffer, void * destination);
+
 /**
  * @brief Returns the block count of the buffer.
  * @param buffer A pointer to a ::nb_buffer struct
@@ -295,6 +826,32 @@ NAUGHTY_BUFFERS_EXPORT enum NB_PUSH_RESULT nb_push(struct nb_buffer * buffer, vo
  */
 NAUGHTY_BUFFERS_EXPORT size_t nb_block_count(const struct nb_buffer * buffer);
 
+/**
+ * @brief Returns how many blocks at the start of the buffer are known to be sorted.
+ *
+ * Sorting the buffer with ::nb_sort or any of the functions in sort.h marks all of its blocks as sorted. From then on,
+ * the buffer keeps track of how long the sorted prefix still is: pushing blocks at the back keeps it, removing blocks
+ * shrinks it by the removed blocks that were in it, and inserting, assigning or moving a block into it (like
+ * ::nb_swap_remove does) cuts it right before that block. ::nb_sort_incremental uses it to sort only the rest.
+ *
+ * Blocks modified through pointers (like the ones returned by ::nb_at) are not tracked. Use ::nb_set_sorted_count to
+ * shrink the prefix after modifying blocks in it.
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @return The length, in blocks, of the sorted prefix
+ * @ingroup buffer
+ */
+NAUGHTY_BUFFERS_EXPORT size_t nb_sorted_count(const struct nb_buffer * buffer);
+
+/**
+ * @brief Sets how many blocks at the start of the buffer are known to be sorted. See ::nb_sorted_count
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param sorted_count The length, in blocks, of the sorted prefix. It is capped at the block count.
+ * @ingroup buffer
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_set_sorted_count(struct nb_buffer * buffer, size_t sorted_count);
+
 /**
  * @brief Returns a pointer to the block at position `index` or NULL if the index is out of bounds
  * @param buffer A pointer to a ::nb_buffer struct
@@ -426,6 +983,8 @@ NAUGHTY_BUFFERS_EXPORT enum NB_ASSIGN_RESULT nb_assign(struct nb_buffer * buffer
  * Uninitialized data will be present in the blocks preceding the new data if they were not present before.
  *
  * All blocks in positions greater or equal than the one specified with `index` will be moved forward by 1 position.
+ * When `index` is in the first half of the buffer and there is free room before the first block, the blocks before
+ * `index` are moved back by 1 position instead. Inserting at index 0 is the same as calling ::nb_push_front.
  * @param buffer A pointer to a ::nb_buffer struct
  * @param index The block index to assign the data to
  * @param data A pointer to the data to be copied in the buffer at the specified index.
@@ -454,11 +1013,92 @@ NAUGHTY_BUFFERS_EXPORT enum NB_ASSIGN_RESULT nb_assign(struct nb_buffer * buffer
 NAUGHTY_BUFFERS_EXPORT enum NB_INSERT_RESULT nb_insert(struct nb_buffer * buffer, size_t index, void * data);
 
 /**
- * @brief Removes the block at index 0 from the array moving all other blocks to the beginning.
+ * @brief Inserts `block_count` contiguous blocks from `data` at index `index`, moving the blocks past it only once.
  *
- * This is equivalent of calling ::nb_remove_at with index `nb_block_count(&buffer) -1`.
+ * This is equivalent to calling ::nb_insert for each block, in order, at `index`, `index + 1` and so on, but the
+ * buffer grows at most once, the existing blocks are moved with a single call to `move_fn` and the new ones are copied
+ * with a single call to `copy_fn`.
+ *
+ * **Example**
+ * @code
+  int main(void) {
+    struct nb_buffer buffer;
+    nb_init(&buffer, sizeof(int));
+
+    int values[4] = { 0, 1, 4, 5 };
+    nb_push_many(&buffer, values, 4);
+
+    int missing[2] = { 2, 3 };
+    nb_insert_many(&buffer, 2, missing, 2); // 0, 1, 2, 3, 4, 5
+
+    nb_release(&buffer);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param index The index the first block will be at
+ * @param data A pointer to the first block to copy. It must have at least `block_count * block_size` bytes.
+ * @param block_count The amount of blocks to insert
+ * @return NB_INSERT_OK if insertion was successful or NB_INSERT_OUT_OF_MEMORY if out of memory. In the later case the
+ * buffer is left untouched.
+ * @warning This function will invalidate pointers previously returned by ::nb_at
+ * @ingroup buffer
+ * @sa nb_insert_batch
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_INSERT_RESULT
+nb_insert_many(struct nb_buffer * buffer, size_t index, void * data, size_t block_count);
+
+/**
+ * @brief Inserts `block_count` blocks from `data`, each one before the block at the matching index of `sorted_indices`.
+ *
+ * Indices refer to positions in the buffer before the insertion: block `i` of `data` ends up right before the block
+ * that was at `sorted_indices[i]`, or at the end if `sorted_indices[i]` is the block count. Indices must be sorted in
+ * ascending order and can repeat, in which case the blocks are inserted in the order they have in `data`.
+ *
+ * The buffer grows at most once and is filled from its end, so every existing block is moved at most once. Merging
+ * `k` blocks into a buffer of `n` blocks takes O(n + k) instead of O(n * k) with ::nb_insert.
+ *
+ * **Example**
+ * @code
+  int main(void) {
+    struct nb_buffer buffer;
+    nb_init(&buffer, sizeof(int));
+
+    int values[3] = { 10, 30, 50 };
+    nb_push_many(&buffer, values, 3);
+
+    int new_values[3] = { 0, 20, 60 };
+    size_t indices[3] = { 0, 1, 3 };
+    nb_insert_batch(&buffer, indices, new_values, 3); // 0, 10, 20, 30, 50, 60
+
+    nb_release(&buffer);
+    return 0;
+  }
+ * @endcode
  *
- * @warning This function will invalidate all previously returned pointers with `nb_at`
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param sorted_indices A pointer to `block_count` indices, sorted in ascending order and not greater than the block
+ * count
+ * @param data A pointer to the first block to copy. It must have at least `block_count * block_size` bytes.
+ * @param block_count The amount of blocks to insert
+ * @return NB_INSERT_OK if insertion was successful, NB_INSERT_INVALID_INDICES if an index is smaller than the one
+ * before it or greater than the block count, or NB_INSERT_OUT_OF_MEMORY if out of memory. In the later cases the buffer
+ * is left untouched.
+ * @warning This function will invalidate pointers previously returned by ::nb_at
+ * @ingroup buffer
+ * @sa nb_insert_many
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_INSERT_RESULT
+nb_insert_batch(struct nb_buffer * buffer, const size_t * sorted_indices, void * data, size_t block_count);
+
+/**
+ * @brief Removes the block at index 0 from the array in O(1), without moving the other blocks.
+ *
+ * This is equivalent of calling ::nb_pop_front with a `NULL` destination. The room left before the first block is
+ * reused when the buffer grows (see ::nb_buffer).
+ *
+ * @warning This function will invalidate pointers to the first block previously returned by `nb_at`
  * @param buffer A pointer to a ::nb_buffer struct
  * @ingroup buffer
  * @sa nb_remove_at
@@ -482,7 +1122,9 @@ NAUGHTY_BUFFERS_EXPORT void nb_remove_back(struct nb_buffer * buffer);
 /**
  * @brief Removes the block at the specified index.
  *
- * @warning This function will invalidate pointers previously returned by ::nb_at for blocks at the index and past it
+ * Whichever side of `index` has fewer blocks is moved to close the gap.
+ *
+ * @warning This function will invalidate pointers previously returned by ::nb_at
  * @param buffer A pointer to a ::nb_buffer struct
  * @param index The block index to remove
  * @sa nb_remove_front
@@ -513,6 +1155,118 @@ NAUGHTY_BUFFERS_EXPORT void nb_remove_back(struct nb_buffer * buffer);
  */
 NAUGHTY_BUFFERS_EXPORT void nb_remove_at(struct nb_buffer * buffer, size_t index);
 
+/**
+ * @brief Removes the block at the specified index in O(1) by moving the last block to its place.
+ *
+ * Only one block is copied, but the order of the blocks is not kept. Useful when the buffer is used as an unordered
+ * collection.
+ *
+ * **Example**
+ * @code
+  int main(void) {
+    struct nb_buffer buffer;
+    nb_init(&buffer, sizeof(int));
+
+    for (int i = 0; i < 5; i++) nb_push(&buffer, &i);
+    nb_swap_remove(&buffer, 1); // 0, 4, 2, 3
+    assert(*(int *) nb_at(&buffer, 1) == 4);
+
+    nb_release(&buffer);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param index The block index to remove
+ * @warning This function will invalidate pointers previously returned by ::nb_at for the removed and the last blocks
+ * @ingroup buffer
+ * @sa nb_remove_at
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_swap_remove(struct nb_buffer * buffer, size_t index);
+
+/**
+ * @brief Removes `block_count` contiguous blocks starting at `first_index`.
+ *
+ * Whichever side of the range has fewer blocks is moved to close the gap, with a single call to the `move_fn` of the
+ * memory context. If the range goes past the end of the buffer, only the blocks up to the end are removed.
+ *
+ * **Example**
+ * @code
+  int main(void) {
+    struct nb_buffer buffer;
+    nb_init(&buffer, sizeof(int));
+
+    for (int i = 0; i < 10; i++) nb_push(&buffer, &i);
+    nb_remove_range(&buffer, 2, 5);
+    assert(nb_block_count(&buffer) == 5);
+    assert(*(int *) nb_at(&buffer, 2) == 7);
+
+    nb_release(&buffer);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param first_index The index of the first block to remove
+ * @param block_count The amount of blocks to remove
+ * @return The amount of blocks effectively removed
+ * @warning This function will invalidate pointers previously returned by ::nb_at
+ * @ingroup buffer
+ * @sa nb_remove_at
+ */
+NAUGHTY_BUFFERS_EXPORT size_t nb_remove_range(struct nb_buffer * buffer, size_t first_index, size_t block_count);
+
+/**
+ * @brief Removes all blocks for which `predicate_fn` returns non-zero, keeping the order of the other blocks.
+ *
+ * The buffer is compacted in a single pass: `predicate_fn` is called once for each block, in order, and each run of
+ * kept blocks is moved at most once, with a single call to the `move_fn` of the memory context.
+ *
+ * **Example**
+ * @code
+  int is_odd(const void * block, void * context) {
+    (void) context;
+    return *(const int *) block % 2 != 0;
+  }
+
+  int main(void) {
+    struct nb_buffer buffer;
+    nb_init(&buffer, sizeof(int));
+
+    for (int i = 0; i < 10; i++) nb_push(&buffer, &i);
+    nb_remove_if(&buffer, is_odd, NULL);
+    assert(nb_block_count(&buffer) == 5);
+    assert(*(int *) nb_at(&buffer, 1) == 2);
+
+    nb_release(&buffer);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param predicate_fn A function returning non-zero for blocks that must be removed
+ * @param context A pointer passed as is to `predicate_fn`
+ * @return The amount of blocks removed
+ * @warning This function will invalidate pointers previously returned by ::nb_at
+ * @ingroup buffer
+ */
+NAUGHTY_BUFFERS_EXPORT size_t nb_remove_if(struct nb_buffer * buffer, nb_predicate_fn predicate_fn, void * context);
+
+/**
+ * @brief Removes the blocks at the indices listed in `sorted_indices`, keeping the order of the other blocks.
+ *
+ * `sorted_indices` must be sorted in ascending order. Repeated indices are removed only once and indices past the end
+ * of the buffer are ignored. Like ::nb_remove_if, the buffer is compacted in a single pass.
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param sorted_indices A pointer to the first of `index_count` indices, sorted in ascending order
+ * @param index_count The amount of indices in `sorted_indices`
+ * @return The amount of blocks removed
+ * @warning This function will invalidate pointers previously returned by ::nb_at
+ * @ingroup buffer
+ */
+NAUGHTY_BUFFERS_EXPORT size_t nb_remove_indices(struct nb_buffer * buffer, const size_t * sorted_indices, size_t index_count);
+
 /**
  * @brief Sorts the buffer using stdlib's qsort function.
  *
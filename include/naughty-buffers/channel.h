@@ -0,0 +1,228 @@
+#ifndef NAUGHTY_BUFFERS_CHANNEL_H
+#define NAUGHTY_BUFFERS_CHANNEL_H
+
+/**
+ * @file channel.h
+ * This file contains a bounded channel for passing blocks between any number of threads.
+ *
+ * @defgroup channel Channel
+ * A channel is a fixed-capacity queue that any number of threads can send blocks to and receive blocks from at the same
+ * time. Each slot holds a sequence number next to its block: a sender claims the next slot with a single
+ * compare-and-swap when its sequence number says it is free, copies the block and bumps the sequence number so
+ * receivers know it is ready (and the other way around for receivers). There are no locks, so a thread that stops in
+ * the middle of a send does not stop the others from using other slots.
+ *
+ * Senders wait while the channel is full and receivers wait while it is empty, up to a timeout. Waiting threads sleep on
+ * a futex on Linux and with `WaitOnAddress` on Windows until another thread sends or receives. Other platforms yield
+ * the processor while waiting. Sending and receiving only make a system call when some thread is asleep.
+ *
+ * A channel can be closed with ::nb_channel_close: sending fails from then on, while receivers get the blocks still in
+ * the channel and then ::NB_RECEIVE_CLOSED.
+ */
+
+#include "naughty-buffers/buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Timeout that makes sending and receiving wait for as long as needed
+ * @ingroup channel
+ */
+#define NB_CHANNEL_WAIT_FOREVER (-1L)
+
+/**
+ * @brief An opaque channel. Create it with ::nb_channel_create.
+ * @ingroup channel
+ */
+struct nb_channel;
+
+/**
+ * @brief Result of calling ::nb_channel_send
+ * @ingroup channel
+ */
+enum NB_SEND_RESULT {
+  /** The channel stayed full until the timeout expired */
+  NB_SEND_TIMEOUT,
+
+  /** The channel is closed */
+  NB_SEND_CLOSED,
+
+  NB_SEND_OK
+};
+
+/**
+ * @brief Result of calling ::nb_channel_receive
+ * @ingroup channel
+ */
+enum NB_RECEIVE_RESULT {
+  /** The channel stayed empty until the timeout expired */
+  NB_RECEIVE_TIMEOUT,
+
+  /** The channel is closed and all blocks sent to it were received */
+  NB_RECEIVE_CLOSED,
+
+  NB_RECEIVE_OK
+};
+
+/**
+ * @brief Creates a channel with room for at least `capacity` blocks of `block_size` bytes.
+ *
+ * The capacity is rounded up to a power of two, and it is at least 2. All memory is allocated here, so sending and
+ * receiving never allocate. All memory functions will be set to end up calling the default ones (malloc/realloc/etc).
+ *
+ * **Example**
+ * @code
+  struct job {
+    uint32_t id;
+    uint8_t payload[60];
+  };
+
+  void * stage(void * argument) {
+    struct nb_channel * jobs = argument;
+    struct job job;
+    while (nb_channel_receive(jobs, &job, NB_CHANNEL_WAIT_FOREVER) == NB_RECEIVE_OK) process(&job);
+    return NULL; // closed and drained
+  }
+
+  int main(void) {
+    struct nb_channel * jobs = nb_channel_create(sizeof(struct job), 256);
+
+    // ... start 4 stage threads passing them the channel
+
+    for (uint32_t id = 0; id < 100000; id++) {
+      struct job job = {.id = id};
+      nb_channel_send(jobs, &job, NB_CHANNEL_WAIT_FOREVER);
+    }
+    nb_channel_close(jobs);
+
+    // ... join the stage threads
+    nb_channel_destroy(jobs);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param block_size The size, in bytes, of each block
+ * @param capacity The minimum amount of blocks the channel can hold
+ * @return A pointer to the new channel or NULL if out of memory
+ * @ingroup channel
+ */
+NAUGHTY_BUFFERS_EXPORT struct nb_channel * nb_channel_create(size_t block_size, size_t capacity);
+
+/**
+ * @brief Creates a channel that allocates its memory through `memory_context`. See ::nb_channel_create.
+ *
+ * @param block_size The size, in bytes, of each block
+ * @param capacity The minimum amount of blocks the channel can hold
+ * @param memory_context A pointer to a ::nb_buffer_memory_context. It must outlive the channel.
+ * @return A pointer to the new channel or NULL if out of memory
+ * @ingroup channel
+ */
+NAUGHTY_BUFFERS_EXPORT struct nb_channel * nb_channel_create_advanced(
+    size_t block_size,
+    size_t capacity,
+    struct nb_buffer_memory_context * memory_context
+);
+
+/**
+ * @brief Releases all memory held by the channel. Blocks still in it are discarded.
+ *
+ * No thread may be using the channel, or waiting on it, when it is destroyed.
+ *
+ * @param channel A pointer returned by ::nb_channel_create
+ * @ingroup channel
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_channel_destroy(struct nb_channel * channel);
+
+/**
+ * @brief Returns how many blocks the channel can hold, which is the capacity it was created with rounded up to a
+ * power of two (and at least 2).
+ * @param channel A pointer returned by ::nb_channel_create
+ * @return The capacity of the channel, in blocks
+ * @ingroup channel
+ */
+NAUGHTY_BUFFERS_EXPORT size_t nb_channel_capacity(const struct nb_channel * channel);
+
+/**
+ * @brief Closes the channel and wakes every thread waiting on it.
+ *
+ * Sends that did not claim a slot yet fail with ::NB_SEND_CLOSED, including the ones waiting for room. Blocks already
+ * sent can still be received; once they are all gone, receiving returns ::NB_RECEIVE_CLOSED. Closing a closed channel
+ * does nothing.
+ *
+ * @param channel A pointer returned by ::nb_channel_create
+ * @ingroup channel
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_channel_close(struct nb_channel * channel);
+
+/**
+ * @brief Copies the block pointed by `data` to the channel, waiting up to `timeout_ms` milliseconds for room if it is
+ * full. Can be called from any thread.
+ *
+ * @param channel A pointer returned by ::nb_channel_create
+ * @param data A pointer to the block to copy. It must be at least as big as the channel block size.
+ * @param timeout_ms How long to wait, in milliseconds. 0 does not wait and ::NB_CHANNEL_WAIT_FOREVER waits as long as
+ * needed.
+ * @return ::NB_SEND_OK if the block was sent, ::NB_SEND_TIMEOUT if there was no room for it in time or
+ * ::NB_SEND_CLOSED if the channel was closed.
+ * @ingroup channel
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_SEND_RESULT
+nb_channel_send(struct nb_channel * channel, const void * data, long timeout_ms);
+
+/**
+ * @brief Copies the `block_count` contiguous blocks in `data` to the channel, waiting up to `timeout_ms` milliseconds
+ * in total for room. Can be called from any thread.
+ *
+ * Blocks are sent in order, claiming as many consecutive slots as are free with each compare-and-swap. Blocks sent by
+ * other threads at the same time can end up between them.
+ *
+ * @param channel A pointer returned by ::nb_channel_create
+ * @param data A pointer to the first block to copy
+ * @param block_count How many blocks there are in `data`
+ * @param timeout_ms How long to wait, in milliseconds. 0 does not wait and ::NB_CHANNEL_WAIT_FOREVER waits as long as
+ * needed.
+ * @return How many blocks were sent. It is less than `block_count` if the timeout expired or the channel was closed.
+ * @ingroup channel
+ */
+NAUGHTY_BUFFERS_EXPORT size_t
+nb_channel_send_many(struct nb_channel * channel, const void * data, size_t block_count, long timeout_ms);
+
+/**
+ * @brief Copies the oldest block in the channel to `destination` and removes it, waiting up to `timeout_ms`
+ * milliseconds for one if the channel is empty. Can be called from any thread.
+ *
+ * @param channel A pointer returned by ::nb_channel_create
+ * @param destination Where to copy the block to. It must be at least as big as the channel block size.
+ * @param timeout_ms How long to wait, in milliseconds. 0 does not wait and ::NB_CHANNEL_WAIT_FOREVER waits as long as
+ * needed.
+ * @return ::NB_RECEIVE_OK if a block was received, ::NB_RECEIVE_TIMEOUT if none came in time or ::NB_RECEIVE_CLOSED
+ * if the channel was closed and is empty.
+ * @ingroup channel
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_RECEIVE_RESULT
+nb_channel_receive(struct nb_channel * channel, void * destination, long timeout_ms);
+
+/**
+ * @brief Copies up to `block_count` of the oldest blocks in the channel to `destination` and removes them, waiting up
+ * to `timeout_ms` milliseconds for the first one if the channel is empty. Can be called from any thread.
+ *
+ * It does not wait for more blocks once it has at least one.
+ *
+ * @param channel A pointer returned by ::nb_channel_create
+ * @param destination Where to copy the blocks to. It must have room for `block_count` blocks.
+ * @param block_count The maximum amount of blocks to receive
+ * @param timeout_ms How long to wait, in milliseconds. 0 does not wait and ::NB_CHANNEL_WAIT_FOREVER waits as long as
+ * needed.
+ * @return How many blocks were received. It is 0 if the timeout expired or the channel was closed and is empty.
+ * @ingroup channel
+ */
+NAUGHTY_BUFFERS_EXPORT size_t
+nb_channel_receive_many(struct nb_channel * channel, void * destination, size_t block_count, long timeout_ms);
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif // NAUGHTY_BUFFERS_CHANNEL_H
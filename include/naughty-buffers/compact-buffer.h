@@ -0,0 +1,247 @@
+#ifndef NAUGHTY_BUFFERS_COMPACT_BUFFER_H
+#define NAUGHTY_BUFFERS_COMPACT_BUFFER_H
+
+/**
+ * @file compact-buffer.h
+ * This file contains the structure nb_compact_buffer, a 16-byte variant of nb_buffer.
+ *
+ * @defgroup compact-buffer Compact Buffer
+ * A compact buffer holds only a data pointer and 32-bit block count and capacity, so four of them fit in a 64-byte
+ * cache line. The block size and memory functions, which are the same for every buffer of a given kind, live in a
+ * ::nb_compact_context shared by all of them and passed to every call.
+ *
+ * Compact buffers never allocate memory on initialization. They are meant for huge amounts of small, mostly empty
+ * buffers (e.g, one per entity) where the 40+ bytes of a ::nb_buffer would dominate memory usage.
+ */
+
+#include "naughty-buffers/buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief The data shared by a group of ::nb_compact_buffer structs
+ *
+ * Initialize it with ::nb_compact_context_init or ::nb_compact_context_init_advanced. It must outlive all buffers
+ * that use it.
+ *
+ * @ingroup compact-buffer
+ */
+struct nb_compact_context {
+  size_t block_size;
+
+  struct nb_buffer_memory_context * memory_context;
+};
+
+/**
+ * @brief A 16-byte buffer that needs a ::nb_compact_context to be operated.
+ *
+ * It should be treated as an opaque structure and be accessed through the `nb_compact_` functions, always with the
+ * same context. Initialize it by using ::nb_compact_init. Don't use before initialization.
+ *
+ * @ingroup compact-buffer
+ */
+struct nb_compact_buffer {
+  void * data;
+  uint32_t block_count;
+  uint32_t block_capacity;
+};
+
+/**
+ * @brief Initializes a ::nb_compact_context with the default memory functions (malloc/realloc/etc).
+ * @param context A pointer to a ::nb_compact_context struct to be initialized
+ * @param block_size The size, in bytes, for each buffer block
+ * @ingroup compact-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_compact_context_init(struct nb_compact_context * context, size_t block_size);
+
+/**
+ * @brief Initializes a ::nb_compact_context with custom memory functions.
+ * @param context A pointer to a ::nb_compact_context struct to be initialized
+ * @param block_size The size, in bytes, for each buffer block
+ * @param memory_context A pointer to a `struct nb_buffer_memory_context` that will be used when memory management is
+ * needed.
+ * @ingroup compact-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_compact_context_init_advanced(
+    struct nb_compact_context * context,
+    size_t block_size,
+    struct nb_buffer_memory_context * memory_context
+);
+
+/**
+ * @brief Initializes a ::nb_compact_buffer. No memory is allocated until the first block is added.
+ *
+ * **Example**
+ * @code
+  int main(void) {
+    struct nb_compact_context context;
+    struct nb_compact_buffer buffers[1000];
+
+    nb_compact_context_init(&context, sizeof(int));
+    for (size_t i = 0; i < 1000; i++) nb_compact_init(&buffers[i]);
+
+    int value = 10;
+    nb_compact_push(&context, &buffers[42], &value);
+
+    for (size_t i = 0; i < 1000; i++) nb_compact_release(&context, &buffers[i]);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param buffer A pointer to a ::nb_compact_buffer struct to be initialized
+ * @ingroup compact-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_compact_init(struct nb_compact_buffer * buffer);
+
+/**
+ * @brief Copies data to the end of the buffer, allocating or reallocating it if more space is needed.
+ * @param context The context shared by the buffer
+ * @param buffer A pointer to a ::nb_compact_buffer struct
+ * @param data The data to copy.
+ * @return `NB_PUSH_OK` if successful, `NB_PUSH_OUT_OF_MEMORY` if no more memory could be allocated or if the buffer
+ * would hold more than `UINT32_MAX` blocks.
+ * @ingroup compact-buffer
+ * @sa nb_push
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_PUSH_RESULT nb_compact_push(
+    const struct nb_compact_context * context,
+    struct nb_compact_buffer * buffer,
+    void * data
+);
+
+/**
+ * @brief Copies `block_count` blocks from `data` to the end of the buffer, growing it at most once.
+ * @param context The context shared by the buffer
+ * @param buffer A pointer to a ::nb_compact_buffer struct
+ * @param data A pointer to the first block to copy.
+ * @param block_count Amount of blocks to copy from `data` into the buffer
+ * @return `NB_PUSH_OK` if successful, `NB_PUSH_OUT_OF_MEMORY` if no more memory could be allocated or if the buffer
+ * would hold more than `UINT32_MAX` blocks.
+ * @ingroup compact-buffer
+ * @sa nb_push_many
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_PUSH_RESULT nb_compact_push_many(
+    const struct nb_compact_context * context,
+    struct nb_compact_buffer * buffer,
+    void * data,
+    size_t block_count
+);
+
+/**
+ * @brief Copies `data` to the block at index `index`, growing the buffer if needed.
+ * @param context The context shared by the buffer
+ * @param buffer A pointer to a ::nb_compact_buffer struct
+ * @param index The block index to assign the data to
+ * @param data A pointer to the data to be copied in the buffer at the specified index.
+ * @return NB_ASSIGN_OK if assignment was successful or NB_ASSIGN_OUT_OF_MEMORY if out of memory
+ * @ingroup compact-buffer
+ * @sa nb_assign
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_ASSIGN_RESULT nb_compact_assign(
+    const struct nb_compact_context * context,
+    struct nb_compact_buffer * buffer,
+    size_t index,
+    void * data
+);
+
+/**
+ * @brief Inserts `data` at index `index` moving all blocks past the index forward one position.
+ * @param context The context shared by the buffer
+ * @param buffer A pointer to a ::nb_compact_buffer struct
+ * @param index The block index to insert the data at
+ * @param data A pointer to the data to be copied in the buffer at the specified index.
+ * @return NB_INSERT_OK if insertion was successful or NB_INSERT_OUT_OF_MEMORY if out of memory
+ * @ingroup compact-buffer
+ * @sa nb_insert
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_INSERT_RESULT nb_compact_insert(
+    const struct nb_compact_context * context,
+    struct nb_compact_buffer * buffer,
+    size_t index,
+    void * data
+);
+
+/**
+ * @brief Returns the block count of the buffer.
+ * @param buffer A pointer to a ::nb_compact_buffer struct
+ * @return The block count of the buffer
+ * @ingroup compact-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT size_t nb_compact_block_count(const struct nb_compact_buffer * buffer);
+
+/**
+ * @brief Returns a pointer to the block at position `index` or NULL if the index is out of bounds
+ * @param context The context shared by the buffer
+ * @param buffer A pointer to a ::nb_compact_buffer struct
+ * @param index The index to read
+ * @return A pointer to the block data or NULL if the index is out of bounds
+ * @ingroup compact-buffer
+ * @sa nb_at
+ */
+NAUGHTY_BUFFERS_EXPORT void * nb_compact_at(
+    const struct nb_compact_context * context,
+    const struct nb_compact_buffer * buffer,
+    size_t index
+);
+
+/**
+ * @brief Removes the block at the specified index.
+ * @param context The context shared by the buffer
+ * @param buffer A pointer to a ::nb_compact_buffer struct
+ * @param index The block index to remove
+ * @ingroup compact-buffer
+ * @sa nb_remove_at
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_compact_remove_at(
+    const struct nb_compact_context * context,
+    struct nb_compact_buffer * buffer,
+    size_t index
+);
+
+/**
+ * @brief Makes sure the buffer has room for at least `block_capacity` blocks.
+ * @param context The context shared by the buffer
+ * @param buffer A pointer to a ::nb_compact_buffer struct
+ * @param block_capacity The desired capacity, in blocks
+ * @return `NB_RESERVE_OK` if successful, `NB_RESERVE_OUT_OF_MEMORY` if no more memory could be allocated or if
+ * `block_capacity` is greater than `UINT32_MAX`.
+ * @ingroup compact-buffer
+ * @sa nb_reserve
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_RESERVE_RESULT nb_compact_reserve(
+    const struct nb_compact_context * context,
+    struct nb_compact_buffer * buffer,
+    size_t block_capacity
+);
+
+/**
+ * @brief Creates and returns an iterator that allows for performance-friendly traversal.
+ * @param context The context shared by the buffer
+ * @param buffer A pointer to a ::nb_compact_buffer struct
+ * @returns A `nb_buffer_iterator` struct with values that can be used to control a for-loop.
+ * @ingroup compact-buffer
+ * @sa nb_iterator
+ */
+NAUGHTY_BUFFERS_EXPORT struct nb_buffer_iterator nb_compact_iterator(
+    const struct nb_compact_context * context,
+    const struct nb_compact_buffer * buffer
+);
+
+/**
+ * @brief Releases all memory allocated by the buffer, leaving it empty. It can be used again without initialization.
+ * @param context The context shared by the buffer
+ * @param buffer A pointer to a ::nb_compact_buffer struct
+ * @ingroup compact-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_compact_release(
+    const struct nb_compact_context * context,
+    struct nb_compact_buffer * buffer
+);
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif // NAUGHTY_BUFFERS_COMPACT_BUFFER_H
@@ -0,0 +1,200 @@
+#ifndef NAUGHTY_BUFFERS_CONCURRENT_BUFFER_H
+#define NAUGHTY_BUFFERS_CONCURRENT_BUFFER_H
+
+/**
+ * @file concurrent-buffer.h
+ * This file contains a buffer that many threads can append to at the same time without locks.
+ *
+ * @defgroup concurrent-buffer Concurrent Buffer
+ * A concurrent buffer hands out slots with a single atomic increment of its block count, so appending threads never
+ * wait for each other. Blocks live in segments that double in size and are never moved: a thread that reserves a slot
+ * in a segment that does not exist yet allocates it on its own, and if two threads race to do so, one of them keeps
+ * its segment and the other releases its own. Growing never blocks and pointers to blocks stay valid until the buffer
+ * is destroyed.
+ *
+ * Appending is done in two steps: a slot is reserved (::nb_concurrent_reserve), written and then published
+ * (::nb_concurrent_publish). ::nb_concurrent_push and ::nb_concurrent_push_many do both. Since threads finish writing
+ * in any order, the buffer keeps a watermark: the amount of blocks, counted from the first one, that are all
+ * published. Readers only see blocks below the watermark, which are fully written and never change again.
+ *
+ * A block whose segment could not be allocated is lost: the watermark moves past it like a published block, and
+ * ::nb_concurrent_at returns NULL for it. A segment that could not be allocated stays lost, so every block reserved in
+ * it fails, while blocks past it go on in the next segments.
+ */
+
+#include "naughty-buffers/buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief An opaque concurrent buffer. Create it with ::nb_concurrent_buffer_create.
+ * @ingroup concurrent-buffer
+ */
+struct nb_concurrent_buffer;
+
+/**
+ * @brief Creates an empty concurrent buffer of blocks of `block_size` bytes.
+ *
+ * No blocks are allocated until the first one is reserved. All memory functions will be set to end up calling the
+ * default ones (malloc/realloc/etc).
+ *
+ * **Example**
+ * @code
+  struct log_record {
+    uint64_t timestamp;
+    char message[120];
+  };
+
+  void * worker(void * argument) {
+    struct nb_concurrent_buffer * log = argument;
+    for (int i = 0; i < 1000; i++) {
+      size_t index;
+      struct log_record * record = nb_concurrent_reserve(log, &index);
+      record->timestamp = now();
+      snprintf(record->message, sizeof(record->message), "step %d done", i);
+      nb_concurrent_publish(log, index);
+    }
+    return NULL;
+  }
+
+  int main(void) {
+    struct nb_concurrent_buffer * log = nb_concurrent_buffer_create(sizeof(struct log_record));
+
+    // ... start 8 workers passing them the buffer
+
+    size_t written = 0;
+    while (written < 8000) {
+      size_t published = nb_concurrent_wait_published(log, written + 1);
+      for (; written < published; written++) print_record(nb_concurrent_at(log, written));
+    }
+
+    // ... join the workers
+    nb_concurrent_buffer_destroy(log);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param block_size The size, in bytes, of each block
+ * @return A pointer to the new buffer or NULL if out of memory
+ * @ingroup concurrent-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT struct nb_concurrent_buffer * nb_concurrent_buffer_create(size_t block_size);
+
+/**
+ * @brief Creates an empty concurrent buffer that allocates its memory through `memory_context`.
+ *
+ * The memory functions are called from whichever thread needs a new segment, so they must be thread-safe.
+ *
+ * @param block_size The size, in bytes, of each block
+ * @param memory_context A pointer to a ::nb_buffer_memory_context. It must outlive the buffer.
+ * @return A pointer to the new buffer or NULL if out of memory
+ * @ingroup concurrent-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT struct nb_concurrent_buffer *
+nb_concurrent_buffer_create_advanced(size_t block_size, struct nb_buffer_memory_context * memory_context);
+
+/**
+ * @brief Releases all memory held by the buffer. No thread may be using it.
+ * @param buffer A pointer returned by ::nb_concurrent_buffer_create
+ * @ingroup concurrent-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_concurrent_buffer_destroy(struct nb_concurrent_buffer * buffer);
+
+/**
+ * @brief Reserves a slot at the end of the buffer and returns a pointer to it, so it can be written in place.
+ *
+ * Can be called from any thread. The slot is not visible to readers until ::nb_concurrent_publish is called with the
+ * index written to `out_index`. Blocks reserved afterwards by other threads can be published before, but the watermark
+ * will not move past this one until it is published too.
+ *
+ * @param buffer A pointer returned by ::nb_concurrent_buffer_create
+ * @param out_index Where to write the index of the reserved block
+ * @return A pointer to the reserved block or NULL if its segment could not be allocated. In that case the block is
+ * lost and there is nothing to publish.
+ * @ingroup concurrent-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT void * nb_concurrent_reserve(struct nb_concurrent_buffer * buffer, size_t * out_index);
+
+/**
+ * @brief Marks a block reserved with ::nb_concurrent_reserve as fully written, moving the watermark past it (and past
+ * the blocks after it that were already published) if every block before it is published too.
+ *
+ * The block must not be changed after it is published.
+ *
+ * @param buffer A pointer returned by ::nb_concurrent_buffer_create
+ * @param index The index written by ::nb_concurrent_reserve
+ * @ingroup concurrent-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_concurrent_publish(struct nb_concurrent_buffer * buffer, size_t index);
+
+/**
+ * @brief Copies the block pointed by `data` to the end of the buffer and publishes it. Can be called from any thread.
+ *
+ * @param buffer A pointer returned by ::nb_concurrent_buffer_create
+ * @param data A pointer to the block to copy
+ * @return ::NB_PUSH_OK if the block was pushed, ::NB_PUSH_OUT_OF_MEMORY if its segment could not be allocated. In that
+ * case the block is lost.
+ * @ingroup concurrent-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_PUSH_RESULT nb_concurrent_push(struct nb_concurrent_buffer * buffer, const void * data);
+
+/**
+ * @brief Copies the `block_count` contiguous blocks in `data` to the end of the buffer and publishes them. Can be
+ * called from any thread.
+ *
+ * All the blocks are reserved with a single atomic increment, so they stay together in the buffer even if other
+ * threads are pushing at the same time.
+ *
+ * @param buffer A pointer returned by ::nb_concurrent_buffer_create
+ * @param data A pointer to the first block to copy
+ * @param block_count How many blocks there are in `data`
+ * @return ::NB_PUSH_OK if the blocks were pushed, ::NB_PUSH_OUT_OF_MEMORY if a segment could not be allocated. In that
+ * case all of them are lost.
+ * @ingroup concurrent-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_PUSH_RESULT
+nb_concurrent_push_many(struct nb_concurrent_buffer * buffer, const void * data, size_t block_count);
+
+/**
+ * @brief Returns the watermark: the amount of blocks, counted from the first one, that are all published.
+ *
+ * Blocks with an index below the returned value can be read with ::nb_concurrent_at from any thread.
+ *
+ * @param buffer A pointer returned by ::nb_concurrent_buffer_create
+ * @return The amount of readable blocks
+ * @ingroup concurrent-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT size_t nb_concurrent_published_count(const struct nb_concurrent_buffer * buffer);
+
+/**
+ * @brief Waits until at least `block_count` blocks are past the watermark, sleeping while they are not.
+ *
+ * The blocks must have been (or be about to be) reserved, otherwise this function never returns. Lost blocks count as
+ * published. On Linux and Windows the thread sleeps until a publishing thread wakes it; elsewhere it yields the
+ * processor between checks.
+ *
+ * @param buffer A pointer returned by ::nb_concurrent_buffer_create
+ * @param block_count The amount of blocks to wait for
+ * @return The watermark when the function returned, which is at least `block_count`
+ * @ingroup concurrent-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT size_t
+nb_concurrent_wait_published(const struct nb_concurrent_buffer * buffer, size_t block_count);
+
+/**
+ * @brief Returns a pointer to a published block. The pointer stays valid until the buffer is destroyed.
+ *
+ * @param buffer A pointer returned by ::nb_concurrent_buffer_create
+ * @param index The index of the block
+ * @return A pointer to the block or NULL if `index` is not below the watermark or the block is lost
+ * @ingroup concurrent-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT void * nb_concurrent_at(const struct nb_concurrent_buffer * buffer, size_t index);
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif // NAUGHTY_BUFFERS_CONCURRENT_BUFFER_H
@@ -0,0 +1,106 @@
+#ifndef NAUGHTY_BUFFERS_POOL_H
+#define NAUGHTY_BUFFERS_POOL_H
+
+/**
+ * @file pool.h
+ * This file contains a thread-caching memory context with power-of-two size classes.
+ *
+ * @defgroup pool Pool
+ * Buffers grow by powers of two, so their allocations fall into a small set of sizes. The pool memory context rounds
+ * every allocation up to a power of two (a size class) and keeps released blocks in per-thread free lists, one per
+ * size class. Allocating and reallocating from a free list takes no locks, which removes allocator contention when
+ * many threads grow buffers at the same time.
+ *
+ * Reallocating within the same size class returns the same pointer. Reallocating to a bigger class takes a block from
+ * that class and gives the old one back to the calling thread free list. Allocations larger than
+ * ::NB_POOL_MAX_CLASS_SIZE go straight to the system allocator.
+ *
+ * Blocks can be released from a thread other than the one that allocated them; they just end up in the releasing
+ * thread free lists. Each free list keeps at most ::NB_POOL_MAX_CACHED_BLOCKS blocks, extra blocks are given back to
+ * the system. Threads give their cached blocks back to the system when they exit, or earlier by calling
+ * ::nb_pool_thread_flush.
+ */
+
+#include "naughty-buffers/buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Allocations bigger than this many bytes are not cached by the pool
+ * @ingroup pool
+ */
+#define NB_POOL_MAX_CLASS_SIZE ((size_t) 1 << 20)
+
+/**
+ * @brief Maximum amount of blocks kept in each per-thread free list
+ * @ingroup pool
+ */
+#define NB_POOL_MAX_CACHED_BLOCKS 64
+
+/**
+ * @brief Counters of the pool activity of a thread, filled by ::nb_pool_thread_stats
+ * @ingroup pool
+ */
+struct nb_pool_stats {
+  /** Allocations satisfied from a free list */
+  size_t cache_hits;
+
+  /** Allocations that needed a call to the system allocator */
+  size_t cache_misses;
+
+  /** Reallocations that stayed in the same size class and returned the same pointer */
+  size_t in_place_reallocs;
+
+  /** Blocks given back to the system, either because the free list was full or because of a flush */
+  size_t system_releases;
+
+  /** Allocations too big to be cached */
+  size_t huge_allocations;
+
+  /** Bytes currently kept in the free lists of the thread */
+  size_t cached_bytes;
+};
+
+/**
+ * @brief Returns the pool memory context, to be used with ::nb_init_advanced and friends.
+ *
+ * **Example**
+ * @code
+  int main(void) {
+    struct nb_buffer buffer;
+    nb_init_advanced(&buffer, sizeof(int), nb_pool_memory_context());
+
+    int value = 10;
+    nb_push(&buffer, &value);
+
+    nb_release(&buffer);
+    nb_pool_thread_flush();
+    return 0;
+  }
+ * @endcode
+ *
+ * @return A pointer to the pool memory context. It is valid for the whole program.
+ * @ingroup pool
+ */
+NAUGHTY_BUFFERS_EXPORT struct nb_buffer_memory_context * nb_pool_memory_context(void);
+
+/**
+ * @brief Copies the pool counters of the calling thread to `stats`.
+ * @param stats A pointer to a ::nb_pool_stats struct to be filled
+ * @ingroup pool
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_pool_thread_stats(struct nb_pool_stats * stats);
+
+/**
+ * @brief Gives all blocks cached by the calling thread back to the system allocator.
+ * @ingroup pool
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_pool_thread_flush(void);
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif // NAUGHTY_BUFFERS_POOL_H
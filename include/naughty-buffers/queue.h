@@ -0,0 +1,187 @@
+#ifndef NAUGHTY_BUFFERS_QUEUE_H
+#define NAUGHTY_BUFFERS_QUEUE_H
+
+/**
+ * @file queue.h
+ * This file contains a fixed-capacity queue for passing blocks between threads.
+ *
+ * @defgroup queue Queue
+ * A single-producer, single-consumer queue is a ring of slots with two indices: the producer only writes the tail
+ * and the consumer only writes the head. Each side publishes its index with a single atomic store and reads the other
+ * one only when its own cached copy says the ring looks full (or empty), so no locks are taken and the two threads
+ * rarely touch the same cache line.
+ *
+ * Exactly one thread may enqueue and exactly one (possibly different) thread may dequeue at any given time. Use
+ * ::nb_spsc_enqueue_many and ::nb_spsc_dequeue_many to move many blocks with a single index update.
+ */
+
+#include "naughty-buffers/buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief An opaque single-producer, single-consumer queue. Create it with ::nb_spsc_queue_create.
+ * @ingroup queue
+ */
+struct nb_spsc_queue;
+
+/**
+ * @brief Result of calling ::nb_spsc_enqueue
+ * @ingroup queue
+ */
+enum NB_ENQUEUE_RESULT {
+  /** All slots are taken, the consumer has to dequeue first */
+  NB_ENQUEUE_FULL,
+
+  NB_ENQUEUE_OK
+};
+
+/**
+ * @brief Result of calling ::nb_spsc_dequeue
+ * @ingroup queue
+ */
+enum NB_DEQUEUE_RESULT {
+  /** There are no blocks to dequeue */
+  NB_DEQUEUE_EMPTY,
+
+  NB_DEQUEUE_OK
+};
+
+/**
+ * @brief Creates a single-producer, single-consumer queue with room for at least `capacity` blocks of `block_size`
+ * bytes.
+ *
+ * The capacity is rounded up to a power of two. All memory is allocated here, so enqueuing and dequeuing never
+ * allocate. All memory functions will be set to end up calling the default ones (malloc/realloc/etc).
+ *
+ * **Example**
+ * @code
+  struct message {
+    uint32_t kind;
+    uint8_t payload[60];
+  };
+
+  void * network_thread(void * argument) {
+    struct nb_spsc_queue * queue = argument;
+    struct message message;
+    while (receive(&message)) {
+      while (nb_spsc_enqueue(queue, &message) == NB_ENQUEUE_FULL) sched_yield();
+    }
+    return NULL;
+  }
+
+  void * worker_thread(void * argument) {
+    struct nb_spsc_queue * queue = argument;
+    struct message messages[32];
+    for (;;) {
+      size_t count = nb_spsc_dequeue_many(queue, messages, 32);
+      for (size_t i = 0; i < count; i++) handle(&messages[i]);
+    }
+    return NULL;
+  }
+
+  int main(void) {
+    struct nb_spsc_queue * queue = nb_spsc_queue_create(sizeof(struct message), 1024);
+    // ... start both threads, passing the queue, and join them
+    nb_spsc_queue_destroy(queue);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param block_size The size, in bytes, of each block
+ * @param capacity The minimum amount of blocks the queue can hold
+ * @return A pointer to the new queue or NULL if out of memory
+ * @ingroup queue
+ */
+NAUGHTY_BUFFERS_EXPORT struct nb_spsc_queue * nb_spsc_queue_create(size_t block_size, size_t capacity);
+
+/**
+ * @brief Creates a single-producer, single-consumer queue that allocates its memory through `memory_context`.
+ *
+ * The queue and its slots are allocated here and released by ::nb_spsc_queue_destroy. See ::nb_spsc_queue_create.
+ *
+ * @param block_size The size, in bytes, of each block
+ * @param capacity The minimum amount of blocks the queue can hold
+ * @param memory_context A pointer to a ::nb_buffer_memory_context. It must outlive the queue.
+ * @return A pointer to the new queue or NULL if out of memory
+ * @ingroup queue
+ */
+NAUGHTY_BUFFERS_EXPORT struct nb_spsc_queue * nb_spsc_queue_create_advanced(
+    size_t block_size,
+    size_t capacity,
+    struct nb_buffer_memory_context * memory_context
+);
+
+/**
+ * @brief Releases all memory held by the queue. Blocks still in it are discarded.
+ *
+ * No thread may be using the queue when it is destroyed.
+ *
+ * @param queue A pointer returned by ::nb_spsc_queue_create
+ * @ingroup queue
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_spsc_queue_destroy(struct nb_spsc_queue * queue);
+
+/**
+ * @brief Returns how many blocks the queue can hold, which is the capacity it was created with rounded up to a power
+ * of two.
+ * @param queue A pointer returned by ::nb_spsc_queue_create
+ * @return The capacity of the queue, in blocks
+ * @ingroup queue
+ */
+NAUGHTY_BUFFERS_EXPORT size_t nb_spsc_queue_capacity(const struct nb_spsc_queue * queue);
+
+/**
+ * @brief Copies the block pointed by `data` to the back of the queue. Must only be called from the producer thread.
+ *
+ * @param queue A pointer returned by ::nb_spsc_queue_create
+ * @param data A pointer to the block to copy. It must be at least as big as the queue block size.
+ * @return ::NB_ENQUEUE_OK if the block was enqueued, ::NB_ENQUEUE_FULL if there was no room for it
+ * @ingroup queue
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_ENQUEUE_RESULT nb_spsc_enqueue(struct nb_spsc_queue * queue, const void * data);
+
+/**
+ * @brief Copies the block at the front of the queue to `destination` and removes it. Must only be called from the
+ * consumer thread.
+ *
+ * @param queue A pointer returned by ::nb_spsc_queue_create
+ * @param destination Where to copy the block to. It must be at least as big as the queue block size.
+ * @return ::NB_DEQUEUE_OK if a block was dequeued, ::NB_DEQUEUE_EMPTY if there was none
+ * @ingroup queue
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_DEQUEUE_RESULT nb_spsc_dequeue(struct nb_spsc_queue * queue, void * destination);
+
+/**
+ * @brief Copies as many of the `block_count` contiguous blocks in `data` as fit to the back of the queue. Must only be
+ * called from the producer thread.
+ *
+ * All copied blocks become visible to the consumer at once, with a single atomic store.
+ *
+ * @param queue A pointer returned by ::nb_spsc_queue_create
+ * @param data A pointer to the first block to copy
+ * @param block_count How many blocks there are in `data`
+ * @return How many blocks were enqueued, from 0 (the queue was full) to `block_count`
+ * @ingroup queue
+ */
+NAUGHTY_BUFFERS_EXPORT size_t nb_spsc_enqueue_many(struct nb_spsc_queue * queue, const void * data, size_t block_count);
+
+/**
+ * @brief Copies up to `block_count` blocks from the front of the queue to `destination` and removes them. Must only be
+ * called from the consumer thread.
+ *
+ * @param queue A pointer returned by ::nb_spsc_queue_create
+ * @param destination Where to copy the blocks to. It must have room for `block_count` blocks.
+ * @param block_count The maximum amount of blocks to dequeue
+ * @return How many blocks were dequeued, from 0 (the queue was empty) to `block_count`
+ * @ingroup queue
+ */
+NAUGHTY_BUFFERS_EXPORT size_t nb_spsc_dequeue_many(struct nb_spsc_queue * queue, void * destination, size_t block_count);
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif // NAUGHTY_BUFFERS_QUEUE_H
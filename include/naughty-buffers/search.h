@@ -0,0 +1,183 @@
+#ifndef NAUGHTY_BUFFERS_SEARCH_H
+#define NAUGHTY_BUFFERS_SEARCH_H
+
+/**
+ * @file search.h
+ * This file contains functions to search sorted buffers.
+ *
+ * @defgroup search Search
+ * Binary searches over buffers sorted in ascending order, like the ones sorted with ::nb_sort or any function in
+ * sort.h. The comparison functions receive a block of the buffer as their first argument and the searched key as the
+ * second, so the key does not need to be a whole block: it can be just the field the buffer is sorted by.
+ *
+ * For big, read-mostly tables, ::nb_build_eytzinger copies a sorted buffer in the Eytzinger layout: the blocks are
+ * stored in the order of a breadth-first walk of the binary search tree (the middle block first, then the middles of
+ * both halves, and so on). The first probes of every search hit the same few cache lines, the two children of a
+ * block are next to each other and the blocks four levels below one are contiguous, so ::nb_eytzinger_find can
+ * prefetch them while it compares. It misses the cache far less than a binary search once the table does not fit in
+ * it.
+ */
+
+#include "naughty-buffers/buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A range of block indices, from `first` up to (but not including) `end`
+ * @ingroup search
+ */
+struct nb_index_range {
+  /** Index of the first block in the range */
+  size_t first;
+
+  /** Index past the last block in the range. Equal to `first` if the range is empty. */
+  size_t end;
+};
+
+/**
+ * @brief Returns the index of the first block that does not go before `key`, or the block count if there is none.
+ *
+ * **Example**
+ * @code
+  struct entry {
+    uint64_t id;
+    char name[32];
+  };
+
+  int entry_id_compare(const void * block, const void * key) {
+    uint64_t a = ((const struct entry *) block)->id;
+    uint64_t b = *(const uint64_t *) key;
+    return (a > b) - (a < b);
+  }
+
+  struct entry * find_entry(const struct nb_buffer * entries, uint64_t id) {
+    const size_t index = nb_lower_bound(entries, &id, entry_id_compare);
+    struct entry * entry = nb_at(entries, index);
+    if (entry == NULL || entry->id != id) return NULL;
+    return entry;
+  }
+ * @endcode
+ *
+ * @param buffer A pointer to a ::nb_buffer struct, sorted in ascending order
+ * @param key The key to search for, passed as the second argument of `compare_fn`
+ * @param compare_fn A function comparing a block (first argument) with the key (second argument)
+ * @return The index where `key` would be inserted keeping the buffer sorted, before any block equal to it
+ * @ingroup search
+ */
+NAUGHTY_BUFFERS_EXPORT size_t
+nb_lower_bound(const struct nb_buffer * buffer, const void * key, nb_compare_fn compare_fn);
+
+/**
+ * @brief Returns the index of the first block that goes after `key`, or the block count if there is none.
+ *
+ * @param buffer A pointer to a ::nb_buffer struct, sorted in ascending order
+ * @param key The key to search for, passed as the second argument of `compare_fn`
+ * @param compare_fn A function comparing a block (first argument) with the key (second argument)
+ * @return The index where `key` would be inserted keeping the buffer sorted, after any block equal to it
+ * @ingroup search
+ */
+NAUGHTY_BUFFERS_EXPORT size_t
+nb_upper_bound(const struct nb_buffer * buffer, const void * key, nb_compare_fn compare_fn);
+
+/**
+ * @brief Returns the range of blocks that compare equal to `key`. The range is empty if there are none.
+ *
+ * @param buffer A pointer to a ::nb_buffer struct, sorted in ascending order
+ * @param key The key to search for, passed as the second argument of `compare_fn`
+ * @param compare_fn A function comparing a block (first argument) with the key (second argument)
+ * @return The range going from ::nb_lower_bound to ::nb_upper_bound
+ * @ingroup search
+ */
+NAUGHTY_BUFFERS_EXPORT struct nb_index_range
+nb_equal_range(const struct nb_buffer * buffer, const void * key, nb_compare_fn compare_fn);
+
+/**
+ * @brief Inserts a block in a sorted buffer, after the blocks that compare equal to it, keeping it sorted.
+ *
+ * Here `compare_fn` compares two blocks, like in ::nb_sort. If the block goes inside the sorted prefix of the buffer
+ * (see ::nb_sorted_count), the prefix grows to include it.
+ *
+ * @param buffer A pointer to a ::nb_buffer struct, sorted in ascending order
+ * @param data A pointer to the block to insert
+ * @param compare_fn The comparison function the buffer is sorted by
+ * @return ::NB_INSERT_OK if the block was inserted or ::NB_INSERT_OUT_OF_MEMORY if the buffer could not grow
+ * @warning This function will invalidate pointers previously returned by ::nb_at
+ * @ingroup search
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_INSERT_RESULT
+nb_insert_sorted(struct nb_buffer * buffer, void * data, nb_compare_fn compare_fn);
+
+/**
+ * @brief Result of calling ::nb_build_eytzinger
+ * @ingroup search
+ */
+enum NB_EYTZINGER_RESULT {
+  NB_EYTZINGER_OUT_OF_MEMORY,
+
+  /** The source and destination buffers have different block sizes */
+  NB_EYTZINGER_BLOCK_SIZE_MISMATCH,
+
+  NB_EYTZINGER_OK
+};
+
+/**
+ * @brief Fills `destination` with the blocks of the sorted buffer `source` in the Eytzinger layout, to be searched
+ * with ::nb_eytzinger_find.
+ *
+ * The blocks previously in `destination` are removed. `source` is not modified and can be released if only the
+ * Eytzinger copy is needed. The copy has to be built again after `source` changes.
+ *
+ * **Example**
+ * @code
+  int main(void) {
+    struct nb_buffer sorted;
+    struct nb_buffer table;
+    nb_init(&sorted, sizeof(struct entry));
+    nb_init(&table, sizeof(struct entry));
+
+    // ... push entries and sort them by id
+    nb_build_eytzinger(&sorted, &table);
+    nb_release(&sorted);
+
+    uint64_t id = 1234;
+    struct entry * entry = nb_at(&table, nb_eytzinger_find(&table, &id, entry_id_compare));
+    if (entry != NULL && entry->id == id) {
+      // found it
+    }
+
+    nb_release(&table);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param source A pointer to a ::nb_buffer struct, sorted in ascending order
+ * @param destination A pointer to a ::nb_buffer struct initialized with the same block size as `source`
+ * @return ::NB_EYTZINGER_OK if `destination` was filled. It is left untouched otherwise.
+ * @ingroup search
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_EYTZINGER_RESULT
+nb_build_eytzinger(const struct nb_buffer * source, struct nb_buffer * destination);
+
+/**
+ * @brief Searches a buffer built with ::nb_build_eytzinger for the first block that does not go before `key`.
+ *
+ * The search is the Eytzinger equivalent of ::nb_lower_bound: it descends the implicit tree choosing a child from the
+ * result of the comparison without branching on it, and prefetches the blocks four levels below the current one.
+ *
+ * @param eytzinger A pointer to a ::nb_buffer struct filled by ::nb_build_eytzinger
+ * @param key The key to search for, passed as the second argument of `compare_fn`
+ * @param compare_fn A function comparing a block (first argument) with the key (second argument)
+ * @return The index, in `eytzinger`, of the first block that does not go before `key`, or the block count if there is
+ * none. It can be passed directly to ::nb_at.
+ * @ingroup search
+ */
+NAUGHTY_BUFFERS_EXPORT size_t
+nb_eytzinger_find(const struct nb_buffer * eytzinger, const void * key, nb_compare_fn compare_fn);
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif // NAUGHTY_BUFFERS_SEARCH_H
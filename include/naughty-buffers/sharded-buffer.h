@@ -0,0 +1,213 @@
+#ifndef NAUGHTY_BUFFERS_SHARDED_BUFFER_H
+#define NAUGHTY_BUFFERS_SHARDED_BUFFER_H
+
+/**
+ * @file sharded-buffer.h
+ * This file contains a buffer split into one shard per producing thread, collected into a single buffer at the end.
+ *
+ * @defgroup sharded-buffer Sharded Buffer
+ * A sharded buffer is a set of regular buffers, one for each thread that produces blocks. Each thread only touches its
+ * own shard, with the usual functions (::nb_push, ::nb_emplace_back, ...), so producing needs no locks or atomic
+ * operations and threads never wait for each other. Shards are kept far enough apart in memory that pushing to one does
+ * not invalidate the cache lines of the others.
+ *
+ * Once the threads are done, ::nb_sharded_collect appends all shards, in shard order, to a destination buffer: it is
+ * grown once and then filled by several threads copying at the same time. When a single buffer is not needed,
+ * ::nb_sharded_spans lists where the blocks of each shard are, without copying them.
+ */
+
+#include "naughty-buffers/buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Sharded buffers holding fewer bytes than this are collected by ::nb_sharded_collect on the calling thread
+ * @ingroup sharded-buffer
+ */
+#define NB_PARALLEL_COLLECT_THRESHOLD ((size_t) 1 << 20)
+
+/**
+ * @brief An opaque sharded buffer. Create it with ::nb_sharded_buffer_create.
+ * @ingroup sharded-buffer
+ */
+struct nb_sharded_buffer;
+
+/**
+ * @brief The blocks of one shard, as listed by ::nb_sharded_spans
+ * @ingroup sharded-buffer
+ */
+struct nb_sharded_span {
+  /** A pointer to the first block of the shard */
+  void * data;
+
+  /** How many blocks the shard holds */
+  size_t block_count;
+};
+
+/**
+ * @brief Result of calling ::nb_sharded_collect
+ * @ingroup sharded-buffer
+ */
+enum NB_COLLECT_RESULT {
+  NB_COLLECT_OUT_OF_MEMORY,
+
+  /** The destination buffer and the shards have different block sizes */
+  NB_COLLECT_BLOCK_SIZE_MISMATCH,
+
+  NB_COLLECT_OK
+};
+
+/**
+ * @brief Creates a sharded buffer with `shard_count` empty shards of blocks of `block_size` bytes.
+ *
+ * Shards do not allocate blocks until something is pushed to them. All memory functions will be set to end up calling
+ * the default ones (malloc/realloc/etc).
+ *
+ * **Example**
+ * @code
+  struct result {
+    uint64_t id;
+    double score;
+  };
+
+  struct worker {
+    struct nb_sharded_buffer * results;
+    size_t index;
+  };
+
+  void * work(void * argument) {
+    struct worker * worker = argument;
+    struct nb_buffer * results = nb_sharded_shard(worker->results, worker->index);
+    for (uint64_t id = worker->index; id < 1000000; id += 8) {
+      struct result result = {id, evaluate(id)};
+      nb_push(results, &result);
+    }
+    return NULL;
+  }
+
+  int main(void) {
+    struct nb_sharded_buffer * results = nb_sharded_buffer_create(sizeof(struct result), 8);
+
+    // ... start 8 workers, each with its own index, and join them
+
+    struct nb_buffer all;
+    nb_init(&all, sizeof(struct result));
+    nb_sharded_collect(results, &all, 0);
+    nb_sharded_buffer_destroy(results);
+
+    // ... use all
+    nb_release(&all);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param block_size The size, in bytes, of each block
+ * @param shard_count How many shards to create, usually one per producing thread
+ * @return A pointer to the new sharded buffer or NULL if out of memory or `shard_count` is 0
+ * @ingroup sharded-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT struct nb_sharded_buffer * nb_sharded_buffer_create(size_t block_size, size_t shard_count);
+
+/**
+ * @brief Creates a sharded buffer whose shards allocate their memory through `memory_context`. See
+ * ::nb_sharded_buffer_create.
+ *
+ * Shards growing in different threads call the memory functions at the same time, so they must be thread-safe.
+ *
+ * @param block_size The size, in bytes, of each block
+ * @param shard_count How many shards to create, usually one per producing thread
+ * @param memory_context A pointer to a ::nb_buffer_memory_context. It must outlive the sharded buffer.
+ * @return A pointer to the new sharded buffer or NULL if out of memory or `shard_count` is 0
+ * @ingroup sharded-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT struct nb_sharded_buffer * nb_sharded_buffer_create_advanced(
+    size_t block_size,
+    size_t shard_count,
+    struct nb_buffer_memory_context * memory_context
+);
+
+/**
+ * @brief Releases all memory held by the sharded buffer and its shards. No thread may be using it.
+ * @param buffer A pointer returned by ::nb_sharded_buffer_create
+ * @ingroup sharded-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_sharded_buffer_destroy(struct nb_sharded_buffer * buffer);
+
+/**
+ * @brief Returns how many shards the sharded buffer has
+ * @param buffer A pointer returned by ::nb_sharded_buffer_create
+ * @return The amount of shards
+ * @ingroup sharded-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT size_t nb_sharded_shard_count(const struct nb_sharded_buffer * buffer);
+
+/**
+ * @brief Returns one of the shards, a regular buffer that can be used with every ::nb_buffer function.
+ *
+ * A shard must only be used by one thread at a time, but different shards can be used by different threads at the
+ * same time. The shard must not be released or re-initialized: it belongs to the sharded buffer.
+ *
+ * @param buffer A pointer returned by ::nb_sharded_buffer_create
+ * @param shard The index of the shard, below ::nb_sharded_shard_count
+ * @return A pointer to the shard or NULL if `shard` is out of range
+ * @ingroup sharded-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT struct nb_buffer * nb_sharded_shard(struct nb_sharded_buffer * buffer, size_t shard);
+
+/**
+ * @brief Returns the amount of blocks in all shards. No thread may be changing the shards.
+ * @param buffer A pointer returned by ::nb_sharded_buffer_create
+ * @return The total amount of blocks
+ * @ingroup sharded-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT size_t nb_sharded_block_count(const struct nb_sharded_buffer * buffer);
+
+/**
+ * @brief Lists where the blocks of each non-empty shard are, in shard order, without copying them.
+ *
+ * The spans point inside the shards, so they stay valid until the shards are changed or the sharded buffer is
+ * destroyed. No thread may be changing the shards.
+ *
+ * @param buffer A pointer returned by ::nb_sharded_buffer_create
+ * @param spans Where to write the spans. It must have room for ::nb_sharded_shard_count spans.
+ * @return How many spans were written
+ * @ingroup sharded-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT size_t
+nb_sharded_spans(const struct nb_sharded_buffer * buffer, struct nb_sharded_span * spans);
+
+/**
+ * @brief Empties every shard, keeping the memory they allocated so they can be filled again
+ * @param buffer A pointer returned by ::nb_sharded_buffer_create
+ * @ingroup sharded-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_sharded_clear(struct nb_sharded_buffer * buffer);
+
+/**
+ * @brief Appends the blocks of all shards, in shard order, to `destination` and empties the shards.
+ *
+ * `destination` is grown once to fit all blocks. The copy is then split into pieces of about the same size, which may
+ * span several shards, and each piece is copied by a different thread. Shards holding fewer than
+ * ::NB_PARALLEL_COLLECT_THRESHOLD bytes in total are copied on the calling thread. The copy function of the
+ * destination memory context is called from several threads at the same time.
+ *
+ * No thread may be changing the shards while they are collected.
+ *
+ * @param buffer A pointer returned by ::nb_sharded_buffer_create
+ * @param destination A pointer to a ::nb_buffer with the same block size as the shards
+ * @param thread_count How many threads to use, counting the calling one. 0 uses one thread per available processor.
+ * @return ::NB_COLLECT_OK if the blocks were collected, ::NB_COLLECT_BLOCK_SIZE_MISMATCH if `destination` and the
+ * shards have different block sizes or ::NB_COLLECT_OUT_OF_MEMORY if `destination` could not grow. Both the shards and
+ * `destination` are left untouched in the later cases.
+ * @ingroup sharded-buffer
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_COLLECT_RESULT
+nb_sharded_collect(struct nb_sharded_buffer * buffer, struct nb_buffer * destination, size_t thread_count);
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif // NAUGHTY_BUFFERS_SHARDED_BUFFER_H
@@ -0,0 +1,291 @@
+#ifndef NAUGHTY_BUFFERS_SORT_H
+#define NAUGHTY_BUFFERS_SORT_H
+
+/**
+ * @file sort.h
+ * This file contains sorting functions that go beyond ::nb_sort.
+ *
+ * @defgroup sort Sort
+ * ::nb_sort is a thin wrapper over `qsort`: it calls the comparison function through a pointer for every comparison
+ * and swaps blocks byte by byte. The functions here trade that generality for speed when more is known about the
+ * blocks, like where their sorting key is.
+ */
+
+#include "naughty-buffers/buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Buffers with fewer blocks than this are sorted by ::nb_sort_parallel on the calling thread, with ::nb_sort
+ * @ingroup sort
+ */
+#define NB_PARALLEL_SORT_THRESHOLD ((size_t) 1 << 16)
+
+/**
+ * @brief How the bytes of a sorting key are to be interpreted by ::nb_sort_by_key
+ * @ingroup sort
+ */
+enum NB_KEY_TYPE {
+  /** An unsigned integer (`uint8_t`, `uint16_t`, `uint32_t` or `uint64_t`) */
+  NB_KEY_UNSIGNED,
+
+  /** A signed integer (`int8_t`, `int16_t`, `int32_t` or `int64_t`) */
+  NB_KEY_SIGNED,
+
+  /** A floating point number (`float` or `double`). NaNs are sorted after infinity, or before it if negative. */
+  NB_KEY_FLOAT
+};
+
+/**
+ * @brief Result of calling the sorting functions
+ * @ingroup sort
+ */
+enum NB_SORT_RESULT {
+  NB_SORT_OUT_OF_MEMORY,
+
+  /** The key width is not supported by the key type or the key does not fit in a block */
+  NB_SORT_INVALID_KEY,
+
+  NB_SORT_OK
+};
+
+/**
+ * @brief Sorts the buffer in ascending order of a numeric key embedded in each block, using a radix sort.
+ *
+ * The key is the `key_width` bytes at `key_offset` of each block, in the native byte order, interpreted according to
+ * `key_type`. The sort is a least-significant-digit radix sort, one pass per key byte, so it runs in O(n) time with
+ * no comparison function at all. Passes where every key has the same byte are skipped. It is stable: blocks with equal
+ * keys keep their relative order.
+ *
+ * A scratch area as big as the buffer is allocated (and released) through the buffer memory context.
+ *
+ * **Example**
+ * @code
+  struct particle {
+    float x, y;
+    uint32_t cell;
+  };
+
+  int main(void) {
+    struct nb_buffer buffer;
+    nb_init(&buffer, sizeof(struct particle));
+
+    // ... push particles
+
+    nb_sort_by_key(&buffer, offsetof(struct particle, cell), sizeof(uint32_t), NB_KEY_UNSIGNED);
+
+    nb_release(&buffer);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param key_offset Offset, in bytes, of the key inside each block
+ * @param key_width Size of the key in bytes: 1, 2, 4 or 8 for integers, 4 or 8 for floating point numbers
+ * @param key_type How to interpret the key bytes
+ * @return ::NB_SORT_OK if the buffer was sorted. The buffer is left untouched otherwise.
+ * @ingroup sort
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_SORT_RESULT
+nb_sort_by_key(struct nb_buffer * buffer, size_t key_offset, size_t key_width, enum NB_KEY_TYPE key_type);
+
+/**
+ * @brief Sorts the buffer in ascending order according to `compare_fn` using multiple threads.
+ *
+ * The buffer is split into one run per thread and each thread sorts its run with `qsort`. Pairs of sorted runs are
+ * then merged, in rounds, until a single run is left. Every merge is split into independent pieces (by binary searching
+ * where each piece starts in both runs) so all threads keep working until the last round.
+ *
+ * A scratch area as big as the buffer is allocated (and released) through the buffer memory context. Buffers with
+ * fewer than ::NB_PARALLEL_SORT_THRESHOLD blocks, or too few blocks to keep `thread_count` threads busy, are sorted
+ * with ::nb_sort instead. Like ::nb_sort, this sort is not stable. `compare_fn` is called from several threads at the
+ * same time.
+ *
+ * **Example**
+ * @code
+  int int_compare(const void * ptr_a, const void * ptr_b) {
+    int a = *(const int *) ptr_a;
+    int b = *(const int *) ptr_b;
+    return (a > b) - (a < b);
+  }
+
+  int main(void) {
+    struct nb_buffer buffer;
+    nb_init(&buffer, sizeof(int));
+
+    for (int i = 0; i < 100000000; i++) {
+      int value = rand();
+      nb_push(&buffer, &value);
+    }
+
+    nb_sort_parallel(&buffer, int_compare, 0); // one thread per processor
+
+    nb_release(&buffer);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param compare_fn The comparison function, with the same semantics as the one passed to ::nb_sort
+ * @param thread_count How many threads to use, counting the calling one. 0 uses one thread per available processor.
+ * @return ::NB_SORT_OK if the buffer was sorted. The buffer is left untouched otherwise.
+ * @ingroup sort
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_SORT_RESULT
+nb_sort_parallel(struct nb_buffer * buffer, nb_compare_fn compare_fn, size_t thread_count);
+
+/**
+ * @brief Writes to `out_indices` the indices of the blocks of the buffer in the order they would have if it was sorted,
+ * without moving any block.
+ *
+ * After it returns, `out_indices[0]` is the index of the smallest block according to `compare_fn`, `out_indices[1]` the
+ * index of the next one, and so on. Only the indices are moved around, so its cost does not grow with the block size
+ * like the one of ::nb_sort, whose `qsort` swaps whole blocks on most platforms. The indices can then be used to read
+ * the blocks in order, or passed to ::nb_apply_permutation to reorder the buffer, moving each block once. The sort is
+ * a merge sort, so it is stable: indices of blocks that compare equal stay in increasing order.
+ *
+ * A scratch area of one `size_t` for every two blocks is allocated (and released) through the buffer memory context.
+ *
+ * **Example**
+ * @code
+  struct document {
+    char title[240];
+    uint64_t size;
+  };
+
+  int document_compare(const void * ptr_a, const void * ptr_b) {
+    const struct document * a = ptr_a;
+    const struct document * b = ptr_b;
+    return (a->size > b->size) - (a->size < b->size);
+  }
+
+  int main(void) {
+    struct nb_buffer buffer;
+    nb_init(&buffer, sizeof(struct document));
+
+    // ... push documents
+
+    size_t * indices = malloc(nb_block_count(&buffer) * sizeof(size_t));
+    nb_argsort(&buffer, document_compare, indices);
+    nb_apply_permutation(&buffer, indices);
+
+    free(indices);
+    nb_release(&buffer);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param compare_fn The comparison function, with the same semantics as the one passed to ::nb_sort
+ * @param out_indices Where to write the indices. Must have room for ::nb_block_count indices.
+ * @return ::NB_SORT_OK if the indices were written. `out_indices` holds `0, 1, 2...` otherwise.
+ * @ingroup sort
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_SORT_RESULT
+nb_argsort(struct nb_buffer * buffer, nb_compare_fn compare_fn, size_t * out_indices);
+
+/**
+ * @brief Reorders the blocks of the buffer so that block `i` becomes the one that was at `indices[i]`.
+ *
+ * Each cycle of the permutation is followed from its start, so every block is copied exactly once (plus one extra copy
+ * per cycle), instead of being swapped around. `indices` is usually the output of ::nb_argsort, and must hold each
+ * index from `0` to `nb_block_count(buffer) - 1` exactly once.
+ *
+ * A block and one bit per block are allocated (and released) through the buffer memory context.
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param indices The permutation to apply, with ::nb_block_count indices
+ * @return ::NB_SORT_OK if the buffer was reordered. The buffer is left untouched otherwise.
+ * @ingroup sort
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_SORT_RESULT nb_apply_permutation(struct nb_buffer * buffer, const size_t * indices);
+
+/**
+ * @brief Sorts the buffer in ascending order according to `compare_fn`, keeping blocks that compare equal in the
+ * order they were.
+ *
+ * Being stable, sorting by one key and then by another orders the blocks by the second key and, among equal ones, by
+ * the first, without writing a comparison function for both keys at once.
+ *
+ * The sort is an adaptive merge sort in the style of timsort: it looks for runs that are already ascending (or
+ * strictly descending, which are reversed), extends short ones with binary insertions and merges them keeping the
+ * merges balanced. Blocks already in their final place at the ends of two runs are not touched by their merge. Sorted
+ * buffers are sorted with `n - 1` comparisons and buffers that are sorted except for a few blocks are close to that.
+ *
+ * The merges need a scratch area as big as half the buffer. If `scratch` is not NULL, that area is reserved in it (its
+ * blocks are removed, its block size does not matter) and kept there for the next sorts, so sorting repeatedly with
+ * the same scratch buffer does not allocate anything. Otherwise the area is allocated (and released) through the
+ * memory context of `buffer`.
+ *
+ * **Example**
+ * @code
+  int main(void) {
+    struct nb_buffer buffer;
+    struct nb_buffer scratch;
+    nb_init(&buffer, sizeof(struct employee));
+    nb_init(&scratch, sizeof(struct employee));
+
+    // ... push employees
+
+    nb_stable_sort(&buffer, employee_name_compare, &scratch);
+    nb_stable_sort(&buffer, employee_department_compare, &scratch); // by department, then name
+
+    nb_release(&scratch);
+    nb_release(&buffer);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param compare_fn The comparison function, with the same semantics as the one passed to ::nb_sort
+ * @param scratch A pointer to a ::nb_buffer struct to hold the scratch area, or NULL
+ * @return ::NB_SORT_OK if the buffer was sorted. The buffer is left untouched otherwise.
+ * @ingroup sort
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_SORT_RESULT
+nb_stable_sort(struct nb_buffer * buffer, nb_compare_fn compare_fn, struct nb_buffer * scratch);
+
+/**
+ * @brief Sorts a buffer whose first ::nb_sorted_count blocks are already sorted, touching only what is needed.
+ *
+ * The blocks after the sorted prefix are sorted with the same algorithm as ::nb_stable_sort and then merged into the
+ * prefix. The merge starts where the first of those blocks goes, so appending `k` blocks to a sorted buffer of `n`
+ * blocks costs O(n + k log k) instead of the O((n + k) log (n + k)) of sorting everything again, and much less than
+ * O(n) when they go near the end. Blocks that compare equal keep their order.
+ *
+ * `compare_fn` must order blocks the same way as the function used to sort the prefix. A scratch area as big as the
+ * unsorted blocks is allocated (and released) through the buffer memory context.
+ *
+ * **Example**
+ * @code
+  int main(void) {
+    struct nb_buffer buffer;
+    nb_init(&buffer, sizeof(int));
+
+    for (int round = 0; round < 1000; round++) {
+      for (int i = 0; i < 1000; i++) {
+        int value = rand();
+        nb_push(&buffer, &value);
+      }
+      nb_sort_incremental(&buffer, int_compare); // only the new 1000 blocks are sorted
+    }
+
+    nb_release(&buffer);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @param compare_fn The comparison function, with the same semantics as the one passed to ::nb_sort
+ * @return ::NB_SORT_OK if the buffer was sorted. The buffer is left untouched otherwise.
+ * @ingroup sort
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_SORT_RESULT nb_sort_incremental(struct nb_buffer * buffer, nb_compare_fn compare_fn);
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif // NAUGHTY_BUFFERS_SORT_H
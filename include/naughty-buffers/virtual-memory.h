@@ -0,0 +1,202 @@
+#ifndef NAUGHTY_BUFFERS_VIRTUAL_MEMORY_H
+#define NAUGHTY_BUFFERS_VIRTUAL_MEMORY_H
+
+/**
+ * @file virtual-memory.h
+ * This file contains memory contexts that work directly with the operating system virtual memory.
+ *
+ * @defgroup virtual-memory Virtual Memory
+ * Memory contexts that map memory straight from the operating system instead of going through `malloc`.
+ *
+ * The remap memory context backs large blocks with anonymous memory mappings. On Linux, growing them is done with
+ * `mremap`, which moves page table entries instead of copying the contents, so growing a buffer of hundreds of
+ * megabytes costs about the same as growing a small one. On other systems it behaves like the default memory context.
+ *
+ * The reserved memory context reserves a big range of address space for each block up front and only commits (makes
+ * usable) the pages the block needs. Reallocating commits more pages and never moves the block, so pointers returned
+ * by ::nb_at, ::nb_front, ::nb_back and ::nb_iterator stay valid while a buffer grows.
+ *
+ * Mapped buffers, created with ::nb_init_mapped, keep their blocks in a file mapped in shared mode. Changes to the
+ * blocks go straight to the file and reopening it gives back the buffer without parsing or copying anything.
+ */
+
+#include "naughty-buffers/buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Blocks of at least this many bytes are mapped directly by the remap memory context
+ * @ingroup virtual-memory
+ */
+#define NB_REMAP_THRESHOLD ((size_t) 1 << 20)
+
+/**
+ * @brief Returns a memory context that maps large blocks directly and grows them with `mremap`.
+ *
+ * Blocks smaller than ::NB_REMAP_THRESHOLD bytes are allocated with `malloc`. Once a block reaches the threshold it is
+ * copied once to its own anonymous mapping and from then on reallocations never copy its contents.
+ *
+ * **Example**
+ * @code
+  int main(void) {
+    struct nb_buffer buffer;
+    nb_init_advanced(&buffer, sizeof(int), nb_remap_memory_context());
+
+    for (int i = 0; i < 100000000; i++) nb_push(&buffer, &i);
+
+    nb_release(&buffer);
+    return 0;
+  }
+ * @endcode
+ *
+ * @return A pointer to the remap memory context. It is valid for the whole program.
+ * @ingroup virtual-memory
+ */
+NAUGHTY_BUFFERS_EXPORT struct nb_buffer_memory_context * nb_remap_memory_context(void);
+
+/**
+ * @brief A memory context that reserves address space up front and commits it as needed. See ::nb_reserved_memory_init
+ * @ingroup virtual-memory
+ */
+struct nb_reserved_memory {
+  /** The memory context to pass to ::nb_init_advanced and friends */
+  struct nb_buffer_memory_context memory_context;
+
+  /** Maximum size, in bytes, of each block. Each allocation reserves this much address space. */
+  size_t reserve_size;
+};
+
+/**
+ * @brief Initializes a reserved memory context whose blocks can grow up to `reserve_size` bytes without moving.
+ *
+ * Each allocation reserves `reserve_size` bytes of address space (with `mmap` and `PROT_NONE` or `VirtualAlloc` and
+ * `MEM_RESERVE`) but only commits the pages it needs. Reallocations commit or decommit pages and always return the
+ * same pointer, or NULL if the new size does not fit in the reserved range. Reserved but uncommitted pages do not use
+ * physical memory, so `reserve_size` can be much larger than the expected size of the buffers.
+ *
+ * Buffers using this context keep the address of their blocks while growing: pointers to blocks stay valid as long as
+ * the blocks themselves are not moved by removals or insertions.
+ *
+ * **Example**
+ * @code
+  int main(void) {
+    struct nb_reserved_memory reserved;
+    nb_reserved_memory_init(&reserved, (size_t) 1 << 32); // up to 4GiB per buffer
+
+    struct nb_buffer buffer;
+    nb_init_advanced(&buffer, sizeof(int), &reserved.memory_context);
+
+    int value = 10;
+    nb_push(&buffer, &value);
+    int * first = nb_front(&buffer);
+
+    for (int i = 0; i < 100000000; i++) nb_push(&buffer, &i);
+    assert(first == nb_front(&buffer));
+
+    nb_release(&buffer);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param reserved A pointer to a ::nb_reserved_memory struct to be initialized. It must outlive all buffers using it.
+ * @param reserve_size Maximum size, in bytes, of each block allocated through the context
+ * @ingroup virtual-memory
+ */
+NAUGHTY_BUFFERS_EXPORT void nb_reserved_memory_init(struct nb_reserved_memory * reserved, size_t reserve_size);
+
+/**
+ * @brief Flags for ::nb_init_mapped. They can be combined with `|`
+ * @ingroup virtual-memory
+ */
+enum NB_MAP_FLAGS {
+  /** Creates the file if it does not exist */
+  NB_MAP_CREATE = 1,
+
+  /** Discards the contents of the file, starting with an empty buffer */
+  NB_MAP_TRUNCATE = 2
+};
+
+/**
+ * @brief Result of calling ::nb_init_mapped
+ * @ingroup virtual-memory
+ */
+enum NB_MAP_RESULT {
+  NB_MAP_OUT_OF_MEMORY,
+
+  /** The file could not be opened, created or resized */
+  NB_MAP_IO_ERROR,
+
+  /** The file was not written by a mapped buffer or was written with a different block size, or the block size is 0 */
+  NB_MAP_INVALID_FILE,
+
+  /** Mapped buffers are not supported on this platform */
+  NB_MAP_UNSUPPORTED,
+
+  NB_MAP_OK
+};
+
+/**
+ * @brief Result of calling ::nb_sync
+ * @ingroup virtual-memory
+ */
+enum NB_SYNC_RESULT { NB_SYNC_IO_ERROR, NB_SYNC_OK };
+
+/**
+ * @brief Initializes a buffer whose blocks live in the file at `path`, mapped in shared mode.
+ *
+ * The file starts with a small header holding the block size and the block count, followed by the blocks. If the file
+ * already holds a mapped buffer with the same block size, the buffer starts with its blocks, without reading them.
+ *
+ * Growing the buffer extends the file and remaps it, so pointers to blocks are invalidated just like with regular
+ * buffers. Changes are written back to the file by the operating system; call ::nb_sync to write them (and the block
+ * count) right away. ::nb_release stores the block count, unmaps the file and closes it.
+ *
+ * Only the blocks live in the file: other memory taken from the buffer memory context, like the scratch areas of the
+ * sorting functions, is allocated with `malloc`.
+ *
+ * The buffer must not be moved to another address (e.g. by copying the struct) while it is mapped. Mapped buffers are
+ * only supported on POSIX systems, elsewhere this function returns ::NB_MAP_UNSUPPORTED.
+ *
+ * **Example**
+ * @code
+  int main(void) {
+    struct nb_buffer buffer;
+    if (nb_init_mapped(&buffer, sizeof(int), "numbers.nb", NB_MAP_CREATE) != NB_MAP_OK) return 1;
+
+    int value = (int) nb_block_count(&buffer);
+    nb_push(&buffer, &value); // every run of the program adds a number to the file
+
+    nb_release(&buffer);
+    return 0;
+  }
+ * @endcode
+ *
+ * @param buffer A pointer to a ::nb_buffer struct to be initialized
+ * @param block_size The size of each block
+ * @param path The path of the file to map
+ * @param flags A combination of ::NB_MAP_FLAGS
+ * @return ::NB_MAP_OK if the buffer was initialized. The buffer is left untouched otherwise.
+ * @ingroup virtual-memory
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_MAP_RESULT
+nb_init_mapped(struct nb_buffer * buffer, size_t block_size, const char * path, unsigned flags);
+
+/**
+ * @brief Writes the blocks and the block count of a mapped buffer to its file, waiting for the writes to finish.
+ *
+ * Only pages holding blocks are synced, and the operating system only writes the ones that changed. Does nothing for
+ * buffers not created with ::nb_init_mapped.
+ *
+ * @param buffer A pointer to a ::nb_buffer struct
+ * @return ::NB_SYNC_OK if the buffer was written, ::NB_SYNC_IO_ERROR otherwise
+ * @ingroup virtual-memory
+ */
+NAUGHTY_BUFFERS_EXPORT enum NB_SYNC_RESULT nb_sync(struct nb_buffer * buffer);
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif // NAUGHTY_BUFFERS_VIRTUAL_MEMORY_H
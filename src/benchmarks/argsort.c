@@ -0,0 +1,57 @@
+#include "naughty-buffers/sort.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Sorts buffers of 256-byte blocks with nb_sort and with nb_argsort followed by nb_apply_permutation.
+ */
+
+struct record {
+  uint32_t key;
+  uint8_t payload[252];
+};
+
+static int record_compare(const void * ptr_a, const void * ptr_b) {
+  const struct record * a = ptr_a;
+  const struct record * b = ptr_b;
+  return (a->key > b->key) - (a->key < b->key);
+}
+
+static uint32_t next_random(uint64_t * state) {
+  *state = *state * 6364136223846793005u + 1442695040888963407u;
+  return (uint32_t) (*state >> 32);
+}
+
+static void fill(struct nb_buffer * buffer, size_t count) {
+  uint64_t state = 42;
+  nb_init(buffer, sizeof(struct record));
+  struct record * records = nb_push_uninit(buffer, count);
+  for (size_t i = 0; i < count; i++) records[i].key = next_random(&state);
+}
+
+int main(void) {
+  printf("%12s %16s %16s %10s\n", "blocks", "nb_sort (ms)", "argsort (ms)", "speedup");
+  for (size_t count = 1000; count <= 1000000; count *= 10) {
+    struct nb_buffer buffer;
+
+    fill(&buffer, count);
+    double start = bench_now();
+    nb_sort(&buffer, record_compare);
+    const double sort_time = bench_now() - start;
+    nb_release(&buffer);
+
+    fill(&buffer, count);
+    size_t * indices = malloc(count * sizeof(size_t));
+    start = bench_now();
+    nb_argsort(&buffer, record_compare, indices);
+    nb_apply_permutation(&buffer, indices);
+    const double argsort_time = bench_now() - start;
+    free(indices);
+    nb_release(&buffer);
+
+    printf("%12zu %16.2f %16.2f %9.1fx\n", count, sort_time * 1e3, argsort_time * 1e3, sort_time / argsort_time);
+  }
+
+  return 0;
+}
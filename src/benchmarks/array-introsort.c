@@ -0,0 +1,60 @@
+#include "naughty-buffers/array-generator.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Sorts typed arrays of 8-byte blocks (a 32-bit key and a 32-bit payload) with the generated T_sort, which goes through
+ * nb_sort, and with the generated T_introsort.
+ */
+
+struct record {
+  uint32_t key;
+  uint32_t payload;
+};
+
+NAUGHTY_BUFFERS_ARRAY_DECLARATION(record_array, struct record)
+NAUGHTY_BUFFERS_ARRAY_DEFINITION(record_array, struct record)
+NAUGHTY_BUFFERS_ARRAY_SORT_DECLARATION(record_array, struct record)
+NAUGHTY_BUFFERS_ARRAY_SORT_DEFINITION(record_array, struct record, a->key < b->key)
+
+static int record_compare(const void * ptr_a, const void * ptr_b) {
+  const struct record * a = ptr_a;
+  const struct record * b = ptr_b;
+  return (a->key > b->key) - (a->key < b->key);
+}
+
+static uint32_t next_random(uint64_t * state) {
+  *state = *state * 6364136223846793005u + 1442695040888963407u;
+  return (uint32_t) (*state >> 32);
+}
+
+static void fill(struct record_array * array, size_t count) {
+  uint64_t state = 42;
+  record_array_init(array);
+  struct record * records = record_array_push_uninit(array, count);
+  for (size_t i = 0; i < count; i++) records[i] = (struct record) {.key = next_random(&state), .payload = (uint32_t) i};
+}
+
+int main(void) {
+  printf("%12s %16s %16s %10s\n", "blocks", "T_sort (ms)", "introsort (ms)", "speedup");
+  for (size_t count = 1000; count <= 10000000; count *= 10) {
+    struct record_array array;
+
+    fill(&array, count);
+    double start = bench_now();
+    record_array_sort(&array, record_compare);
+    const double qsort_time = bench_now() - start;
+    record_array_release(&array);
+
+    fill(&array, count);
+    start = bench_now();
+    record_array_introsort(&array);
+    const double introsort_time = bench_now() - start;
+    record_array_release(&array);
+
+    printf("%12zu %16.2f %16.2f %9.1fx\n", count, qsort_time * 1e3, introsort_time * 1e3, qsort_time / introsort_time);
+  }
+
+  return 0;
+}
@@ -0,0 +1,23 @@
+#ifndef NAUGHTY_BUFFERS_BENCH_H
+#define NAUGHTY_BUFFERS_BENCH_H
+
+#if defined(_WIN32)
+#include <windows.h>
+
+static double bench_now(void) {
+  LARGE_INTEGER frequency, counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return (double) counter.QuadPart / (double) frequency.QuadPart;
+}
+#else
+#include <time.h>
+
+static double bench_now(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+#endif
+
+#endif // NAUGHTY_BUFFERS_BENCH_H
@@ -0,0 +1,216 @@
+#include "naughty-buffers/channel.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Producers send 1 million 64-byte messages in total to as many consumers, through a bounded queue of 256 messages:
+ * a ring of blocks in a regular buffer guarded by a mutex and two condition variables, and a channel. Reports the
+ * time per message for 1 producer and 1 consumer and for 4 of each.
+ */
+
+#if defined(_WIN32)
+typedef HANDLE bench_thread;
+typedef SRWLOCK bench_mutex;
+typedef CONDITION_VARIABLE bench_cond;
+
+static DWORD WINAPI bench_thread_entry(LPVOID argument);
+
+static void bench_thread_start(bench_thread * thread, void * argument) {
+  *thread = CreateThread(NULL, 0, bench_thread_entry, argument, 0, NULL);
+}
+
+static void bench_thread_join(bench_thread thread) {
+  WaitForSingleObject(thread, INFINITE);
+  CloseHandle(thread);
+}
+
+static void bench_mutex_init(bench_mutex * mutex) { InitializeSRWLock(mutex); }
+static void bench_mutex_lock(bench_mutex * mutex) { AcquireSRWLockExclusive(mutex); }
+static void bench_mutex_unlock(bench_mutex * mutex) { ReleaseSRWLockExclusive(mutex); }
+static void bench_mutex_destroy(bench_mutex * mutex) { (void) mutex; }
+static void bench_cond_init(bench_cond * cond) { InitializeConditionVariable(cond); }
+static void bench_cond_wait(bench_cond * cond, bench_mutex * mutex) {
+  SleepConditionVariableSRW(cond, mutex, INFINITE, 0);
+}
+static void bench_cond_signal(bench_cond * cond) { WakeConditionVariable(cond); }
+static void bench_cond_broadcast(bench_cond * cond) { WakeAllConditionVariable(cond); }
+static void bench_cond_destroy(bench_cond * cond) { (void) cond; }
+#else
+#include <pthread.h>
+
+typedef pthread_t bench_thread;
+typedef pthread_mutex_t bench_mutex;
+typedef pthread_cond_t bench_cond;
+
+static void * bench_thread_entry(void * argument);
+
+static void bench_thread_start(bench_thread * thread, void * argument) {
+  pthread_create(thread, NULL, bench_thread_entry, argument);
+}
+
+static void bench_thread_join(bench_thread thread) { pthread_join(thread, NULL); }
+static void bench_mutex_init(bench_mutex * mutex) { pthread_mutex_init(mutex, NULL); }
+static void bench_mutex_lock(bench_mutex * mutex) { pthread_mutex_lock(mutex); }
+static void bench_mutex_unlock(bench_mutex * mutex) { pthread_mutex_unlock(mutex); }
+static void bench_mutex_destroy(bench_mutex * mutex) { pthread_mutex_destroy(mutex); }
+static void bench_cond_init(bench_cond * cond) { pthread_cond_init(cond, NULL); }
+static void bench_cond_wait(bench_cond * cond, bench_mutex * mutex) { pthread_cond_wait(cond, mutex); }
+static void bench_cond_signal(bench_cond * cond) { pthread_cond_signal(cond); }
+static void bench_cond_broadcast(bench_cond * cond) { pthread_cond_broadcast(cond); }
+static void bench_cond_destroy(bench_cond * cond) { pthread_cond_destroy(cond); }
+#endif
+
+#define TOTAL_MESSAGES 1000000
+#define CAPACITY 256
+#define MAX_PAIRS 4
+
+struct message {
+  uint64_t sequence;
+  uint32_t producer;
+  uint8_t payload[52];
+};
+
+// the queue every pipeline used before channels: a ring of blocks in a buffer, under a mutex
+struct locked_queue {
+  bench_mutex mutex;
+  bench_cond not_empty;
+  bench_cond not_full;
+  struct nb_buffer ring;
+  size_t head;
+  size_t count;
+  int closed;
+};
+
+struct shared {
+  int use_channel;
+  size_t messages_per_producer;
+  struct locked_queue queue;
+  struct nb_channel * channel;
+};
+
+struct worker {
+  struct shared * shared;
+  uint32_t id;
+  int producer;
+  size_t received;
+};
+
+static void locked_send(struct locked_queue * queue, const struct message * message) {
+  bench_mutex_lock(&queue->mutex);
+  while (queue->count == CAPACITY) bench_cond_wait(&queue->not_full, &queue->mutex);
+  memcpy(nb_at(&queue->ring, (queue->head + queue->count) % CAPACITY), message, sizeof(*message));
+  queue->count++;
+  bench_cond_signal(&queue->not_empty);
+  bench_mutex_unlock(&queue->mutex);
+}
+
+static int locked_receive(struct locked_queue * queue, struct message * message) {
+  bench_mutex_lock(&queue->mutex);
+  while (queue->count == 0 && !queue->closed) bench_cond_wait(&queue->not_empty, &queue->mutex);
+  if (queue->count == 0) {
+    bench_mutex_unlock(&queue->mutex);
+    return 0;
+  }
+  memcpy(message, nb_at(&queue->ring, queue->head), sizeof(*message));
+  queue->head = (queue->head + 1) % CAPACITY;
+  queue->count--;
+  bench_cond_signal(&queue->not_full);
+  bench_mutex_unlock(&queue->mutex);
+  return 1;
+}
+
+static void locked_close(struct locked_queue * queue) {
+  bench_mutex_lock(&queue->mutex);
+  queue->closed = 1;
+  bench_cond_broadcast(&queue->not_empty);
+  bench_mutex_unlock(&queue->mutex);
+}
+
+static void work(struct worker * worker) {
+  struct shared * shared = worker->shared;
+  struct message message = {0, worker->id, {0}};
+
+  if (worker->producer) {
+    for (size_t i = 0; i < shared->messages_per_producer; i++) {
+      message.sequence = i;
+      if (shared->use_channel) nb_channel_send(shared->channel, &message, NB_CHANNEL_WAIT_FOREVER);
+      else locked_send(&shared->queue, &message);
+    }
+    return;
+  }
+
+  for (;;) {
+    const int received = shared->use_channel
+                           ? nb_channel_receive(shared->channel, &message, NB_CHANNEL_WAIT_FOREVER) == NB_RECEIVE_OK
+                           : locked_receive(&shared->queue, &message);
+    if (!received) return;
+    worker->received++;
+  }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI bench_thread_entry(LPVOID argument) {
+  work(argument);
+  return 0;
+}
+#else
+static void * bench_thread_entry(void * argument) {
+  work(argument);
+  return NULL;
+}
+#endif
+
+static double run(int use_channel, uint32_t pairs) {
+  struct shared shared = {.use_channel = use_channel, .messages_per_producer = TOTAL_MESSAGES / pairs};
+  struct worker workers[MAX_PAIRS * 2];
+  bench_thread threads[MAX_PAIRS * 2];
+
+  bench_mutex_init(&shared.queue.mutex);
+  bench_cond_init(&shared.queue.not_empty);
+  bench_cond_init(&shared.queue.not_full);
+  nb_init(&shared.queue.ring, sizeof(struct message));
+  const struct message empty = {0};
+  for (size_t i = 0; i < CAPACITY; i++) nb_push(&shared.queue.ring, (void *) &empty);
+  shared.channel = nb_channel_create(sizeof(struct message), CAPACITY);
+
+  const double start = bench_now();
+  for (uint32_t t = 0; t < pairs * 2; t++) {
+    workers[t] = (struct worker) {&shared, t % pairs, t < pairs, 0};
+    bench_thread_start(&threads[t], &workers[t]);
+  }
+  for (uint32_t t = 0; t < pairs; t++) bench_thread_join(threads[t]);
+  if (use_channel) nb_channel_close(shared.channel);
+  else locked_close(&shared.queue);
+  for (uint32_t t = pairs; t < pairs * 2; t++) bench_thread_join(threads[t]);
+  const double elapsed = bench_now() - start;
+
+  size_t received = 0;
+  for (uint32_t t = pairs; t < pairs * 2; t++) received += workers[t].received;
+  if (received != shared.messages_per_producer * pairs) {
+    fprintf(stderr, "expected %zu messages, got %zu\n", shared.messages_per_producer * pairs, received);
+    exit(1);
+  }
+
+  nb_channel_destroy(shared.channel);
+  nb_release(&shared.queue.ring);
+  bench_cond_destroy(&shared.queue.not_full);
+  bench_cond_destroy(&shared.queue.not_empty);
+  bench_mutex_destroy(&shared.queue.mutex);
+  return elapsed / (double) received;
+}
+
+int main(void) {
+  const uint32_t pair_counts[] = {1, MAX_PAIRS};
+
+  printf("%12s %22s %22s %10s\n", "producers", "condvar queue (ns/msg)", "channel (ns/msg)", "speedup");
+  for (size_t i = 0; i < sizeof(pair_counts) / sizeof(pair_counts[0]); i++) {
+    const double locked_time = run(0, pair_counts[i]);
+    const double channel_time = run(1, pair_counts[i]);
+    const double speedup = locked_time / channel_time;
+    printf("%12u %22.1f %22.1f %9.1fx\n", pair_counts[i], locked_time * 1e9, channel_time * 1e9, speedup);
+  }
+
+  return 0;
+}
@@ -0,0 +1,144 @@
+#include "naughty-buffers/concurrent-buffer.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Several threads append 2 million 64-byte log records in total to one buffer: a regular buffer with every nb_push
+ * under a global mutex, and a concurrent buffer with nb_concurrent_push. Pass the maximum thread count as the first
+ * argument (default 8); thread counts double from 1 up to it.
+ */
+
+#if defined(_WIN32)
+typedef HANDLE bench_thread;
+typedef SRWLOCK bench_mutex;
+
+static DWORD WINAPI bench_thread_entry(LPVOID argument);
+
+static void bench_thread_start(bench_thread * thread, void * argument) {
+  *thread = CreateThread(NULL, 0, bench_thread_entry, argument, 0, NULL);
+}
+
+static void bench_thread_join(bench_thread thread) {
+  WaitForSingleObject(thread, INFINITE);
+  CloseHandle(thread);
+}
+
+static void bench_mutex_init(bench_mutex * mutex) { InitializeSRWLock(mutex); }
+static void bench_mutex_lock(bench_mutex * mutex) { AcquireSRWLockExclusive(mutex); }
+static void bench_mutex_unlock(bench_mutex * mutex) { ReleaseSRWLockExclusive(mutex); }
+static void bench_mutex_destroy(bench_mutex * mutex) { (void) mutex; }
+#else
+#include <pthread.h>
+
+typedef pthread_t bench_thread;
+typedef pthread_mutex_t bench_mutex;
+
+static void * bench_thread_entry(void * argument);
+
+static void bench_thread_start(bench_thread * thread, void * argument) {
+  pthread_create(thread, NULL, bench_thread_entry, argument);
+}
+
+static void bench_thread_join(bench_thread thread) { pthread_join(thread, NULL); }
+static void bench_mutex_init(bench_mutex * mutex) { pthread_mutex_init(mutex, NULL); }
+static void bench_mutex_lock(bench_mutex * mutex) { pthread_mutex_lock(mutex); }
+static void bench_mutex_unlock(bench_mutex * mutex) { pthread_mutex_unlock(mutex); }
+static void bench_mutex_destroy(bench_mutex * mutex) { pthread_mutex_destroy(mutex); }
+#endif
+
+#define TOTAL_RECORDS 2000000
+#define MAX_THREADS 64
+
+struct log_record {
+  uint64_t timestamp;
+  uint32_t thread;
+  uint32_t level;
+  char message[48];
+};
+
+struct shared {
+  int concurrent;
+  size_t records_per_thread;
+  bench_mutex mutex;
+  struct nb_buffer buffer;
+  struct nb_concurrent_buffer * concurrent_buffer;
+};
+
+struct worker {
+  struct shared * shared;
+  uint32_t id;
+};
+
+static void append(struct worker * worker) {
+  struct shared * shared = worker->shared;
+  struct log_record record = {0, worker->id, 1, "request handled"};
+
+  for (size_t i = 0; i < shared->records_per_thread; i++) {
+    record.timestamp = i;
+    if (shared->concurrent) {
+      nb_concurrent_push(shared->concurrent_buffer, &record);
+    } else {
+      bench_mutex_lock(&shared->mutex);
+      nb_push(&shared->buffer, &record);
+      bench_mutex_unlock(&shared->mutex);
+    }
+  }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI bench_thread_entry(LPVOID argument) {
+  append(argument);
+  return 0;
+}
+#else
+static void * bench_thread_entry(void * argument) {
+  append(argument);
+  return NULL;
+}
+#endif
+
+static double run(int concurrent, size_t thread_count) {
+  struct shared shared = {.concurrent = concurrent, .records_per_thread = TOTAL_RECORDS / thread_count};
+  struct worker workers[MAX_THREADS];
+  bench_thread threads[MAX_THREADS];
+  bench_mutex_init(&shared.mutex);
+  nb_init(&shared.buffer, sizeof(struct log_record));
+  shared.concurrent_buffer = nb_concurrent_buffer_create(sizeof(struct log_record));
+
+  const double start = bench_now();
+  for (size_t t = 0; t < thread_count; t++) {
+    workers[t] = (struct worker) {&shared, (uint32_t) t};
+    bench_thread_start(&threads[t], &workers[t]);
+  }
+  for (size_t t = 0; t < thread_count; t++) bench_thread_join(threads[t]);
+  const double elapsed = bench_now() - start;
+
+  const size_t expected = shared.records_per_thread * thread_count;
+  const size_t appended = concurrent ? nb_concurrent_published_count(shared.concurrent_buffer)
+                                     : nb_block_count(&shared.buffer);
+  if (appended != expected) {
+    fprintf(stderr, "expected %zu records, got %zu\n", expected, appended);
+    exit(1);
+  }
+
+  nb_concurrent_buffer_destroy(shared.concurrent_buffer);
+  nb_release(&shared.buffer);
+  bench_mutex_destroy(&shared.mutex);
+  return elapsed;
+}
+
+int main(int argc, char ** argv) {
+  size_t max_threads = argc > 1 ? (size_t) strtoul(argv[1], NULL, 10) : 8;
+  if (max_threads > MAX_THREADS) max_threads = MAX_THREADS;
+
+  printf("%12s %20s %20s %10s\n", "threads", "mutex + nb_push (ms)", "concurrent (ms)", "speedup");
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    const double mutex_time = run(0, threads);
+    const double concurrent_time = run(1, threads);
+    const double speedup = mutex_time / concurrent_time;
+    printf("%12zu %20.2f %20.2f %9.1fx\n", threads, mutex_time * 1e3, concurrent_time * 1e3, speedup);
+  }
+
+  return 0;
+}
@@ -0,0 +1,46 @@
+#include "naughty-buffers/virtual-memory.h"
+#include "bench.h"
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Measures how long a single reallocation takes when a buffer of a given size doubles, for the default memory
+ * context and for the remap memory context.
+ */
+
+static double realloc_latency(struct nb_buffer_memory_context * ctx, size_t size) {
+  void * ptr = ctx->alloc_fn(size, ctx->context);
+  if (ptr == NULL) return -1;
+  memset(ptr, 1, size);
+
+  const double start = bench_now();
+  void * new_ptr = ctx->realloc_fn(ptr, size * 2, ctx->context);
+  const double elapsed = bench_now() - start;
+
+  ctx->free_fn(new_ptr != NULL ? new_ptr : ptr, ctx->context);
+  return new_ptr != NULL ? elapsed : -1;
+}
+
+static struct nb_buffer_memory_context * default_memory_context(void) {
+  static struct nb_buffer_memory_context ctx;
+  struct nb_buffer buffer;
+  nb_init(&buffer, 1);
+  ctx = *buffer.memory_context;
+  nb_release(&buffer);
+  return &ctx;
+}
+
+int main(void) {
+  struct nb_buffer_memory_context * default_ctx = default_memory_context();
+  struct nb_buffer_memory_context * remap_ctx = nb_remap_memory_context();
+
+  printf("%12s %16s %16s\n", "size (MiB)", "default (us)", "remap (us)");
+  for (size_t mib = 1; mib <= 512; mib *= 2) {
+    const size_t size = mib << 20;
+    const double default_latency = realloc_latency(default_ctx, size);
+    const double remap_latency = realloc_latency(remap_ctx, size);
+    printf("%12zu %16.1f %16.1f\n", mib, default_latency * 1e6, remap_latency * 1e6);
+  }
+
+  return 0;
+}
@@ -0,0 +1,97 @@
+#include "naughty-buffers/array-generator.h"
+#include "naughty-buffers/search.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Looks up random keys in sorted tables of 32-bit integers, from 1 thousand up to 100 million blocks (or the count
+ * given as the first argument), with:
+ * - a plain binary search reading blocks through nb_at
+ * - nb_lower_bound
+ * - the lower bound generated by NAUGHTY_BUFFERS_ARRAY_SEARCH_DEFINITION
+ * - nb_eytzinger_find over a copy built with nb_build_eytzinger
+ */
+
+NAUGHTY_BUFFERS_ARRAY_DECLARATION(u32_array, uint32_t)
+NAUGHTY_BUFFERS_ARRAY_DEFINITION(u32_array, uint32_t)
+NAUGHTY_BUFFERS_ARRAY_SEARCH_DECLARATION(u32_array, uint32_t)
+NAUGHTY_BUFFERS_ARRAY_SEARCH_DEFINITION(u32_array, uint32_t, *a < *b)
+
+#define LOOKUPS 2000000
+
+static int u32_compare(const void * ptr_a, const void * ptr_b) {
+  const uint32_t a = *(const uint32_t *) ptr_a;
+  const uint32_t b = *(const uint32_t *) ptr_b;
+  return (a > b) - (a < b);
+}
+
+static uint32_t next_random(uint64_t * state) {
+  *state = *state * 6364136223846793005u + 1442695040888963407u;
+  return (uint32_t) (*state >> 32);
+}
+
+static size_t plain_binary_search(const struct nb_buffer * buffer, uint32_t key) {
+  size_t low = 0;
+  size_t high = nb_block_count(buffer);
+  while (low < high) {
+    const size_t middle = low + (high - low) / 2;
+    if (*(uint32_t *) nb_at(buffer, middle) < key) low = middle + 1;
+    else high = middle;
+  }
+  return low;
+}
+
+int main(int argc, char ** argv) {
+  const size_t max_count = argc > 1 ? (size_t) strtoull(argv[1], NULL, 10) : 100000000;
+  uint32_t * keys = malloc(LOOKUPS * sizeof(uint32_t));
+
+  printf("%12s %14s %14s %14s %14s\n", "blocks", "nb_at (ns)", "lower (ns)", "typed (ns)", "eytzinger (ns)");
+  for (size_t count = 1000; count <= max_count; count *= 10) {
+    struct u32_array sorted;
+    struct nb_buffer eytzinger;
+    u32_array_init(&sorted);
+    nb_init(&eytzinger, sizeof(uint32_t));
+
+    // odd values only, so half of the lookups miss
+    uint32_t * blocks = u32_array_push_uninit(&sorted, count);
+    for (size_t i = 0; i < count; i++) blocks[i] = (uint32_t) (i * 2 + 1);
+    nb_build_eytzinger(&sorted.buffer, &eytzinger);
+
+    uint64_t state = 42;
+    for (size_t i = 0; i < LOOKUPS; i++) keys[i] = next_random(&state) % (uint32_t) (count * 2);
+
+    size_t checksum = 0;
+    double start = bench_now();
+    for (size_t i = 0; i < LOOKUPS; i++) checksum += plain_binary_search(&sorted.buffer, keys[i]);
+    const double plain_time = bench_now() - start;
+
+    start = bench_now();
+    for (size_t i = 0; i < LOOKUPS; i++) checksum += nb_lower_bound(&sorted.buffer, &keys[i], u32_compare);
+    const double lower_time = bench_now() - start;
+
+    start = bench_now();
+    for (size_t i = 0; i < LOOKUPS; i++) checksum += u32_array_lower_bound(&sorted, &keys[i]);
+    const double typed_time = bench_now() - start;
+
+    start = bench_now();
+    for (size_t i = 0; i < LOOKUPS; i++) checksum += nb_eytzinger_find(&eytzinger, &keys[i], u32_compare);
+    const double eytzinger_time = bench_now() - start;
+
+    printf(
+        "%12zu %14.1f %14.1f %14.1f %14.1f%s\n",
+        count,
+        plain_time * 1e9 / LOOKUPS,
+        lower_time * 1e9 / LOOKUPS,
+        typed_time * 1e9 / LOOKUPS,
+        eytzinger_time * 1e9 / LOOKUPS,
+        checksum == 0 ? " " : ""
+    );
+
+    nb_release(&eytzinger);
+    u32_array_release(&sorted);
+  }
+
+  free(keys);
+  return 0;
+}
@@ -0,0 +1,170 @@
+#include "naughty-buffers/sharded-buffer.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Several threads produce 4 million 64-byte results in total that end up in one buffer: a regular buffer with every
+ * nb_push under a global mutex, and a sharded buffer with one shard per thread collected at the end (with one thread
+ * and with one per producer). Pass the maximum thread count as the first argument (default 8); thread counts double
+ * from 1 up to it.
+ */
+
+#if defined(_WIN32)
+typedef HANDLE bench_thread;
+typedef SRWLOCK bench_mutex;
+
+static DWORD WINAPI bench_thread_entry(LPVOID argument);
+
+static void bench_thread_start(bench_thread * thread, void * argument) {
+  *thread = CreateThread(NULL, 0, bench_thread_entry, argument, 0, NULL);
+}
+
+static void bench_thread_join(bench_thread thread) {
+  WaitForSingleObject(thread, INFINITE);
+  CloseHandle(thread);
+}
+
+static void bench_mutex_init(bench_mutex * mutex) { InitializeSRWLock(mutex); }
+static void bench_mutex_lock(bench_mutex * mutex) { AcquireSRWLockExclusive(mutex); }
+static void bench_mutex_unlock(bench_mutex * mutex) { ReleaseSRWLockExclusive(mutex); }
+static void bench_mutex_destroy(bench_mutex * mutex) { (void) mutex; }
+#else
+#include <pthread.h>
+
+typedef pthread_t bench_thread;
+typedef pthread_mutex_t bench_mutex;
+
+static void * bench_thread_entry(void * argument);
+
+static void bench_thread_start(bench_thread * thread, void * argument) {
+  pthread_create(thread, NULL, bench_thread_entry, argument);
+}
+
+static void bench_thread_join(bench_thread thread) { pthread_join(thread, NULL); }
+static void bench_mutex_init(bench_mutex * mutex) { pthread_mutex_init(mutex, NULL); }
+static void bench_mutex_lock(bench_mutex * mutex) { pthread_mutex_lock(mutex); }
+static void bench_mutex_unlock(bench_mutex * mutex) { pthread_mutex_unlock(mutex); }
+static void bench_mutex_destroy(bench_mutex * mutex) { pthread_mutex_destroy(mutex); }
+#endif
+
+#define TOTAL_RESULTS 4000000
+#define MAX_THREADS 64
+
+struct result {
+  uint64_t id;
+  uint32_t thread;
+  float score;
+  uint8_t features[48];
+};
+
+struct shared {
+  int sharded;
+  size_t results_per_thread;
+  bench_mutex mutex;
+  struct nb_buffer buffer;
+  struct nb_sharded_buffer * sharded_buffer;
+};
+
+struct worker {
+  struct shared * shared;
+  uint32_t id;
+};
+
+static void produce(struct worker * worker) {
+  struct shared * shared = worker->shared;
+  struct result result = {0, worker->id, 0.5f, {0}};
+
+  if (shared->sharded) {
+    struct nb_buffer * shard = nb_sharded_shard(shared->sharded_buffer, worker->id);
+    for (size_t i = 0; i < shared->results_per_thread; i++) {
+      result.id = i;
+      nb_push(shard, &result);
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < shared->results_per_thread; i++) {
+    result.id = i;
+    bench_mutex_lock(&shared->mutex);
+    nb_push(&shared->buffer, &result);
+    bench_mutex_unlock(&shared->mutex);
+  }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI bench_thread_entry(LPVOID argument) {
+  produce(argument);
+  return 0;
+}
+#else
+static void * bench_thread_entry(void * argument) {
+  produce(argument);
+  return NULL;
+}
+#endif
+
+// returns the time taken to produce all results, and writes the time taken to collect them to `collect_time`
+static double run(int sharded, size_t thread_count, size_t collect_threads, double * collect_time) {
+  struct shared shared = {.sharded = sharded, .results_per_thread = TOTAL_RESULTS / thread_count};
+  struct worker workers[MAX_THREADS];
+  bench_thread threads[MAX_THREADS];
+  bench_mutex_init(&shared.mutex);
+  nb_init(&shared.buffer, sizeof(struct result));
+  shared.sharded_buffer = nb_sharded_buffer_create(sizeof(struct result), thread_count);
+
+  const double start = bench_now();
+  for (size_t t = 0; t < thread_count; t++) {
+    workers[t] = (struct worker) {&shared, (uint32_t) t};
+    bench_thread_start(&threads[t], &workers[t]);
+  }
+  for (size_t t = 0; t < thread_count; t++) bench_thread_join(threads[t]);
+  const double produced = bench_now();
+  if (sharded) nb_sharded_collect(shared.sharded_buffer, &shared.buffer, collect_threads);
+  const double collected = bench_now();
+
+  const size_t expected = shared.results_per_thread * thread_count;
+  if (nb_block_count(&shared.buffer) != expected) {
+    fprintf(stderr, "expected %zu results, got %zu\n", expected, nb_block_count(&shared.buffer));
+    exit(1);
+  }
+
+  nb_sharded_buffer_destroy(shared.sharded_buffer);
+  nb_release(&shared.buffer);
+  bench_mutex_destroy(&shared.mutex);
+  *collect_time = collected - produced;
+  return produced - start;
+}
+
+int main(int argc, char ** argv) {
+  size_t max_threads = argc > 1 ? (size_t) strtoul(argv[1], NULL, 10) : 8;
+  if (max_threads > MAX_THREADS) max_threads = MAX_THREADS;
+
+  printf(
+      "%8s %14s %14s %18s %18s %9s\n",
+      "threads",
+      "mutex (ms)",
+      "sharded (ms)",
+      "collect 1t (ms)",
+      "collect Nt (ms)",
+      "speedup"
+  );
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    double unused, serial_collect, parallel_collect;
+    const double mutex_time = run(0, threads, 0, &unused);
+    run(1, threads, 1, &serial_collect);
+    const double sharded_time = run(1, threads, threads, &parallel_collect);
+    const double speedup = mutex_time / (sharded_time + parallel_collect);
+    printf(
+        "%8zu %14.2f %14.2f %18.2f %18.2f %8.1fx\n",
+        threads,
+        mutex_time * 1e3,
+        sharded_time * 1e3,
+        serial_collect * 1e3,
+        parallel_collect * 1e3,
+        speedup
+    );
+  }
+
+  return 0;
+}
@@ -0,0 +1,54 @@
+#include "naughty-buffers/sort.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Sorts buffers of 8-byte blocks (a 32-bit key and a 32-bit payload) with nb_sort and with nb_sort_by_key.
+ */
+
+struct record {
+  uint32_t key;
+  uint32_t payload;
+};
+
+static int record_compare(const void * ptr_a, const void * ptr_b) {
+  const struct record * a = ptr_a;
+  const struct record * b = ptr_b;
+  return (a->key > b->key) - (a->key < b->key);
+}
+
+static uint32_t next_random(uint64_t * state) {
+  *state = *state * 6364136223846793005u + 1442695040888963407u;
+  return (uint32_t) (*state >> 32);
+}
+
+static void fill(struct nb_buffer * buffer, size_t count) {
+  uint64_t state = 42;
+  nb_init(buffer, sizeof(struct record));
+  struct record * records = nb_push_uninit(buffer, count);
+  for (size_t i = 0; i < count; i++) records[i] = (struct record) {.key = next_random(&state), .payload = (uint32_t) i};
+}
+
+int main(void) {
+  printf("%12s %16s %16s %10s\n", "blocks", "nb_sort (ms)", "by key (ms)", "speedup");
+  for (size_t count = 1000; count <= 10000000; count *= 10) {
+    struct nb_buffer buffer;
+
+    fill(&buffer, count);
+    double start = bench_now();
+    nb_sort(&buffer, record_compare);
+    const double qsort_time = bench_now() - start;
+    nb_release(&buffer);
+
+    fill(&buffer, count);
+    start = bench_now();
+    nb_sort_by_key(&buffer, 0, sizeof(uint32_t), NB_KEY_UNSIGNED);
+    const double radix_time = bench_now() - start;
+    nb_release(&buffer);
+
+    printf("%12zu %16.2f %16.2f %9.1fx\n", count, qsort_time * 1e3, radix_time * 1e3, qsort_time / radix_time);
+  }
+
+  return 0;
+}
@@ -0,0 +1,57 @@
+#include "naughty-buffers/sort.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Starts with 1 million sorted 8-byte blocks and runs rounds of appending 5000 random blocks and sorting the buffer
+ * again, with nb_sort and with nb_sort_incremental.
+ */
+
+struct record {
+  uint32_t key;
+  uint32_t payload;
+};
+
+static int record_compare(const void * ptr_a, const void * ptr_b) {
+  const struct record * a = ptr_a;
+  const struct record * b = ptr_b;
+  return (a->key > b->key) - (a->key < b->key);
+}
+
+static uint32_t next_random(uint64_t * state) {
+  *state = *state * 6364136223846793005u + 1442695040888963407u;
+  return (uint32_t) (*state >> 32);
+}
+
+static void append(struct nb_buffer * buffer, size_t count, uint64_t * state) {
+  struct record * records = nb_push_uninit(buffer, count);
+  for (size_t i = 0; i < count; i++) records[i] = (struct record) {.key = next_random(state), .payload = (uint32_t) i};
+}
+
+static double run(uint8_t incremental) {
+  const size_t rounds = 20;
+  uint64_t state = 42;
+  struct nb_buffer buffer;
+  nb_init(&buffer, sizeof(struct record));
+  append(&buffer, 1000000, &state);
+  nb_sort(&buffer, record_compare);
+
+  double start = bench_now();
+  for (size_t round = 0; round < rounds; round++) {
+    append(&buffer, 5000, &state);
+    if (incremental) nb_sort_incremental(&buffer, record_compare);
+    else nb_sort(&buffer, record_compare);
+  }
+  const double time = (bench_now() - start) / (double) rounds;
+  nb_release(&buffer);
+  return time;
+}
+
+int main(void) {
+  const double sort_time = run(0);
+  const double incremental_time = run(1);
+  printf("%16s %16s %10s\n", "nb_sort (ms)", "incremental (ms)", "speedup");
+  printf("%16.2f %16.2f %9.1fx\n", sort_time * 1e3, incremental_time * 1e3, sort_time / incremental_time);
+  return 0;
+}
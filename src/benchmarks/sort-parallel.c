@@ -0,0 +1,58 @@
+#include "naughty-buffers/sort.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Sorts a buffer of 20 million 8-byte blocks (a 32-bit key and a 32-bit payload) with nb_sort and with
+ * nb_sort_parallel, doubling the thread count up to the number of processors.
+ */
+
+struct record {
+  uint32_t key;
+  uint32_t payload;
+};
+
+static int record_compare(const void * ptr_a, const void * ptr_b) {
+  const struct record * a = ptr_a;
+  const struct record * b = ptr_b;
+  return (a->key > b->key) - (a->key < b->key);
+}
+
+static uint32_t next_random(uint64_t * state) {
+  *state = *state * 6364136223846793005u + 1442695040888963407u;
+  return (uint32_t) (*state >> 32);
+}
+
+static void fill(struct nb_buffer * buffer, size_t count) {
+  uint64_t state = 42;
+  nb_init(buffer, sizeof(struct record));
+  struct record * records = nb_push_uninit(buffer, count);
+  for (size_t i = 0; i < count; i++) records[i] = (struct record) {.key = next_random(&state), .payload = (uint32_t) i};
+}
+
+int main(int argc, char ** argv) {
+  const size_t count = 20000000;
+  const size_t max_threads = argc > 1 ? (size_t) strtoul(argv[1], NULL, 10) : 64;
+  struct nb_buffer buffer;
+
+  fill(&buffer, count);
+  double start = bench_now();
+  nb_sort(&buffer, record_compare);
+  const double sort_time = bench_now() - start;
+  nb_release(&buffer);
+
+  printf("%12s %16s %10s\n", "threads", "time (ms)", "speedup");
+  printf("%12s %16.2f %9.1fx\n", "nb_sort", sort_time * 1e3, 1.0);
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    fill(&buffer, count);
+    start = bench_now();
+    nb_sort_parallel(&buffer, record_compare, threads);
+    const double parallel_time = bench_now() - start;
+    nb_release(&buffer);
+
+    printf("%12zu %16.2f %9.1fx\n", threads, parallel_time * 1e3, sort_time / parallel_time);
+  }
+
+  return 0;
+}
@@ -0,0 +1,171 @@
+#include "naughty-buffers/queue.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Passes 5 million 64-byte messages from a producer thread to a consumer thread, through a buffer guarded by a mutex
+ * (nb_push and nb_pop_front) and through a nb_spsc_queue, one message and 32 messages at a time. Both queues hold up
+ * to 1024 messages. Pass the message count as the first argument to change it.
+ */
+
+#if defined(_WIN32)
+typedef HANDLE bench_thread;
+typedef SRWLOCK bench_mutex;
+
+static DWORD WINAPI bench_thread_entry(LPVOID argument);
+
+static void bench_thread_start(bench_thread * thread, void * argument) {
+  *thread = CreateThread(NULL, 0, bench_thread_entry, argument, 0, NULL);
+}
+
+static void bench_thread_join(bench_thread thread) {
+  WaitForSingleObject(thread, INFINITE);
+  CloseHandle(thread);
+}
+
+static void bench_yield(void) { SwitchToThread(); }
+static void bench_mutex_init(bench_mutex * mutex) { InitializeSRWLock(mutex); }
+static void bench_mutex_lock(bench_mutex * mutex) { AcquireSRWLockExclusive(mutex); }
+static void bench_mutex_unlock(bench_mutex * mutex) { ReleaseSRWLockExclusive(mutex); }
+static void bench_mutex_destroy(bench_mutex * mutex) { (void) mutex; }
+#else
+#include <pthread.h>
+#include <sched.h>
+
+typedef pthread_t bench_thread;
+typedef pthread_mutex_t bench_mutex;
+
+static void * bench_thread_entry(void * argument);
+
+static void bench_thread_start(bench_thread * thread, void * argument) {
+  pthread_create(thread, NULL, bench_thread_entry, argument);
+}
+
+static void bench_thread_join(bench_thread thread) { pthread_join(thread, NULL); }
+static void bench_yield(void) { sched_yield(); }
+static void bench_mutex_init(bench_mutex * mutex) { pthread_mutex_init(mutex, NULL); }
+static void bench_mutex_lock(bench_mutex * mutex) { pthread_mutex_lock(mutex); }
+static void bench_mutex_unlock(bench_mutex * mutex) { pthread_mutex_unlock(mutex); }
+static void bench_mutex_destroy(bench_mutex * mutex) { pthread_mutex_destroy(mutex); }
+#endif
+
+#define CAPACITY 1024
+#define BATCH 32
+
+struct message {
+  uint64_t sequence;
+  uint8_t payload[56];
+};
+
+enum mode { MODE_MUTEX, MODE_QUEUE, MODE_QUEUE_BATCH };
+
+struct run {
+  enum mode mode;
+  size_t count;
+  bench_mutex mutex;
+  struct nb_buffer buffer;
+  struct nb_spsc_queue * queue;
+};
+
+static void produce(struct run * run) {
+  struct message batch[BATCH] = {{0}};
+  size_t sequence = 0;
+
+  while (sequence < run->count) {
+    if (run->mode == MODE_MUTEX) {
+      batch[0].sequence = sequence;
+      bench_mutex_lock(&run->mutex);
+      const int full = nb_block_count(&run->buffer) >= CAPACITY;
+      if (!full) nb_push(&run->buffer, &batch[0]);
+      bench_mutex_unlock(&run->mutex);
+      if (full) bench_yield();
+      else sequence++;
+    } else if (run->mode == MODE_QUEUE) {
+      batch[0].sequence = sequence;
+      if (nb_spsc_enqueue(run->queue, &batch[0]) == NB_ENQUEUE_OK) sequence++;
+      else bench_yield();
+    } else {
+      const size_t count = run->count - sequence < BATCH ? run->count - sequence : BATCH;
+      for (size_t i = 0; i < count; i++) batch[i].sequence = sequence + i;
+      size_t sent = 0;
+      while (sent < count) {
+        const size_t enqueued = nb_spsc_enqueue_many(run->queue, &batch[sent], count - sent);
+        if (enqueued == 0) bench_yield();
+        sent += enqueued;
+      }
+      sequence += count;
+    }
+  }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI bench_thread_entry(LPVOID argument) {
+  produce(argument);
+  return 0;
+}
+#else
+static void * bench_thread_entry(void * argument) {
+  produce(argument);
+  return NULL;
+}
+#endif
+
+// returns the time it took for the consumer to receive all messages, checking their order
+static double run_mode(enum mode mode, size_t count) {
+  struct run run = {.mode = mode, .count = count};
+  struct message batch[BATCH];
+  bench_mutex_init(&run.mutex);
+  nb_init(&run.buffer, sizeof(struct message));
+  nb_reserve(&run.buffer, CAPACITY);
+  run.queue = nb_spsc_queue_create(sizeof(struct message), CAPACITY);
+
+  const double start = bench_now();
+  bench_thread producer;
+  bench_thread_start(&producer, &run);
+
+  size_t received = 0;
+  while (received < count) {
+    size_t dequeued;
+    if (mode == MODE_MUTEX) {
+      bench_mutex_lock(&run.mutex);
+      dequeued = nb_pop_front(&run.buffer, &batch[0]) == NB_POP_OK;
+      bench_mutex_unlock(&run.mutex);
+    } else if (mode == MODE_QUEUE) {
+      dequeued = nb_spsc_dequeue(run.queue, &batch[0]) == NB_DEQUEUE_OK;
+    } else {
+      dequeued = nb_spsc_dequeue_many(run.queue, batch, BATCH);
+    }
+
+    if (dequeued == 0) bench_yield();
+    for (size_t i = 0; i < dequeued; i++) {
+      if (batch[i].sequence != received + i) {
+        fprintf(stderr, "message %zu arrived out of order\n", received + i);
+        exit(1);
+      }
+    }
+    received += dequeued;
+  }
+
+  bench_thread_join(producer);
+  const double elapsed = bench_now() - start;
+
+  nb_spsc_queue_destroy(run.queue);
+  nb_release(&run.buffer);
+  bench_mutex_destroy(&run.mutex);
+  return elapsed;
+}
+
+int main(int argc, char ** argv) {
+  const size_t count = argc > 1 ? (size_t) strtoul(argv[1], NULL, 10) : 5000000;
+  const char * names[] = {"mutex + nb_buffer", "nb_spsc_queue", "nb_spsc_queue (batch)"};
+
+  const double mutex_time = run_mode(MODE_MUTEX, count);
+  printf("%24s %16s %16s %10s\n", "", "time (ms)", "messages/s", "speedup");
+  for (int mode = MODE_MUTEX; mode <= MODE_QUEUE_BATCH; mode++) {
+    const double elapsed = mode == MODE_MUTEX ? mutex_time : run_mode((enum mode) mode, count);
+    printf("%24s %16.2f %16.0f %9.1fx\n", names[mode], elapsed * 1e3, (double) count / elapsed, mutex_time / elapsed);
+  }
+
+  return 0;
+}
@@ -0,0 +1,65 @@
+#include "naughty-buffers/sort.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Sorts 1 million 8-byte blocks with nb_sort and with nb_stable_sort, reusing a scratch buffer, for random input and
+ * for sorted input with 1% of random blocks appended.
+ */
+
+struct record {
+  uint32_t key;
+  uint32_t payload;
+};
+
+static int record_compare(const void * ptr_a, const void * ptr_b) {
+  const struct record * a = ptr_a;
+  const struct record * b = ptr_b;
+  return (a->key > b->key) - (a->key < b->key);
+}
+
+static uint32_t next_random(uint64_t * state) {
+  *state = *state * 6364136223846793005u + 1442695040888963407u;
+  return (uint32_t) (*state >> 32);
+}
+
+static void fill(struct nb_buffer * buffer, size_t count, size_t sorted_count) {
+  uint64_t state = 42;
+  nb_init(buffer, sizeof(struct record));
+  struct record * records = nb_push_uninit(buffer, count);
+  for (size_t i = 0; i < count; i++) {
+    const uint32_t key = i < sorted_count ? (uint32_t) (i * 4096) : next_random(&state);
+    records[i] = (struct record) {.key = key, .payload = (uint32_t) i};
+  }
+}
+
+int main(void) {
+  const size_t count = 1000000;
+  const char * names[] = {"random", "99% sorted"};
+  const size_t sorted_counts[] = {0, count - count / 100};
+  struct nb_buffer scratch;
+  nb_init(&scratch, sizeof(struct record));
+
+  printf("%12s %16s %16s %10s\n", "input", "nb_sort (ms)", "stable (ms)", "speedup");
+  for (size_t i = 0; i < 2; i++) {
+    struct nb_buffer buffer;
+
+    fill(&buffer, count, sorted_counts[i]);
+    double start = bench_now();
+    nb_sort(&buffer, record_compare);
+    const double sort_time = bench_now() - start;
+    nb_release(&buffer);
+
+    fill(&buffer, count, sorted_counts[i]);
+    start = bench_now();
+    nb_stable_sort(&buffer, record_compare, &scratch);
+    const double stable_time = bench_now() - start;
+    nb_release(&buffer);
+
+    printf("%12s %16.2f %16.2f %9.1fx\n", names[i], sort_time * 1e3, stable_time * 1e3, sort_time / stable_time);
+  }
+
+  nb_release(&scratch);
+  return 0;
+}
@@ -0,0 +1,162 @@
+#include "naughty-buffers/arena.h"
+#include "memory.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define NB_ARENA_ALIGNMENT 16
+
+static size_t align_size(size_t size) { return (size + NB_ARENA_ALIGNMENT - 1) & ~((size_t) NB_ARENA_ALIGNMENT - 1); }
+
+struct nb_arena_chunk {
+  struct nb_arena_chunk * next;
+  size_t capacity;
+  size_t used;
+};
+
+struct nb_arena_allocation {
+  size_t size;
+};
+
+#define NB_ARENA_CHUNK_HEADER_SIZE align_size(sizeof(struct nb_arena_chunk))
+#define NB_ARENA_ALLOCATION_HEADER_SIZE align_size(sizeof(struct nb_arena_allocation))
+
+struct nb_arena {
+  struct nb_buffer_memory_context memory_context;
+  struct nb_arena_chunk * first;
+  struct nb_arena_chunk * current;
+  uint8_t * last_allocation;
+  size_t chunk_size;
+  size_t used;
+};
+
+static uint8_t * chunk_data(struct nb_arena_chunk * chunk) { return (uint8_t *) chunk + NB_ARENA_CHUNK_HEADER_SIZE; }
+
+static struct nb_arena_allocation * allocation_header(void * ptr) {
+  return (struct nb_arena_allocation *) ((uint8_t *) ptr - NB_ARENA_ALLOCATION_HEADER_SIZE);
+}
+
+static struct nb_arena_chunk * chunk_create(size_t capacity) {
+  struct nb_arena_chunk * chunk = malloc(NB_ARENA_CHUNK_HEADER_SIZE + capacity);
+  if (chunk == NULL) return NULL;
+  chunk->next = NULL;
+  chunk->capacity = capacity;
+  chunk->used = 0;
+  return chunk;
+}
+
+static void * arena_alloc(size_t size, void * context) {
+  struct nb_arena * arena = context;
+  const size_t required = NB_ARENA_ALLOCATION_HEADER_SIZE + align_size(size);
+
+  struct nb_arena_chunk * chunk = arena->current;
+  while (chunk->capacity - chunk->used < required && chunk->next != NULL) {
+    // chunks past the current one are only there after a reset and still hold stale data
+    chunk = chunk->next;
+    chunk->used = 0;
+  }
+
+  if (chunk->capacity - chunk->used < required) {
+    struct nb_arena_chunk * new_chunk = chunk_create(required > arena->chunk_size ? required : arena->chunk_size);
+    if (new_chunk == NULL) return NULL;
+    new_chunk->next = chunk->next;
+    chunk->next = new_chunk;
+    chunk = new_chunk;
+  }
+
+  struct nb_arena_allocation * header = (struct nb_arena_allocation *) (chunk_data(chunk) + chunk->used);
+  header->size = align_size(size);
+  chunk->used += required;
+  arena->used += required;
+  arena->current = chunk;
+  arena->last_allocation = (uint8_t *) header + NB_ARENA_ALLOCATION_HEADER_SIZE;
+  return arena->last_allocation;
+}
+
+static void arena_release(void * ptr, void * context) {
+  struct nb_arena * arena = context;
+  if (ptr == NULL || ptr != arena->last_allocation) return;
+
+  const size_t allocated = NB_ARENA_ALLOCATION_HEADER_SIZE + allocation_header(ptr)->size;
+  arena->current->used -= allocated;
+  arena->used -= allocated;
+  arena->last_allocation = NULL;
+}
+
+static void * arena_realloc(void * ptr, size_t size, void * context) {
+  struct nb_arena * arena = context;
+  if (ptr == NULL) return arena_alloc(size, context);
+
+  struct nb_arena_allocation * header = allocation_header(ptr);
+  const size_t new_size = align_size(size);
+
+  if (ptr == arena->last_allocation) {
+    struct nb_arena_chunk * chunk = arena->current;
+    const size_t used_without = chunk->used - header->size;
+    if (chunk->capacity - used_without >= new_size) {
+      chunk->used = used_without + new_size;
+      arena->used = arena->used - header->size + new_size;
+      header->size = new_size;
+      return ptr;
+    }
+  } else if (new_size <= header->size) {
+    return ptr;
+  }
+
+  void * new_ptr = arena_alloc(size, context);
+  if (new_ptr == NULL) return NULL;
+  memcpy(new_ptr, ptr, header->size < size ? header->size : size);
+  return new_ptr;
+}
+
+static size_t arena_usable_size(void * ptr, void * context) {
+  (void) context;
+  return allocation_header(ptr)->size;
+}
+
+struct nb_arena * nb_arena_create(size_t chunk_size) {
+  struct nb_arena * arena = malloc(sizeof(struct nb_arena));
+  if (arena == NULL) return NULL;
+
+  arena->chunk_size = align_size(chunk_size > 0 ? chunk_size : 1);
+  arena->first = chunk_create(arena->chunk_size);
+  if (arena->first == NULL) {
+    free(arena);
+    return NULL;
+  }
+  arena->current = arena->first;
+  arena->last_allocation = NULL;
+  arena->used = 0;
+
+  arena->memory_context = (struct nb_buffer_memory_context) {
+    .alloc_fn = arena_alloc,
+    .realloc_fn = arena_realloc,
+    .free_fn = arena_release,
+    .copy_fn = nb_memory_copy,
+    .move_fn = nb_memory_move,
+    .context = arena,
+    .usable_size_fn = arena_usable_size
+  };
+  return arena;
+}
+
+struct nb_buffer_memory_context * nb_arena_memory_context(struct nb_arena * arena) { return &arena->memory_context; }
+
+void nb_arena_reset(struct nb_arena * arena) {
+  arena->current = arena->first;
+  arena->current->used = 0;
+  arena->last_allocation = NULL;
+  arena->used = 0;
+}
+
+size_t nb_arena_used(const struct nb_arena * arena) { return arena->used; }
+
+void nb_arena_destroy(struct nb_arena * arena) {
+  struct nb_arena_chunk * chunk = arena->first;
+  while (chunk != NULL) {
+    struct nb_arena_chunk * next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+  free(arena);
+}
@@ -0,0 +1,200 @@
+#ifndef NAUGHTY_BUFFERS_ATOMIC_H
+#define NAUGHTY_BUFFERS_ATOMIC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Atomic operations on size_t counters, 32-bit flags and pointers. Operations without an explicit ordering in their
+ * name are sequentially consistent. The library is built as C99, so C11 <stdatomic.h> is only used when the
+ * compiler is in C11 mode. Otherwise the GCC/Clang __atomic builtins are used, or the Interlocked functions on MSVC,
+ * which are full barriers and so stronger than needed.
+ */
+
+/* Distance that keeps two fields from sharing a cache line, whatever the alignment of the struct holding them */
+#define NB_CACHE_LINE_SIZE 64
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+
+typedef _Atomic size_t nb_atomic_size;
+
+static inline size_t nb_atomic_load_relaxed(nb_atomic_size * value) {
+  return atomic_load_explicit(value, memory_order_relaxed);
+}
+
+static inline size_t nb_atomic_load_acquire(nb_atomic_size * value) {
+  return atomic_load_explicit(value, memory_order_acquire);
+}
+
+static inline void nb_atomic_store_relaxed(nb_atomic_size * value, size_t desired) {
+  atomic_store_explicit(value, desired, memory_order_relaxed);
+}
+
+static inline void nb_atomic_store_release(nb_atomic_size * value, size_t desired) {
+  atomic_store_explicit(value, desired, memory_order_release);
+}
+
+static inline size_t nb_atomic_load(nb_atomic_size * value) { return atomic_load(value); }
+
+static inline size_t nb_atomic_fetch_add(nb_atomic_size * value, size_t addend) {
+  return atomic_fetch_add(value, addend);
+}
+
+static inline int nb_atomic_compare_exchange(nb_atomic_size * value, size_t * expected, size_t desired) {
+  return atomic_compare_exchange_weak(value, expected, desired);
+}
+
+typedef _Atomic uint32_t nb_atomic_u32;
+
+static inline uint32_t nb_atomic_u32_load(nb_atomic_u32 * value) { return atomic_load(value); }
+
+static inline void nb_atomic_u32_store(nb_atomic_u32 * value, uint32_t desired) { atomic_store(value, desired); }
+
+static inline int nb_atomic_u32_compare_exchange(nb_atomic_u32 * value, uint32_t * expected, uint32_t desired) {
+  return atomic_compare_exchange_weak(value, expected, desired);
+}
+
+typedef void * _Atomic nb_atomic_pointer;
+
+static inline void * nb_atomic_pointer_load_acquire(nb_atomic_pointer * value) {
+  return atomic_load_explicit(value, memory_order_acquire);
+}
+
+static inline void * nb_atomic_pointer_load(nb_atomic_pointer * value) { return atomic_load(value); }
+
+static inline int nb_atomic_pointer_compare_exchange(nb_atomic_pointer * value, void ** expected, void * desired) {
+  return atomic_compare_exchange_strong(value, expected, desired);
+}
+
+#elif defined(__GNUC__) || defined(__clang__)
+
+typedef size_t nb_atomic_size;
+
+static inline size_t nb_atomic_load_relaxed(nb_atomic_size * value) { return __atomic_load_n(value, __ATOMIC_RELAXED); }
+
+static inline size_t nb_atomic_load_acquire(nb_atomic_size * value) { return __atomic_load_n(value, __ATOMIC_ACQUIRE); }
+
+static inline void nb_atomic_store_relaxed(nb_atomic_size * value, size_t desired) {
+  __atomic_store_n(value, desired, __ATOMIC_RELAXED);
+}
+
+static inline void nb_atomic_store_release(nb_atomic_size * value, size_t desired) {
+  __atomic_store_n(value, desired, __ATOMIC_RELEASE);
+}
+
+static inline size_t nb_atomic_load(nb_atomic_size * value) { return __atomic_load_n(value, __ATOMIC_SEQ_CST); }
+
+static inline size_t nb_atomic_fetch_add(nb_atomic_size * value, size_t addend) {
+  return __atomic_fetch_add(value, addend, __ATOMIC_SEQ_CST);
+}
+
+static inline int nb_atomic_compare_exchange(nb_atomic_size * value, size_t * expected, size_t desired) {
+  return __atomic_compare_exchange_n(value, expected, desired, 1, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+typedef uint32_t nb_atomic_u32;
+
+static inline uint32_t nb_atomic_u32_load(nb_atomic_u32 * value) { return __atomic_load_n(value, __ATOMIC_SEQ_CST); }
+
+static inline void nb_atomic_u32_store(nb_atomic_u32 * value, uint32_t desired) {
+  __atomic_store_n(value, desired, __ATOMIC_SEQ_CST);
+}
+
+static inline int nb_atomic_u32_compare_exchange(nb_atomic_u32 * value, uint32_t * expected, uint32_t desired) {
+  return __atomic_compare_exchange_n(value, expected, desired, 1, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+typedef void * nb_atomic_pointer;
+
+static inline void * nb_atomic_pointer_load_acquire(nb_atomic_pointer * value) {
+  return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static inline void * nb_atomic_pointer_load(nb_atomic_pointer * value) {
+  return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+}
+
+static inline int nb_atomic_pointer_compare_exchange(nb_atomic_pointer * value, void ** expected, void * desired) {
+  return __atomic_compare_exchange_n(value, expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+#elif defined(_MSC_VER)
+#include <windows.h>
+
+#if defined(_WIN64)
+typedef volatile LONG64 nb_atomic_size;
+#define NB_INTERLOCKED(name) name##64
+#define NB_INTERLOCKED_TYPE LONG64
+#else
+typedef volatile LONG nb_atomic_size;
+#define NB_INTERLOCKED(name) name
+#define NB_INTERLOCKED_TYPE LONG
+#endif
+
+static inline size_t nb_atomic_load_acquire(nb_atomic_size * value) {
+  return (size_t) NB_INTERLOCKED(InterlockedCompareExchange)(value, 0, 0);
+}
+
+static inline size_t nb_atomic_load_relaxed(nb_atomic_size * value) { return nb_atomic_load_acquire(value); }
+
+static inline void nb_atomic_store_release(nb_atomic_size * value, size_t desired) {
+  NB_INTERLOCKED(InterlockedExchange)(value, (NB_INTERLOCKED_TYPE) desired);
+}
+
+static inline void nb_atomic_store_relaxed(nb_atomic_size * value, size_t desired) {
+  nb_atomic_store_release(value, desired);
+}
+
+static inline size_t nb_atomic_load(nb_atomic_size * value) { return nb_atomic_load_acquire(value); }
+
+static inline size_t nb_atomic_fetch_add(nb_atomic_size * value, size_t addend) {
+  return (size_t) NB_INTERLOCKED(InterlockedExchangeAdd)(value, (NB_INTERLOCKED_TYPE) addend);
+}
+
+static inline int nb_atomic_compare_exchange(nb_atomic_size * value, size_t * expected, size_t desired) {
+  const size_t previous = (size_t) NB_INTERLOCKED(InterlockedCompareExchange)(
+      value, (NB_INTERLOCKED_TYPE) desired, (NB_INTERLOCKED_TYPE) *expected
+  );
+  if (previous == *expected) return 1;
+  *expected = previous;
+  return 0;
+}
+
+typedef volatile LONG nb_atomic_u32;
+
+static inline uint32_t nb_atomic_u32_load(nb_atomic_u32 * value) {
+  return (uint32_t) InterlockedCompareExchange(value, 0, 0);
+}
+
+static inline void nb_atomic_u32_store(nb_atomic_u32 * value, uint32_t desired) {
+  InterlockedExchange(value, (LONG) desired);
+}
+
+static inline int nb_atomic_u32_compare_exchange(nb_atomic_u32 * value, uint32_t * expected, uint32_t desired) {
+  const uint32_t previous = (uint32_t) InterlockedCompareExchange(value, (LONG) desired, (LONG) *expected);
+  if (previous == *expected) return 1;
+  *expected = previous;
+  return 0;
+}
+
+typedef void * volatile nb_atomic_pointer;
+
+static inline void * nb_atomic_pointer_load_acquire(nb_atomic_pointer * value) {
+  return InterlockedCompareExchangePointer(value, NULL, NULL);
+}
+
+static inline void * nb_atomic_pointer_load(nb_atomic_pointer * value) { return nb_atomic_pointer_load_acquire(value); }
+
+static inline int nb_atomic_pointer_compare_exchange(nb_atomic_pointer * value, void ** expected, void * desired) {
+  void * previous = InterlockedCompareExchangePointer(value, desired, *expected);
+  if (previous == *expected) return 1;
+  *expected = previous;
+  return 0;
+}
+
+#else
+#error "naughty-buffers needs C11 atomics, GCC/Clang atomic builtins or MSVC to build"
+#endif
+
+#endif // NAUGHTY_BUFFERS_ATOMIC_H
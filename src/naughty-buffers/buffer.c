@@ -10,11 +10,11 @@ static void * ctx_realloc(struct nb_buffer * buffer, void * ptr, size_t size) {
   return buffer->memory_context->realloc_fn(ptr, size, buffer->memory_context->context);
 }
 
-static void * ctx_copy(struct nb_buffer * buffer, void * destination, void * source, size_t size) {
+static void * ctx_copy(struct nb_buffer * buffer, void * destination, const void * source, size_t size) {
   return buffer->memory_context->copy_fn(destination, source, size, buffer->memory_context->context);
 }
 
-static void * ctx_move(struct nb_buffer * buffer, void * destination, void * source, size_t size) {
+static void * ctx_move(struct nb_buffer * buffer, void * destination, const void * source, size_t size) {
   return buffer->memory_context->move_fn(destination, source, size, buffer->memory_context->context);
 }
 
@@ -22,13 +22,25 @@ static void ctx_release(struct nb_buffer * buffer, void * ptr) {
   buffer->memory_context->free_fn(ptr, buffer->memory_context->context);
 }
 
-struct nb_buffer_memory_context default_memory_context = {
+static size_t ctx_usable_size(struct nb_buffer * buffer, void * ptr) {
+  if (buffer->memory_context->usable_size_fn == NULL) return 0;
+  return buffer->memory_context->usable_size_fn(ptr, buffer->memory_context->context);
+}
+
+// how many blocks fit in the memory handed out for `ptr`, or 0 if the memory context cannot tell
+static size_t ctx_usable_blocks(struct nb_buffer * buffer, void * ptr) {
+  if (buffer->block_size == 0) return 0;
+  return ctx_usable_size(buffer, ptr) / buffer->block_size;
+}
+
+NAUGHTY_BUFFERS_NO_EXPORT struct nb_buffer_memory_context default_memory_context = {
     .context = NULL,
     .free_fn = nb_memory_release,
     .copy_fn = nb_memory_copy,
     .realloc_fn = nb_memory_realloc,
     .alloc_fn = nb_memory_alloc,
-    .move_fn = nb_memory_move
+    .move_fn = nb_memory_move,
+    .usable_size_fn = nb_memory_usable_size
 };
 
 static size_t size_t_max(const size_t a, const size_t b) {
@@ -45,19 +57,225 @@ void nb_init_advanced(struct nb_buffer * buffer, const size_t block_size, struct
   buffer->block_capacity = 2;
   buffer->block_count = 0;
   buffer->memory_context = memory_context;
+  buffer->block_offset = 0;
+  buffer->sorted_count = 0;
+  buffer->uses_inline_storage = 0;
   buffer->data = ctx_alloc(buffer, buffer->block_size * 2);
+  if (buffer->data != NULL) buffer->block_capacity = size_t_max(2, ctx_usable_blocks(buffer, buffer->data));
+}
+
+void nb_init_lazy(struct nb_buffer * buffer, size_t block_size) {
+  nb_init_inline_advanced(buffer, block_size, NULL, 0, &default_memory_context);
+}
+
+void nb_init_lazy_advanced(
+    struct nb_buffer * buffer,
+    size_t block_size,
+    struct nb_buffer_memory_context * memory_context
+) {
+  nb_init_inline_advanced(buffer, block_size, NULL, 0, memory_context);
+}
+
+void nb_init_inline(struct nb_buffer * buffer, size_t block_size, void * storage, size_t storage_capacity) {
+  nb_init_inline_advanced(buffer, block_size, storage, storage_capacity, &default_memory_context);
+}
+
+void nb_init_inline_advanced(
+    struct nb_buffer * buffer,
+    size_t block_size,
+    void * storage,
+    size_t storage_capacity,
+    struct nb_buffer_memory_context * memory_context
+) {
+  buffer->block_size = block_size;
+  buffer->block_capacity = storage_capacity;
+  buffer->block_count = 0;
+  buffer->memory_context = memory_context;
+  buffer->block_offset = 0;
+  buffer->sorted_count = 0;
+  buffer->uses_inline_storage = storage != NULL;
+  buffer->data = storage;
+}
+
+static uint8_t * storage_base(const struct nb_buffer * buffer) {
+  if (buffer->block_offset == 0) return buffer->data;
+  return (uint8_t *) buffer->data - (buffer->block_offset * buffer->block_size);
+}
+
+uint8_t nb_is_inline(const struct nb_buffer * buffer) { return buffer->uses_inline_storage; }
+
+void nb_memory_context_init(struct nb_buffer_memory_context * memory_context) {
+  *memory_context = default_memory_context;
+}
+
+size_t nb_parametric_growth(size_t block_capacity, size_t required_capacity, void * context) {
+  const struct nb_growth_parameters * parameters = context;
+  size_t new_block_capacity = block_capacity > 0 ? block_capacity : 1;
+
+  while (new_block_capacity < required_capacity) {
+    const uint8_t linear = parameters->factor <= 1.0 ||
+                           (parameters->linear_threshold > 0 && new_block_capacity >= parameters->linear_threshold);
+    if (linear) {
+      size_t increment = parameters->increment;
+      if (increment == 0) increment = parameters->linear_threshold > 0 ? parameters->linear_threshold : 1;
+      const size_t steps = (required_capacity - new_block_capacity + increment - 1) / increment;
+      return new_block_capacity + steps * increment;
+    }
+
+    size_t next_block_capacity = (size_t) ((double) new_block_capacity * parameters->factor);
+    if (next_block_capacity <= new_block_capacity) next_block_capacity = new_block_capacity + 1;
+    if (parameters->linear_threshold > 0 && next_block_capacity > parameters->linear_threshold &&
+        new_block_capacity < parameters->linear_threshold)
+      next_block_capacity = parameters->linear_threshold;
+    new_block_capacity = next_block_capacity;
+  }
+
+  return new_block_capacity;
+}
+
+static size_t next_block_capacity(const struct nb_buffer * buffer, size_t required_capacity) {
+  const struct nb_buffer_growth_policy * growth_policy = buffer->memory_context->growth_policy;
+  size_t new_block_capacity;
+  if (growth_policy != NULL) {
+    new_block_capacity = growth_policy->growth_fn(buffer->block_capacity, required_capacity, growth_policy->context);
+  } else {
+    new_block_capacity = buffer->block_capacity > 0 ? buffer->block_capacity * 2 : 2;
+    while (new_block_capacity < required_capacity) new_block_capacity *= 2;
+  }
+  return size_t_max(new_block_capacity, required_capacity);
+}
+
+// blocks of buffers whose memory context keeps addresses are never slid inside their storage either
+static uint8_t keeps_addresses(const struct nb_buffer * buffer) {
+  return buffer->memory_context != NULL && buffer->memory_context->keeps_addresses;
 }
 
-uint8_t nb_grow(struct nb_buffer * buffer, size_t desired_capacity) {
-  size_t new_block_capacity = buffer->block_capacity * 2;
-  while (new_block_capacity <= desired_capacity) new_block_capacity *= 2;
-  void * new_data = ctx_realloc(buffer, buffer->data, buffer->block_size * new_block_capacity);
-  if (new_data == NULL) return 0;
+// moves the blocks inside the current storage so that `new_block_offset` free blocks are left before them
+static void slide_storage(struct nb_buffer * buffer, size_t new_block_offset) {
+  uint8_t * new_data = storage_base(buffer) + (new_block_offset * buffer->block_size);
+  if (buffer->block_count > 0 && new_data != buffer->data) {
+    ctx_move(buffer, new_data, buffer->data, buffer->block_size * buffer->block_count);
+  }
+  buffer->block_capacity = buffer->block_offset + buffer->block_capacity - new_block_offset;
+  buffer->block_offset = new_block_offset;
   buffer->data = new_data;
-  buffer->block_capacity = new_block_capacity;
+}
+
+// resizes the storage to `new_total_capacity` blocks, leaving `new_block_offset` free blocks before the first one
+static uint8_t resize_storage(struct nb_buffer * buffer, size_t new_total_capacity, size_t new_block_offset) {
+  const size_t block_size = buffer->block_size;
+  uint8_t * new_base;
+  if (buffer->data == NULL || nb_is_inline(buffer)) {
+    new_base = ctx_alloc(buffer, block_size * new_total_capacity);
+    if (new_base == NULL) return 0;
+    if (buffer->block_count > 0) {
+      ctx_copy(buffer, new_base + (new_block_offset * block_size), buffer->data, block_size * buffer->block_count);
+    }
+    buffer->block_offset = new_block_offset;
+    buffer->uses_inline_storage = 0;
+  } else {
+    // when shrinking, blocks must be in place before the end of the storage goes away
+    if (new_total_capacity < buffer->block_offset + buffer->block_capacity) slide_storage(buffer, new_block_offset);
+    new_base = ctx_realloc(buffer, storage_base(buffer), block_size * new_total_capacity);
+    if (new_base == NULL) return 0;
+    buffer->data = new_base + (buffer->block_offset * block_size);
+    buffer->block_capacity = new_total_capacity - buffer->block_offset;
+    slide_storage(buffer, new_block_offset);
+  }
+
+  new_total_capacity = size_t_max(new_total_capacity, ctx_usable_blocks(buffer, new_base));
+  buffer->data = new_base + (new_block_offset * block_size);
+  buffer->block_capacity = new_total_capacity - new_block_offset;
   return 1;
 }
 
+uint8_t nb_grow(struct nb_buffer * buffer, size_t required_capacity) {
+  if (required_capacity <= buffer->block_capacity) return 1;
+
+  // blocks removed from the front left at least as much room as there are blocks: sliding them back is cheaper
+  const size_t total_capacity = buffer->block_offset + buffer->block_capacity;
+  if (buffer->block_offset > 0 && buffer->block_offset >= buffer->block_count && required_capacity <= total_capacity &&
+      !keeps_addresses(buffer)) {
+    slide_storage(buffer, 0);
+    return 1;
+  }
+
+  // the room before the first block is kept, it is less than the amount of blocks and moving them would cost more
+  const size_t block_offset = buffer->block_offset;
+  const size_t new_block_capacity = next_block_capacity(buffer, required_capacity);
+  if (resize_storage(buffer, block_offset + new_block_capacity, block_offset)) return 1;
+  // the memory context may be able to give us what we need, just not what the growth policy asked for
+  if (new_block_capacity == required_capacity) return 0;
+  return resize_storage(buffer, block_offset + required_capacity, block_offset);
+}
+
+// makes room for `block_count` blocks before the first one
+static uint8_t grow_front(struct nb_buffer * buffer, size_t block_count) {
+  if (buffer->block_offset >= block_count) return 1;
+
+  // the free room is split between both ends so pushing to either of them stays amortized O(1)
+  const size_t required_capacity = buffer->block_count + block_count;
+  const size_t total_capacity = buffer->block_offset + buffer->block_capacity;
+  if (buffer->data != NULL && total_capacity >= required_capacity * 2) {
+    const size_t free_capacity = total_capacity - buffer->block_count;
+    slide_storage(buffer, free_capacity - free_capacity / 2);
+    return 1;
+  }
+
+  const size_t new_total_capacity = next_block_capacity(buffer, required_capacity * 2);
+  const size_t free_capacity = new_total_capacity - buffer->block_count;
+  if (resize_storage(buffer, new_total_capacity, free_capacity - free_capacity / 2)) return 1;
+  return resize_storage(buffer, required_capacity, block_count);
+}
+
+// forgets the first `block_count` blocks without moving the others
+static void drop_front(struct nb_buffer * buffer, size_t block_count) {
+  buffer->data = (uint8_t *) buffer->data + (block_count * buffer->block_size);
+  buffer->block_offset += block_count;
+  buffer->block_capacity -= block_count;
+  buffer->block_count -= block_count;
+  if (buffer->block_count == 0) slide_storage(buffer, 0);
+}
+
+// blocks from `index` on are no longer known to be sorted
+static void unsort_from(struct nb_buffer * buffer, size_t index) {
+  if (index < buffer->sorted_count) buffer->sorted_count = index;
+}
+
+// removing blocks keeps the others in order, so the sorted prefix only loses the removed blocks that were in it
+static void forget_sorted(struct nb_buffer * buffer, size_t first_index, size_t block_count) {
+  if (first_index >= buffer->sorted_count) return;
+  const size_t sorted_removed = buffer->sorted_count - first_index;
+  buffer->sorted_count -= block_count < sorted_removed ? block_count : sorted_removed;
+}
+
+enum NB_RESERVE_RESULT nb_reserve(struct nb_buffer * buffer, size_t block_capacity) {
+  if (block_capacity <= buffer->block_capacity) return NB_RESERVE_OK;
+  if (keeps_addresses(buffer)) {
+    const size_t block_offset = buffer->block_offset;
+    if (!resize_storage(buffer, block_offset + block_capacity, block_offset)) return NB_RESERVE_OUT_OF_MEMORY;
+    return NB_RESERVE_OK;
+  }
+  if (block_capacity <= buffer->block_offset + buffer->block_capacity) {
+    slide_storage(buffer, 0);
+    return NB_RESERVE_OK;
+  }
+  if (!resize_storage(buffer, block_capacity, 0)) return NB_RESERVE_OUT_OF_MEMORY;
+  return NB_RESERVE_OK;
+}
+
+size_t nb_block_capacity(const struct nb_buffer * buffer) { return buffer->block_capacity; }
+
+enum NB_SHRINK_RESULT nb_shrink_to_fit(struct nb_buffer * buffer) {
+  // the room before the first block can only be given back by sliding the blocks into it
+  const size_t block_offset = keeps_addresses(buffer) ? buffer->block_offset : 0;
+  const size_t new_total_capacity = block_offset + size_t_max(buffer->block_count, 1);
+  const size_t total_capacity = buffer->block_offset + buffer->block_capacity;
+  if (new_total_capacity >= total_capacity || nb_is_inline(buffer)) return NB_SHRINK_OK;
+  if (!resize_storage(buffer, new_total_capacity, block_offset)) return NB_SHRINK_OUT_OF_MEMORY;
+  return NB_SHRINK_OK;
+}
+
 enum NB_PUSH_RESULT nb_push(struct nb_buffer * buffer, void * data) {
   if (buffer->block_count >= buffer->block_capacity) {
     const uint8_t grow_success = nb_grow(buffer, buffer->block_count + 1);
@@ -71,8 +289,82 @@ enum NB_PUSH_RESULT nb_push(struct nb_buffer * buffer, void * data) {
   return NB_PUSH_OK;
 }
 
+enum NB_PUSH_RESULT nb_push_many(struct nb_buffer * buffer, void * data, size_t block_count) {
+  if (block_count == 0) return NB_PUSH_OK;
+  if (buffer->block_count + block_count > buffer->block_capacity) {
+    const uint8_t grow_success = nb_grow(buffer, buffer->block_count + block_count);
+    if (!grow_success) return NB_PUSH_OUT_OF_MEMORY;
+  }
+
+  uint8_t * buffer_data = buffer->data;
+  void * block_data = buffer_data + (buffer->block_count * buffer->block_size);
+  ctx_copy(buffer, block_data, data, buffer->block_size * block_count);
+  buffer->block_count += block_count;
+  return NB_PUSH_OK;
+}
+
+void * nb_push_uninit(struct nb_buffer * buffer, size_t block_count) {
+  if (buffer->block_count + block_count > buffer->block_capacity) {
+    const uint8_t grow_success = nb_grow(buffer, buffer->block_count + block_count);
+    if (!grow_success) return NULL;
+  }
+
+  uint8_t * buffer_data = buffer->data;
+  void * block_data = buffer_data + (buffer->block_count * buffer->block_size);
+  buffer->block_count += block_count;
+  return block_data;
+}
+
+void * nb_emplace_back(struct nb_buffer * buffer) { return nb_push_uninit(buffer, 1); }
+
+enum NB_PUSH_RESULT nb_push_front(struct nb_buffer * buffer, void * data) {
+  if (!grow_front(buffer, 1)) return NB_PUSH_OUT_OF_MEMORY;
+
+  buffer->data = (uint8_t *) buffer->data - buffer->block_size;
+  buffer->block_offset -= 1;
+  buffer->block_capacity += 1;
+  buffer->block_count += 1;
+  buffer->sorted_count = 0;
+  ctx_copy(buffer, buffer->data, data, buffer->block_size);
+  return NB_PUSH_OK;
+}
+
+enum NB_POP_RESULT nb_pop_front(struct nb_buffer * buffer, void * destination) {
+  if (buffer->block_count == 0) return NB_POP_EMPTY;
+  if (destination != NULL) ctx_copy(buffer, destination, buffer->data, buffer->block_size);
+  forget_sorted(buffer, 0, 1);
+  drop_front(buffer, 1);
+  return NB_POP_OK;
+}
+
+enum NB_POP_RESULT nb_pop_back(struct nb_buffer * buffer, void * destination) {
+  if (nb_pop_many(buffer, destination, 1) == 0) return NB_POP_EMPTY;
+  return NB_POP_OK;
+}
+
+size_t nb_pop_many(struct nb_buffer * buffer, void * destination, size_t block_count) {
+  if (block_count > buffer->block_count) block_count = buffer->block_count;
+  if (block_count == 0) return 0;
+
+  const size_t first_index = buffer->block_count - block_count;
+  if (destination != NULL) {
+    uint8_t * buffer_data = buffer->data;
+    void * block_data = buffer_data + (first_index * buffer->block_size);
+    ctx_copy(buffer, destination, block_data, buffer->block_size * block_count);
+  }
+  buffer->block_count = first_index;
+  forget_sorted(buffer, first_index, block_count);
+  return block_count;
+}
+
 size_t nb_block_count(const struct nb_buffer * buffer) { return buffer->block_count; }
 
+size_t nb_sorted_count(const struct nb_buffer * buffer) { return buffer->sorted_count; }
+
+void nb_set_sorted_count(struct nb_buffer * buffer, size_t sorted_count) {
+  buffer->sorted_count = sorted_count < buffer->block_count ? sorted_count : buffer->block_count;
+}
+
 void * nb_at(const struct nb_buffer * buffer, const size_t index) {
   uint8_t * buffer_data = buffer->data;
   if (index >= buffer->block_count) return NULL;
@@ -85,12 +377,15 @@ void * nb_front(const struct nb_buffer * buffer) { return nb_at(buffer, 0); }
 void * nb_back(const struct nb_buffer * buffer) { return nb_at(buffer, buffer->block_count - 1); }
 
 void nb_release(struct nb_buffer * buffer) {
-  ctx_release(buffer, buffer->data);
+  if (buffer->data != NULL && !nb_is_inline(buffer)) ctx_release(buffer, storage_base(buffer));
 
   buffer->block_size = 0;
   buffer->block_capacity = 0;
   buffer->block_count = 0;
   buffer->memory_context = NULL;
+  buffer->block_offset = 0;
+  buffer->sorted_count = 0;
+  buffer->uses_inline_storage = 0;
   buffer->data = NULL;
 }
 
@@ -99,7 +394,7 @@ enum NB_ASSIGN_RESULT nb_assign(struct nb_buffer * buffer, const size_t index, v
 }
 
 enum NB_ASSIGN_RESULT nb_assign_many(struct nb_buffer * buffer, size_t index, void * data, size_t block_count) {
-  if (index + block_count >= buffer->block_capacity) {
+  if (index + block_count > buffer->block_capacity) {
     uint8_t grow_success = nb_grow(buffer, index + block_count);
     if (!grow_success) return NB_ASSIGN_OUT_OF_MEMORY;
   }
@@ -107,51 +402,175 @@ enum NB_ASSIGN_RESULT nb_assign_many(struct nb_buffer * buffer, size_t index, vo
   void * block_data = buffer_data + (index * buffer->block_size);
   ctx_copy(buffer, block_data, data, buffer->block_size * block_count);
   if (index + block_count >= buffer->block_count) buffer->block_count = index + block_count;
+  unsort_from(buffer, index);
   return NB_ASSIGN_OK;
 }
 
+// moves `block_count` blocks starting at `source_index` to `destination_index`, if they are not there already
+static void move_blocks(struct nb_buffer * buffer, size_t destination_index, size_t source_index, size_t block_count) {
+  if (block_count == 0 || destination_index == source_index) return;
+  uint8_t * buffer_data = buffer->data;
+  ctx_move(
+      buffer,
+      buffer_data + (destination_index * buffer->block_size),
+      buffer_data + (source_index * buffer->block_size),
+      block_count * buffer->block_size
+  );
+}
+
 enum NB_INSERT_RESULT nb_insert(struct nb_buffer * buffer, const size_t index, void * data) {
-  const size_t required_size = size_t_max(buffer->block_count + 1, index);
-  if (required_size >= buffer->block_capacity) {
-    const uint8_t grow_success = nb_grow(buffer, required_size);
-    if (!grow_success) return NB_INSERT_OUT_OF_MEMORY;
+  return nb_insert_many(buffer, index, data, 1);
+}
+
+enum NB_INSERT_RESULT nb_insert_many(struct nb_buffer * buffer, size_t index, void * data, size_t block_count) {
+  if (block_count == 0) return NB_INSERT_OK;
+  const size_t block_size = buffer->block_size;
+
+  if (index >= buffer->block_count) {
+    if (nb_assign_many(buffer, index, data, block_count) != NB_ASSIGN_OK) return NB_INSERT_OUT_OF_MEMORY;
+    return NB_INSERT_OK;
   }
+
+  unsort_from(buffer, index);
+
+  // inserting at the front makes room there like nb_push_front. Elsewhere, blocks before the index are moved back
+  // only if they are fewer than the ones after it and there is already room for them
+  const uint8_t front_has_room = buffer->block_offset >= block_count;
+  if (index == 0 || (front_has_room && index < buffer->block_count - index)) {
+    if (!grow_front(buffer, block_count)) return NB_INSERT_OUT_OF_MEMORY;
+    uint8_t * new_data = (uint8_t *) buffer->data - (block_count * block_size);
+    if (index > 0) ctx_move(buffer, new_data, buffer->data, index * block_size);
+    ctx_copy(buffer, new_data + (index * block_size), data, block_count * block_size);
+    buffer->data = new_data;
+    buffer->block_offset -= block_count;
+    buffer->block_capacity += block_count;
+    buffer->block_count += block_count;
+    return NB_INSERT_OK;
+  }
+
+  if (!nb_grow(buffer, buffer->block_count + block_count)) return NB_INSERT_OUT_OF_MEMORY;
+  move_blocks(buffer, index + block_count, index, buffer->block_count - index);
+  ctx_copy(buffer, (uint8_t *) buffer->data + (index * block_size), data, block_count * block_size);
+  buffer->block_count += block_count;
+  return NB_INSERT_OK;
+}
+
+enum NB_INSERT_RESULT
+nb_insert_batch(struct nb_buffer * buffer, const size_t * sorted_indices, void * data, size_t block_count) {
+  if (block_count == 0) return NB_INSERT_OK;
+  for (size_t i = 0; i < block_count; i++) {
+    if (sorted_indices[i] > buffer->block_count) return NB_INSERT_INVALID_INDICES;
+    if (i > 0 && sorted_indices[i] < sorted_indices[i - 1]) return NB_INSERT_INVALID_INDICES;
+  }
+  if (!nb_grow(buffer, buffer->block_count + block_count)) return NB_INSERT_OUT_OF_MEMORY;
+
+  // walking from the end, blocks between two consecutive indices move once, past every block inserted before them
+  const size_t block_size = buffer->block_size;
   uint8_t * buffer_data = buffer->data;
-  uint8_t * block_data = buffer_data + (index * buffer->block_size);
-  if (index < buffer->block_count) {
-    uint8_t * dest = buffer_data + ((index + 1) * buffer->block_size);
-    uint8_t * src = block_data;
-    size_t move_size = (buffer->block_count - index) * buffer->block_size;
-    ctx_move(buffer, dest, src, move_size);
+  const uint8_t * items = data;
+  size_t run_end = buffer->block_count;
+  for (size_t i = block_count; i > 0; i--) {
+    const size_t index = sorted_indices[i - 1];
+    move_blocks(buffer, index + i, index, run_end - index);
+    ctx_copy(buffer, buffer_data + ((index + i - 1) * block_size), items + ((i - 1) * block_size), block_size);
+    run_end = index;
   }
-  ctx_copy(buffer, block_data, data, buffer->block_size);
-  if (index >= buffer->block_count) buffer->block_count = index + 1;
-  else buffer->block_count += 1;
+
+  buffer->block_count += block_count;
+  unsort_from(buffer, sorted_indices[0]);
   return NB_INSERT_OK;
 }
 
-void nb_remove_front(struct nb_buffer * buffer) { nb_remove_at(buffer, 0); }
+void nb_remove_front(struct nb_buffer * buffer) { nb_pop_front(buffer, NULL); }
 
 void nb_remove_back(struct nb_buffer * buffer) { nb_remove_at(buffer, buffer->block_count - 1); }
 
-void nb_remove_at(struct nb_buffer * buffer, const size_t index) {
+void nb_remove_at(struct nb_buffer * buffer, const size_t index) { nb_remove_range(buffer, index, 1); }
+
+void nb_swap_remove(struct nb_buffer * buffer, size_t index) {
   if (index >= buffer->block_count) return;
-  if (index == buffer->block_count - 1) {
-    buffer->block_count--;
-    return;
+  const size_t last_index = buffer->block_count - 1;
+  if (index != last_index) {
+    uint8_t * buffer_data = buffer->data;
+    ctx_copy(
+        buffer,
+        buffer_data + (index * buffer->block_size),
+        buffer_data + (last_index * buffer->block_size),
+        buffer->block_size
+    );
+    unsort_from(buffer, index);
+  }
+  buffer->block_count = last_index;
+  forget_sorted(buffer, last_index, 1);
+}
+
+size_t nb_remove_range(struct nb_buffer * buffer, size_t first_index, size_t block_count) {
+  if (first_index >= buffer->block_count) return 0;
+  if (block_count > buffer->block_count - first_index) block_count = buffer->block_count - first_index;
+  if (block_count == 0) return 0;
+  forget_sorted(buffer, first_index, block_count);
+
+  const size_t tail_count = buffer->block_count - first_index - block_count;
+  if (first_index < tail_count) {
+    // blocks before the range are fewer than after it: move them forward and drop the first blocks instead
+    move_blocks(buffer, block_count, 0, first_index);
+    drop_front(buffer, block_count);
+  } else {
+    move_blocks(buffer, first_index, first_index + block_count, tail_count);
+    buffer->block_count -= block_count;
   }
+  return block_count;
+}
+
+size_t nb_remove_if(struct nb_buffer * buffer, nb_predicate_fn predicate_fn, void * context) {
   uint8_t * buffer_data = buffer->data;
-  uint8_t * block_data = buffer_data + (index * buffer->block_size);
-  uint8_t * dest = block_data;
-  uint8_t * src = buffer_data + ((index + 1) * buffer->block_size);
-  size_t move_count = buffer->block_count - index - 1;
-  size_t move_size = move_count * buffer->block_size;
-  ctx_move(buffer, dest, src, move_size);
-  buffer->block_count--;
+  const size_t block_size = buffer->block_size;
+  const size_t block_count = buffer->block_count;
+  const size_t sorted_count = buffer->sorted_count;
+  size_t kept_count = 0;
+  size_t kept_sorted_count = 0;
+  size_t run_index = 0;
+
+  // a removed block (or the end of the buffer) ends the run of kept blocks that started at run_index
+  for (size_t index = 0; index <= block_count; index++) {
+    if (index < block_count && !predicate_fn(buffer_data + (index * block_size), context)) continue;
+    move_blocks(buffer, kept_count, run_index, index - run_index);
+    kept_count += index - run_index;
+    if (run_index < sorted_count) kept_sorted_count += (index < sorted_count ? index : sorted_count) - run_index;
+    run_index = index + 1;
+  }
+
+  buffer->block_count = kept_count;
+  buffer->sorted_count = kept_sorted_count;
+  return block_count - kept_count;
+}
+
+size_t nb_remove_indices(struct nb_buffer * buffer, const size_t * sorted_indices, size_t index_count) {
+  const size_t block_count = buffer->block_count;
+  size_t kept_count = 0;
+  size_t run_index = 0;
+  size_t sorted_removed = 0;
+
+  for (size_t i = 0; i < index_count && sorted_indices[i] < block_count; i++) {
+    const size_t index = sorted_indices[i];
+    if (index < run_index) continue;
+    move_blocks(buffer, kept_count, run_index, index - run_index);
+    kept_count += index - run_index;
+    run_index = index + 1;
+    if (index < buffer->sorted_count) sorted_removed++;
+  }
+  if (run_index == 0) return 0;
+
+  move_blocks(buffer, kept_count, run_index, block_count - run_index);
+  kept_count += block_count - run_index;
+  buffer->block_count = kept_count;
+  buffer->sorted_count -= sorted_removed;
+  return block_count - kept_count;
 }
 
 void nb_sort(struct nb_buffer * buffer, nb_compare_fn compare_fn) {
   qsort(buffer->data, buffer->block_count, buffer->block_size, compare_fn);
+  buffer->sorted_count = buffer->block_count;
 }
 
 struct nb_buffer_iterator nb_iterator(const struct nb_buffer * buffer) {
@@ -0,0 +1,315 @@
+#include "naughty-buffers/channel.h"
+#include "atomic.h"
+#include "memory.h"
+#include "thread.h"
+
+#include <stdint.h>
+
+// positions advance by 2 so the lowest bit of the send position can mark the channel as closed: once it is set, the
+// compare-and-swap of every sender fails and no slot can be claimed anymore. Every slot holds its sequence number
+// followed by its block. A slot at position p is free for the sender claiming p when its sequence number is p, and
+// ready for the receiver claiming p when it is p + 2.
+#define NB_CHANNEL_STEP 2
+#define NB_CHANNEL_CLOSED 1
+
+// the word waiting threads sleep on. Its upper bits count the changes that can let them go on and its lowest bit says
+// whether any thread may be sleeping on it, so threads that do not need to wake anybody make no system call
+#define NB_CHANNEL_CHANGE 2
+#define NB_CHANNEL_SLEEPING 1
+
+struct channel_event {
+  nb_atomic_u32 word;
+  uint8_t padding[NB_CACHE_LINE_SIZE];
+};
+
+struct nb_channel {
+  struct nb_buffer slots;
+  size_t mask;
+  size_t block_size;
+
+  uint8_t send_padding[NB_CACHE_LINE_SIZE];
+  nb_atomic_size send_position;
+
+  uint8_t receive_padding[NB_CACHE_LINE_SIZE];
+  nb_atomic_size receive_position;
+
+  uint8_t events_padding[NB_CACHE_LINE_SIZE];
+  struct channel_event room;
+  struct channel_event blocks;
+};
+
+typedef int (*channel_ready_fn)(struct nb_channel * channel);
+
+static void * ctx_alloc(struct nb_buffer_memory_context * memory_context, size_t size) {
+  return memory_context->alloc_fn(size, memory_context->context);
+}
+
+static void ctx_release(struct nb_buffer_memory_context * memory_context, void * ptr) {
+  memory_context->free_fn(ptr, memory_context->context);
+}
+
+static void ctx_copy(struct nb_channel * channel, void * destination, const void * source, size_t size) {
+  channel->slots.memory_context->copy_fn(destination, source, size, channel->slots.memory_context->context);
+}
+
+static uint8_t * slot_at(struct nb_channel * channel, size_t position) {
+  return (uint8_t *) channel->slots.data + (((position / NB_CHANNEL_STEP) & channel->mask) * channel->slots.block_size);
+}
+
+static nb_atomic_size * slot_sequence(uint8_t * slot) { return (nb_atomic_size *) slot; }
+
+static uint8_t * slot_block(uint8_t * slot) { return slot + sizeof(nb_atomic_size); }
+
+static size_t slot_state(struct nb_channel * channel, size_t position) {
+  return nb_atomic_load_acquire(slot_sequence(slot_at(channel, position)));
+}
+
+// positions wrap around, so they are compared through the sign of their difference
+static int position_before(size_t a, size_t b) { return (a - b) > SIZE_MAX / 2; }
+
+// counts a change and, if a thread went to sleep since the last one, wakes every sleeping thread. Clearing the bit
+// lets the changes that follow skip the system call until some thread sleeps again, so all of them have to be woken.
+static void notify(struct channel_event * event) {
+  uint32_t word = nb_atomic_u32_load(&event->word);
+  uint32_t changed;
+  do {
+    changed = (word + NB_CHANNEL_CHANGE) & ~(uint32_t) NB_CHANNEL_SLEEPING;
+  } while (!nb_atomic_u32_compare_exchange(&event->word, &word, changed));
+  if (word & NB_CHANNEL_SLEEPING) nb_thread_wake(&event->word, UINT32_MAX);
+}
+
+// sleeps until the event changes, unless `ready` says there is no need to. The sleeping bit is set before checking, so
+// a thread that makes the channel ready afterwards changes the word (the sleep then returns right away) and sees the
+// bit, waking the thread if it is already asleep. Returns 0 if the deadline passed.
+static int wait_event(
+    struct nb_channel * channel,
+    struct channel_event * event,
+    channel_ready_fn ready,
+    uint64_t deadline,
+    long timeout_ms
+) {
+  long remaining = NB_CHANNEL_WAIT_FOREVER;
+  if (timeout_ms == 0) return 0;
+  if (timeout_ms > 0) {
+    const uint64_t now = nb_thread_clock_ms();
+    if (now >= deadline) return 0;
+    remaining = (long) (deadline - now);
+  }
+
+  uint32_t word = nb_atomic_u32_load(&event->word);
+  while (!(word & NB_CHANNEL_SLEEPING)) {
+    if (nb_atomic_u32_compare_exchange(&event->word, &word, word | NB_CHANNEL_SLEEPING)) word |= NB_CHANNEL_SLEEPING;
+  }
+  if (!ready(channel)) nb_thread_wait(&event->word, word, remaining);
+  return 1;
+}
+
+static int is_closed(size_t send_position) { return (send_position & NB_CHANNEL_CLOSED) != 0; }
+
+static int can_send(struct nb_channel * channel) {
+  const size_t position = nb_atomic_load(&channel->send_position);
+  return is_closed(position) || slot_state(channel, position) == position;
+}
+
+static int can_receive(struct nb_channel * channel) {
+  const size_t position = nb_atomic_load(&channel->receive_position);
+  if (slot_state(channel, position) == position + NB_CHANNEL_STEP) return 1;
+  const size_t send_position = nb_atomic_load(&channel->send_position);
+  return is_closed(send_position) && send_position - NB_CHANNEL_CLOSED == position;
+}
+
+// claims as many consecutive free slots as possible, up to block_count, and fills them. Returns how many blocks were
+// sent, or SIZE_MAX if the channel is closed.
+static size_t try_send(struct nb_channel * channel, const uint8_t * data, size_t block_count) {
+  size_t position = nb_atomic_load(&channel->send_position);
+  for (;;) {
+    if (is_closed(position)) return SIZE_MAX;
+
+    size_t count = 0;
+    while (count < block_count && count <= channel->mask) {
+      if (slot_state(channel, position + (count * NB_CHANNEL_STEP)) != position + (count * NB_CHANNEL_STEP)) break;
+      count++;
+    }
+
+    if (count == 0) {
+      // the slot still holds a block from the previous lap: the channel is full. Otherwise another sender claimed it
+      if (position_before(slot_state(channel, position), position)) return 0;
+      position = nb_atomic_load(&channel->send_position);
+      continue;
+    }
+
+    if (!nb_atomic_compare_exchange(&channel->send_position, &position, position + (count * NB_CHANNEL_STEP))) continue;
+
+    for (size_t i = 0; i < count; i++) {
+      const size_t slot_position = position + (i * NB_CHANNEL_STEP);
+      uint8_t * slot = slot_at(channel, slot_position);
+      ctx_copy(channel, slot_block(slot), data + (i * channel->block_size), channel->block_size);
+      nb_atomic_store_release(slot_sequence(slot), slot_position + NB_CHANNEL_STEP);
+    }
+    return count;
+  }
+}
+
+// claims as many consecutive ready slots as possible, up to block_count, and empties them. Returns how many blocks
+// were received.
+static size_t try_receive(struct nb_channel * channel, uint8_t * destination, size_t block_count) {
+  const size_t lap = (channel->mask + 1) * NB_CHANNEL_STEP;
+  size_t position = nb_atomic_load(&channel->receive_position);
+  for (;;) {
+    size_t count = 0;
+    while (count < block_count && count <= channel->mask) {
+      const size_t slot_position = position + (count * NB_CHANNEL_STEP);
+      if (slot_state(channel, slot_position) != slot_position + NB_CHANNEL_STEP) break;
+      count++;
+    }
+
+    if (count == 0) {
+      // the slot was not written yet: the channel is empty. Otherwise another receiver claimed it
+      if (position_before(slot_state(channel, position), position + NB_CHANNEL_STEP)) return 0;
+      position = nb_atomic_load(&channel->receive_position);
+      continue;
+    }
+
+    if (!nb_atomic_compare_exchange(&channel->receive_position, &position, position + (count * NB_CHANNEL_STEP))) {
+      continue;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      const size_t slot_position = position + (i * NB_CHANNEL_STEP);
+      uint8_t * slot = slot_at(channel, slot_position);
+      ctx_copy(channel, destination + (i * channel->block_size), slot_block(slot), channel->block_size);
+      nb_atomic_store_release(slot_sequence(slot), slot_position + lap);
+    }
+    return count;
+  }
+}
+
+static uint64_t deadline_after(long timeout_ms) {
+  return timeout_ms > 0 ? nb_thread_clock_ms() + (uint64_t) timeout_ms : 0;
+}
+
+static enum NB_SEND_RESULT
+channel_send(struct nb_channel * channel, const uint8_t * data, size_t block_count, long timeout_ms, size_t * sent) {
+  const uint64_t deadline = deadline_after(timeout_ms);
+  *sent = 0;
+  while (*sent < block_count) {
+    const size_t count = try_send(channel, data + (*sent * channel->block_size), block_count - *sent);
+    if (count == SIZE_MAX) return NB_SEND_CLOSED;
+    if (count > 0) {
+      *sent += count;
+      notify(&channel->blocks);
+      continue;
+    }
+    if (!wait_event(channel, &channel->room, can_send, deadline, timeout_ms)) return NB_SEND_TIMEOUT;
+  }
+  return NB_SEND_OK;
+}
+
+static enum NB_RECEIVE_RESULT channel_receive(
+    struct nb_channel * channel,
+    uint8_t * destination,
+    size_t block_count,
+    long timeout_ms,
+    size_t * received
+) {
+  const uint64_t deadline = deadline_after(timeout_ms);
+  *received = 0;
+  for (;;) {
+    const size_t count = try_receive(channel, destination, block_count);
+    if (count > 0) {
+      *received = count;
+      notify(&channel->room);
+      return NB_RECEIVE_OK;
+    }
+
+    const size_t send_position = nb_atomic_load(&channel->send_position);
+    if (is_closed(send_position) && send_position - NB_CHANNEL_CLOSED == nb_atomic_load(&channel->receive_position)) {
+      return NB_RECEIVE_CLOSED;
+    }
+    if (!wait_event(channel, &channel->blocks, can_receive, deadline, timeout_ms)) return NB_RECEIVE_TIMEOUT;
+  }
+}
+
+struct nb_channel * nb_channel_create(size_t block_size, size_t capacity) {
+  return nb_channel_create_advanced(block_size, capacity, &default_memory_context);
+}
+
+struct nb_channel * nb_channel_create_advanced(
+    size_t block_size,
+    size_t capacity,
+    struct nb_buffer_memory_context * memory_context
+) {
+  // with a single slot, a block waiting to be received would look like a free slot for the next lap
+  size_t rounded = 2;
+  while (rounded < capacity) {
+    if (rounded > SIZE_MAX / 4) return NULL;
+    rounded *= 2;
+  }
+
+  // slots are rounded up to keep their sequence numbers aligned
+  const size_t alignment = sizeof(nb_atomic_size);
+  if (block_size == 0 || block_size > SIZE_MAX / 2) return NULL;
+  const size_t slot_size = (sizeof(nb_atomic_size) + block_size + alignment - 1) / alignment * alignment;
+  if (rounded > SIZE_MAX / slot_size) return NULL;
+
+  struct nb_channel * channel = ctx_alloc(memory_context, sizeof(struct nb_channel));
+  if (channel == NULL) return NULL;
+
+  nb_init_lazy_advanced(&channel->slots, slot_size, memory_context);
+  if (nb_reserve(&channel->slots, rounded) != NB_RESERVE_OK) {
+    ctx_release(memory_context, channel);
+    return NULL;
+  }
+
+  channel->mask = rounded - 1;
+  channel->block_size = block_size;
+  for (size_t i = 0; i < rounded; i++) {
+    nb_atomic_store_relaxed(slot_sequence(slot_at(channel, i * NB_CHANNEL_STEP)), i * NB_CHANNEL_STEP);
+  }
+  nb_atomic_store_relaxed(&channel->send_position, 0);
+  nb_atomic_store_relaxed(&channel->receive_position, 0);
+  nb_atomic_u32_store(&channel->room.word, 0);
+  nb_atomic_u32_store(&channel->blocks.word, 0);
+  return channel;
+}
+
+void nb_channel_destroy(struct nb_channel * channel) {
+  if (channel == NULL) return;
+  struct nb_buffer_memory_context * memory_context = channel->slots.memory_context;
+  nb_release(&channel->slots);
+  ctx_release(memory_context, channel);
+}
+
+size_t nb_channel_capacity(const struct nb_channel * channel) { return channel->mask + 1; }
+
+void nb_channel_close(struct nb_channel * channel) {
+  size_t position = nb_atomic_load(&channel->send_position);
+  while (!is_closed(position)) {
+    if (nb_atomic_compare_exchange(&channel->send_position, &position, position | NB_CHANNEL_CLOSED)) break;
+  }
+  notify(&channel->room);
+  notify(&channel->blocks);
+}
+
+enum NB_SEND_RESULT nb_channel_send(struct nb_channel * channel, const void * data, long timeout_ms) {
+  size_t sent;
+  return channel_send(channel, data, 1, timeout_ms, &sent);
+}
+
+size_t nb_channel_send_many(struct nb_channel * channel, const void * data, size_t block_count, long timeout_ms) {
+  size_t sent;
+  channel_send(channel, data, block_count, timeout_ms, &sent);
+  return sent;
+}
+
+enum NB_RECEIVE_RESULT nb_channel_receive(struct nb_channel * channel, void * destination, long timeout_ms) {
+  size_t received;
+  return channel_receive(channel, destination, 1, timeout_ms, &received);
+}
+
+size_t nb_channel_receive_many(struct nb_channel * channel, void * destination, size_t block_count, long timeout_ms) {
+  size_t received;
+  if (block_count == 0) return 0;
+  channel_receive(channel, destination, block_count, timeout_ms, &received);
+  return received;
+}
@@ -0,0 +1,197 @@
+#include "naughty-buffers/compact-buffer.h"
+#include "memory.h"
+
+static void * ctx_alloc(const struct nb_compact_context * context, size_t size) {
+  return context->memory_context->alloc_fn(size, context->memory_context->context);
+}
+
+static void * ctx_realloc(const struct nb_compact_context * context, void * ptr, size_t size) {
+  return context->memory_context->realloc_fn(ptr, size, context->memory_context->context);
+}
+
+static void * ctx_copy(const struct nb_compact_context * context, void * destination, void * source, size_t size) {
+  return context->memory_context->copy_fn(destination, source, size, context->memory_context->context);
+}
+
+static void * ctx_move(const struct nb_compact_context * context, void * destination, void * source, size_t size) {
+  return context->memory_context->move_fn(destination, source, size, context->memory_context->context);
+}
+
+static void ctx_release(const struct nb_compact_context * context, void * ptr) {
+  context->memory_context->free_fn(ptr, context->memory_context->context);
+}
+
+static size_t ctx_usable_size(const struct nb_compact_context * context, void * ptr) {
+  if (context->memory_context->usable_size_fn == NULL) return 0;
+  return context->memory_context->usable_size_fn(ptr, context->memory_context->context);
+}
+
+// how many blocks fit in the memory handed out for `ptr`, or 0 if the memory context cannot tell
+static size_t ctx_usable_blocks(const struct nb_compact_context * context, void * ptr) {
+  if (context->block_size == 0) return 0;
+  return ctx_usable_size(context, ptr) / context->block_size;
+}
+
+void nb_compact_context_init(struct nb_compact_context * context, size_t block_size) {
+  nb_compact_context_init_advanced(context, block_size, &default_memory_context);
+}
+
+void nb_compact_context_init_advanced(
+    struct nb_compact_context * context,
+    size_t block_size,
+    struct nb_buffer_memory_context * memory_context
+) {
+  context->block_size = block_size;
+  context->memory_context = memory_context;
+}
+
+void nb_compact_init(struct nb_compact_buffer * buffer) {
+  buffer->data = NULL;
+  buffer->block_count = 0;
+  buffer->block_capacity = 0;
+}
+
+static uint8_t compact_resize(
+    const struct nb_compact_context * context,
+    struct nb_compact_buffer * buffer,
+    size_t new_block_capacity
+) {
+  if (new_block_capacity > UINT32_MAX) return 0;
+  void * new_data;
+  if (buffer->data == NULL) new_data = ctx_alloc(context, context->block_size * new_block_capacity);
+  else new_data = ctx_realloc(context, buffer->data, context->block_size * new_block_capacity);
+  if (new_data == NULL) return 0;
+
+  const size_t usable_block_capacity = ctx_usable_blocks(context, new_data);
+  if (usable_block_capacity > new_block_capacity) new_block_capacity = usable_block_capacity;
+  if (new_block_capacity > UINT32_MAX) new_block_capacity = UINT32_MAX;
+
+  buffer->data = new_data;
+  buffer->block_capacity = (uint32_t) new_block_capacity;
+  return 1;
+}
+
+static uint8_t compact_grow(
+    const struct nb_compact_context * context,
+    struct nb_compact_buffer * buffer,
+    size_t required_capacity
+) {
+  if (required_capacity <= buffer->block_capacity) return 1;
+  if (required_capacity > UINT32_MAX) return 0;
+  size_t new_block_capacity = buffer->block_capacity > 0 ? (size_t) buffer->block_capacity * 2 : 2;
+  while (new_block_capacity < required_capacity) new_block_capacity *= 2;
+  if (new_block_capacity > UINT32_MAX) new_block_capacity = UINT32_MAX;
+  return compact_resize(context, buffer, new_block_capacity);
+}
+
+enum NB_PUSH_RESULT nb_compact_push(
+    const struct nb_compact_context * context,
+    struct nb_compact_buffer * buffer,
+    void * data
+) {
+  return nb_compact_push_many(context, buffer, data, 1);
+}
+
+enum NB_PUSH_RESULT nb_compact_push_many(
+    const struct nb_compact_context * context,
+    struct nb_compact_buffer * buffer,
+    void * data,
+    size_t block_count
+) {
+  if (block_count == 0) return NB_PUSH_OK;
+  if (!compact_grow(context, buffer, (size_t) buffer->block_count + block_count)) return NB_PUSH_OUT_OF_MEMORY;
+
+  uint8_t * buffer_data = buffer->data;
+  void * block_data = buffer_data + (buffer->block_count * context->block_size);
+  ctx_copy(context, block_data, data, context->block_size * block_count);
+  buffer->block_count += (uint32_t) block_count;
+  return NB_PUSH_OK;
+}
+
+enum NB_ASSIGN_RESULT nb_compact_assign(
+    const struct nb_compact_context * context,
+    struct nb_compact_buffer * buffer,
+    size_t index,
+    void * data
+) {
+  if (!compact_grow(context, buffer, index + 1)) return NB_ASSIGN_OUT_OF_MEMORY;
+
+  uint8_t * buffer_data = buffer->data;
+  void * block_data = buffer_data + (index * context->block_size);
+  ctx_copy(context, block_data, data, context->block_size);
+  if (index >= buffer->block_count) buffer->block_count = (uint32_t) index + 1;
+  return NB_ASSIGN_OK;
+}
+
+enum NB_INSERT_RESULT nb_compact_insert(
+    const struct nb_compact_context * context,
+    struct nb_compact_buffer * buffer,
+    size_t index,
+    void * data
+) {
+  const size_t required_size = index >= buffer->block_count ? index + 1 : (size_t) buffer->block_count + 1;
+  if (!compact_grow(context, buffer, required_size)) return NB_INSERT_OUT_OF_MEMORY;
+
+  uint8_t * buffer_data = buffer->data;
+  uint8_t * block_data = buffer_data + (index * context->block_size);
+  if (index < buffer->block_count) {
+    size_t move_size = (buffer->block_count - index) * context->block_size;
+    ctx_move(context, block_data + context->block_size, block_data, move_size);
+  }
+  ctx_copy(context, block_data, data, context->block_size);
+  buffer->block_count = (uint32_t) required_size;
+  return NB_INSERT_OK;
+}
+
+size_t nb_compact_block_count(const struct nb_compact_buffer * buffer) { return buffer->block_count; }
+
+void * nb_compact_at(
+    const struct nb_compact_context * context,
+    const struct nb_compact_buffer * buffer,
+    size_t index
+) {
+  if (index >= buffer->block_count) return NULL;
+  uint8_t * buffer_data = buffer->data;
+  return buffer_data + (context->block_size * index);
+}
+
+void nb_compact_remove_at(
+    const struct nb_compact_context * context,
+    struct nb_compact_buffer * buffer,
+    size_t index
+) {
+  if (index >= buffer->block_count) return;
+  if (index < buffer->block_count - 1u) {
+    uint8_t * buffer_data = buffer->data;
+    uint8_t * block_data = buffer_data + (index * context->block_size);
+    size_t move_size = (buffer->block_count - index - 1) * context->block_size;
+    ctx_move(context, block_data, block_data + context->block_size, move_size);
+  }
+  buffer->block_count--;
+}
+
+enum NB_RESERVE_RESULT nb_compact_reserve(
+    const struct nb_compact_context * context,
+    struct nb_compact_buffer * buffer,
+    size_t block_capacity
+) {
+  if (block_capacity <= buffer->block_capacity) return NB_RESERVE_OK;
+  if (!compact_resize(context, buffer, block_capacity)) return NB_RESERVE_OUT_OF_MEMORY;
+  return NB_RESERVE_OK;
+}
+
+struct nb_buffer_iterator nb_compact_iterator(
+    const struct nb_compact_context * context,
+    const struct nb_compact_buffer * buffer
+) {
+  return (struct nb_buffer_iterator) {
+    .begin = (uint8_t *) buffer->data,
+    .end = (uint8_t *) buffer->data + (buffer->block_count * context->block_size),
+    .increment = context->block_size
+  };
+}
+
+void nb_compact_release(const struct nb_compact_context * context, struct nb_compact_buffer * buffer) {
+  if (buffer->data != NULL) ctx_release(context, buffer->data);
+  nb_compact_init(buffer);
+}
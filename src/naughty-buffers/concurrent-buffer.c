@@ -0,0 +1,325 @@
+#include "naughty-buffers/concurrent-buffer.h"
+#include "atomic.h"
+#include "memory.h"
+#include "thread.h"
+
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// segment k holds NB_SEGMENT_BASE << k blocks, so the first one holds 1024 blocks and a few dozen of them cover any
+// index a size_t can hold
+#define NB_SEGMENT_SHIFT 10
+#define NB_SEGMENT_BASE ((size_t) 1 << NB_SEGMENT_SHIFT)
+#define NB_MAX_SEGMENTS (sizeof(size_t) * 8 - NB_SEGMENT_SHIFT)
+
+// a published block may keep a flag of 0 when it moved the watermark itself; a lost block always has its flag set
+#define NB_BLOCK_PUBLISHED 1
+#define NB_BLOCK_LOST 2
+
+// stands in for a segment that could not be allocated. None of its blocks will ever be written, so the watermark
+// skips them all and blocks reserved in it afterwards fail right away.
+static uint8_t lost_segment_marker;
+#define NB_LOST_SEGMENT ((void *) &lost_segment_marker)
+
+// the word readers sleep on while waiting for the watermark. Its upper bits count the times the watermark moved while
+// some reader was sleeping and its lowest bit says whether any reader may be sleeping on it, so publishing threads
+// only touch it when there is somebody to wake.
+#define NB_WATERMARK_CHANGE 2
+#define NB_WATERMARK_SLEEPING 1
+
+// every segment starts with one published flag per block, followed by the blocks themselves
+struct nb_concurrent_buffer {
+  struct nb_buffer_memory_context * memory_context;
+  size_t block_size;
+  nb_atomic_pointer segments[NB_MAX_SEGMENTS];
+
+  uint8_t reserved_padding[NB_CACHE_LINE_SIZE];
+  nb_atomic_size reserved;
+
+  uint8_t published_padding[NB_CACHE_LINE_SIZE];
+  nb_atomic_size published;
+  nb_atomic_u32 watermark_event;
+
+  uint8_t end_padding[NB_CACHE_LINE_SIZE];
+};
+
+struct location {
+  size_t segment;
+  size_t offset;
+};
+
+static void * ctx_alloc(struct nb_concurrent_buffer * buffer, size_t size) {
+  return buffer->memory_context->alloc_fn(size, buffer->memory_context->context);
+}
+
+static void ctx_release(struct nb_concurrent_buffer * buffer, void * ptr) {
+  buffer->memory_context->free_fn(ptr, buffer->memory_context->context);
+}
+
+static void ctx_copy(struct nb_concurrent_buffer * buffer, void * destination, const void * source, size_t size) {
+  buffer->memory_context->copy_fn(destination, source, size, buffer->memory_context->context);
+}
+
+static size_t segment_size(size_t segment) { return NB_SEGMENT_BASE << segment; }
+
+// position of the highest bit set in a value that is not 0
+static size_t highest_bit(size_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+  return sizeof(unsigned long long) * 8 - 1 - (size_t) __builtin_clzll((unsigned long long) value);
+#elif defined(_MSC_VER) && defined(_WIN64)
+  unsigned long bit;
+  _BitScanReverse64(&bit, value);
+  return bit;
+#elif defined(_MSC_VER)
+  unsigned long bit;
+  _BitScanReverse(&bit, value);
+  return bit;
+#else
+  size_t bit = 0;
+  while (value >>= 1) bit++;
+  return bit;
+#endif
+}
+
+static struct location locate(size_t index) {
+  // segment k starts at NB_SEGMENT_BASE * (2^k - 1), so k is the highest bit set in index / NB_SEGMENT_BASE + 1
+  struct location location;
+  location.segment = highest_bit((index >> NB_SEGMENT_SHIFT) + 1);
+  location.offset = index - ((((size_t) 1 << location.segment) - 1) << NB_SEGMENT_SHIFT);
+  return location;
+}
+
+static nb_atomic_u32 * segment_flags(void * segment) { return segment; }
+
+static uint8_t * segment_block(const struct nb_concurrent_buffer * buffer, void * segment, struct location location) {
+  const size_t flags_size = segment_size(location.segment) * sizeof(nb_atomic_u32);
+  return (uint8_t *) segment + flags_size + (location.offset * buffer->block_size);
+}
+
+static void * load_segment(const struct nb_concurrent_buffer * buffer, size_t segment) {
+  return nb_atomic_pointer_load_acquire((nb_atomic_pointer *) &buffer->segments[segment]);
+}
+
+// returns the segment, allocating it if no thread did it yet, or NULL if it is lost. Threads racing to allocate the
+// same segment never wait for each other: the first one to store its pointer wins and the others release what they
+// allocated. A thread that cannot allocate it marks it lost, unless another thread stored its segment first.
+static void * ensure_segment(struct nb_concurrent_buffer * buffer, size_t segment) {
+  void * current = load_segment(buffer, segment);
+  if (current == NB_LOST_SEGMENT) return NULL;
+  if (current != NULL) return current;
+
+  const size_t count = segment_size(segment);
+  void * allocated = NULL;
+  if (count <= SIZE_MAX / (sizeof(nb_atomic_u32) + buffer->block_size)) {
+    allocated = ctx_alloc(buffer, count * (sizeof(nb_atomic_u32) + buffer->block_size));
+  }
+
+  if (allocated == NULL) {
+    if (nb_atomic_pointer_compare_exchange(&buffer->segments[segment], &current, NB_LOST_SEGMENT)) return NULL;
+    return current == NB_LOST_SEGMENT ? NULL : current;
+  }
+  memset(allocated, 0, count * sizeof(nb_atomic_u32));
+
+  if (nb_atomic_pointer_compare_exchange(&buffer->segments[segment], &current, allocated)) return allocated;
+  ctx_release(buffer, allocated);
+  return current == NB_LOST_SEGMENT ? NULL : current;
+}
+
+// wakes the readers sleeping in nb_concurrent_wait_published, if any, after the watermark moved. Loading the word
+// after moving the watermark, while readers set their bit before checking it, means that either the reader sees the
+// new watermark or this thread sees the bit.
+static void notify_watermark(struct nb_concurrent_buffer * buffer) {
+  uint32_t word = nb_atomic_u32_load(&buffer->watermark_event);
+  while (word & NB_WATERMARK_SLEEPING) {
+    const uint32_t changed = (word + NB_WATERMARK_CHANGE) & ~(uint32_t) NB_WATERMARK_SLEEPING;
+    if (nb_atomic_u32_compare_exchange(&buffer->watermark_event, &word, changed)) {
+      nb_thread_wake(&buffer->watermark_event, UINT32_MAX);
+      return;
+    }
+  }
+}
+
+// moves the watermark past every published block that follows it. The flag stores, the loads here and the exchange
+// of the watermark are all sequentially consistent, so two threads publishing at the same time cannot both miss what
+// the other did: either this thread sees the blocks published by the other one, or the other one sees the watermark
+// moved by this thread and moves it past its own blocks.
+static void advance_watermark(struct nb_concurrent_buffer * buffer) {
+  size_t published = nb_atomic_load(&buffer->published);
+  for (;;) {
+    const size_t reserved = nb_atomic_load(&buffer->reserved);
+    size_t end = published;
+    while (end < reserved) {
+      struct location location = locate(end);
+      void * segment = nb_atomic_pointer_load(&buffer->segments[location.segment]);
+      if (segment == NULL) break;
+
+      const size_t count = segment_size(location.segment);
+      if (segment == NB_LOST_SEGMENT) {
+        end = reserved - end < count - location.offset ? reserved : end + (count - location.offset);
+        continue;
+      }
+
+      nb_atomic_u32 * flags = segment_flags(segment);
+      while (location.offset < count && end < reserved && nb_atomic_u32_load(&flags[location.offset])) {
+        location.offset++;
+        end++;
+      }
+      if (location.offset < count) break;
+    }
+
+    if (end == published) return;
+    if (nb_atomic_compare_exchange(&buffer->published, &published, end)) published = end;
+  }
+}
+
+static void publish_range(struct nb_concurrent_buffer * buffer, size_t first, size_t count) {
+  // blocks right at the watermark move it without touching their flags, which nobody reads below the watermark. The
+  // scan that follows still picks up the blocks published after them in the meantime.
+  size_t expected = first;
+  if (nb_atomic_compare_exchange(&buffer->published, &expected, first + count)) {
+    advance_watermark(buffer);
+    notify_watermark(buffer);
+    return;
+  }
+
+  size_t index = first;
+  while (index < first + count) {
+    struct location location = locate(index);
+    nb_atomic_u32 * flags = segment_flags(load_segment(buffer, location.segment));
+    const size_t size = segment_size(location.segment);
+    for (; location.offset < size && index < first + count; location.offset++, index++) {
+      nb_atomic_u32_store(&flags[location.offset], NB_BLOCK_PUBLISHED);
+    }
+  }
+  advance_watermark(buffer);
+  notify_watermark(buffer);
+}
+
+// gives up blocks that were reserved but cannot be written because a segment could not be allocated, so the
+// watermark moves past them instead of stopping there forever. Their flags are always set, even at the watermark, so
+// readers can tell them apart; blocks in lost segments have no flags and are told apart by their segment.
+static void discard_range(struct nb_concurrent_buffer * buffer, size_t first, size_t count) {
+  size_t index = first;
+  while (index < first + count) {
+    struct location location = locate(index);
+    const size_t size = segment_size(location.segment);
+    void * segment = ensure_segment(buffer, location.segment);
+    if (segment == NULL) {
+      index = first + count - index < size - location.offset ? first + count : index + (size - location.offset);
+      continue;
+    }
+
+    nb_atomic_u32 * flags = segment_flags(segment);
+    for (; location.offset < size && index < first + count; location.offset++, index++) {
+      nb_atomic_u32_store(&flags[location.offset], NB_BLOCK_LOST);
+    }
+  }
+  advance_watermark(buffer);
+  notify_watermark(buffer);
+}
+
+struct nb_concurrent_buffer * nb_concurrent_buffer_create(size_t block_size) {
+  return nb_concurrent_buffer_create_advanced(block_size, &default_memory_context);
+}
+
+struct nb_concurrent_buffer *
+nb_concurrent_buffer_create_advanced(size_t block_size, struct nb_buffer_memory_context * memory_context) {
+  struct nb_concurrent_buffer * buffer =
+      memory_context->alloc_fn(sizeof(struct nb_concurrent_buffer), memory_context->context);
+  if (buffer == NULL) return NULL;
+
+  buffer->memory_context = memory_context;
+  buffer->block_size = block_size;
+  for (size_t segment = 0; segment < NB_MAX_SEGMENTS; segment++) buffer->segments[segment] = NULL;
+  nb_atomic_store_relaxed(&buffer->reserved, 0);
+  nb_atomic_store_relaxed(&buffer->published, 0);
+  nb_atomic_u32_store(&buffer->watermark_event, 0);
+  return buffer;
+}
+
+void nb_concurrent_buffer_destroy(struct nb_concurrent_buffer * buffer) {
+  if (buffer == NULL) return;
+  for (size_t segment = 0; segment < NB_MAX_SEGMENTS; segment++) {
+    void * allocated = load_segment(buffer, segment);
+    if (allocated != NULL && allocated != NB_LOST_SEGMENT) ctx_release(buffer, allocated);
+  }
+  ctx_release(buffer, buffer);
+}
+
+void * nb_concurrent_reserve(struct nb_concurrent_buffer * buffer, size_t * out_index) {
+  const size_t index = nb_atomic_fetch_add(&buffer->reserved, 1);
+  const struct location location = locate(index);
+  void * segment = ensure_segment(buffer, location.segment);
+  if (segment == NULL) {
+    discard_range(buffer, index, 1);
+    return NULL;
+  }
+
+  *out_index = index;
+  return segment_block(buffer, segment, location);
+}
+
+void nb_concurrent_publish(struct nb_concurrent_buffer * buffer, size_t index) { publish_range(buffer, index, 1); }
+
+enum NB_PUSH_RESULT nb_concurrent_push(struct nb_concurrent_buffer * buffer, const void * data) {
+  return nb_concurrent_push_many(buffer, data, 1);
+}
+
+enum NB_PUSH_RESULT
+nb_concurrent_push_many(struct nb_concurrent_buffer * buffer, const void * data, size_t block_count) {
+  if (block_count == 0) return NB_PUSH_OK;
+
+  const size_t first = nb_atomic_fetch_add(&buffer->reserved, block_count);
+  const uint8_t * source = data;
+  size_t index = first;
+  while (index < first + block_count) {
+    const struct location location = locate(index);
+    void * segment = ensure_segment(buffer, location.segment);
+    if (segment == NULL) {
+      discard_range(buffer, first, block_count);
+      return NB_PUSH_OUT_OF_MEMORY;
+    }
+
+    const size_t room = segment_size(location.segment) - location.offset;
+    const size_t count = first + block_count - index < room ? first + block_count - index : room;
+    ctx_copy(buffer, segment_block(buffer, segment, location), source, count * buffer->block_size);
+    source += count * buffer->block_size;
+    index += count;
+  }
+
+  publish_range(buffer, first, block_count);
+  return NB_PUSH_OK;
+}
+
+size_t nb_concurrent_published_count(const struct nb_concurrent_buffer * buffer) {
+  return nb_atomic_load_acquire((nb_atomic_size *) &buffer->published);
+}
+
+size_t nb_concurrent_wait_published(const struct nb_concurrent_buffer * buffer, size_t block_count) {
+  nb_atomic_u32 * event = (nb_atomic_u32 *) &buffer->watermark_event;
+  size_t published = nb_concurrent_published_count(buffer);
+  while (published < block_count) {
+    // the sleeping bit is set before checking the watermark again, see notify_watermark
+    uint32_t word = nb_atomic_u32_load(event);
+    while (!(word & NB_WATERMARK_SLEEPING)) {
+      if (nb_atomic_u32_compare_exchange(event, &word, word | NB_WATERMARK_SLEEPING)) word |= NB_WATERMARK_SLEEPING;
+    }
+    published = nb_atomic_load((nb_atomic_size *) &buffer->published);
+    if (published >= block_count) break;
+    nb_thread_wait(event, word, -1);
+    published = nb_concurrent_published_count(buffer);
+  }
+  return published;
+}
+
+void * nb_concurrent_at(const struct nb_concurrent_buffer * buffer, size_t index) {
+  if (index >= nb_concurrent_published_count(buffer)) return NULL;
+  const struct location location = locate(index);
+  void * segment = load_segment(buffer, location.segment);
+  if (segment == NB_LOST_SEGMENT) return NULL;
+  if (nb_atomic_u32_load(&segment_flags(segment)[location.offset]) == NB_BLOCK_LOST) return NULL;
+  return segment_block(buffer, segment, location);
+}
@@ -1,6 +1,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__GLIBC__) || defined(_WIN32)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#endif
+
 #include "memory.h"
 
 void * nb_memory_alloc(const size_t memory_size, void * context) {
@@ -27,3 +33,17 @@ void * nb_memory_move(void * destination, const void * source, const size_t size
   (void) context;
   return memmove(destination, source, size);
 }
+
+size_t nb_memory_usable_size(void * ptr, void * context) {
+  (void) context;
+#if defined(__GLIBC__)
+  return malloc_usable_size(ptr);
+#elif defined(_WIN32)
+  return _msize(ptr);
+#elif defined(__APPLE__)
+  return malloc_size(ptr);
+#else
+  (void) ptr;
+  return 0;
+#endif
+}
@@ -1,7 +1,11 @@
 #ifndef NAUGHTY_BUFFERS_MEMORY_H
 #define NAUGHTY_BUFFERS_MEMORY_H
 
+#include "naughty-buffers/buffer.h"
 #include "naughty-buffers/naughty-buffers-export.h"
+#include <stddef.h>
+
+extern NAUGHTY_BUFFERS_NO_EXPORT struct nb_buffer_memory_context default_memory_context;
 
 NAUGHTY_BUFFERS_NO_EXPORT void * nb_memory_alloc(size_t memory_size, void * context);
 NAUGHTY_BUFFERS_NO_EXPORT void nb_memory_release(void * ptr, void * context);
@@ -9,4 +13,6 @@ NAUGHTY_BUFFERS_NO_EXPORT void * nb_memory_realloc(void * ptr, size_t memory_siz
 NAUGHTY_BUFFERS_NO_EXPORT void * nb_memory_copy(void * destination, const void * source, size_t size, void * context);
 NAUGHTY_BUFFERS_NO_EXPORT void * nb_memory_move(void * destination, const void * source, size_t size, void * context);
 
+NAUGHTY_BUFFERS_NO_EXPORT size_t nb_memory_usable_size(void * ptr, void * context);
+
 #endif // NAUGHTY_BUFFERS_MEMORY_H
@@ -0,0 +1,180 @@
+#include "naughty-buffers/pool.h"
+#include "memory.h"
+#include "thread.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#define NB_THREAD_LOCAL __declspec(thread)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define NB_THREAD_LOCAL _Thread_local
+#else
+#define NB_THREAD_LOCAL __thread
+#endif
+
+#define NB_POOL_MIN_CLASS_SHIFT 4
+#define NB_POOL_MAX_CLASS_SHIFT 20
+#define NB_POOL_CLASS_COUNT (NB_POOL_MAX_CLASS_SHIFT - NB_POOL_MIN_CLASS_SHIFT + 1)
+#define NB_POOL_HUGE_CLASS ((size_t) -1)
+#define NB_POOL_HEADER_SIZE 16
+
+struct nb_pool_block {
+  size_t class_index;
+  union {
+    /** Size of huge allocations */
+    size_t size;
+
+    /** Next free block in the same free list */
+    struct nb_pool_block * next;
+  } u;
+};
+
+struct nb_pool_thread_cache {
+  struct nb_pool_block * free_lists[NB_POOL_CLASS_COUNT];
+  size_t free_list_sizes[NB_POOL_CLASS_COUNT];
+  struct nb_pool_stats stats;
+
+  /** Non-zero once the thread is registered to flush its free lists when it exits */
+  uint8_t flushes_at_exit;
+};
+
+static NB_THREAD_LOCAL struct nb_pool_thread_cache thread_cache;
+
+static void flush_at_exit(void);
+
+static struct nb_thread_exit_hook thread_exit_hook = {.fn = flush_at_exit};
+
+static size_t class_size(size_t class_index) { return (size_t) 1 << (class_index + NB_POOL_MIN_CLASS_SHIFT); }
+
+static size_t class_of(size_t size) {
+  size_t class_index = 0;
+  while (class_size(class_index) < size) class_index++;
+  return class_index;
+}
+
+static struct nb_pool_block * block_of(void * ptr) {
+  return (struct nb_pool_block *) ((uint8_t *) ptr - NB_POOL_HEADER_SIZE);
+}
+
+static void * block_data(struct nb_pool_block * block) { return (uint8_t *) block + NB_POOL_HEADER_SIZE; }
+
+static size_t block_usable_size(struct nb_pool_block * block) {
+  if (block->class_index == NB_POOL_HUGE_CLASS) return block->u.size;
+  return class_size(block->class_index);
+}
+
+static void * pool_alloc(size_t size, void * context) {
+  (void) context;
+  struct nb_pool_block * block;
+
+  if (size > NB_POOL_MAX_CLASS_SIZE) {
+    block = malloc(NB_POOL_HEADER_SIZE + size);
+    if (block == NULL) return NULL;
+    block->class_index = NB_POOL_HUGE_CLASS;
+    block->u.size = size;
+    thread_cache.stats.huge_allocations++;
+    return block_data(block);
+  }
+
+  const size_t class_index = class_of(size);
+  block = thread_cache.free_lists[class_index];
+  if (block != NULL) {
+    thread_cache.free_lists[class_index] = block->u.next;
+    thread_cache.free_list_sizes[class_index]--;
+    thread_cache.stats.cached_bytes -= class_size(class_index);
+    thread_cache.stats.cache_hits++;
+  } else {
+    block = malloc(NB_POOL_HEADER_SIZE + class_size(class_index));
+    if (block == NULL) return NULL;
+    thread_cache.stats.cache_misses++;
+  }
+  block->class_index = class_index;
+  return block_data(block);
+}
+
+static void pool_release(void * ptr, void * context) {
+  (void) context;
+  if (ptr == NULL) return;
+
+  struct nb_pool_block * block = block_of(ptr);
+  const size_t class_index = block->class_index;
+  if (class_index == NB_POOL_HUGE_CLASS || thread_cache.free_list_sizes[class_index] >= NB_POOL_MAX_CACHED_BLOCKS) {
+    free(block);
+    thread_cache.stats.system_releases++;
+    return;
+  }
+
+  // threads that never call nb_pool_thread_flush would otherwise leak their free lists when they exit
+  if (!thread_cache.flushes_at_exit) thread_cache.flushes_at_exit = (uint8_t) nb_thread_at_exit(&thread_exit_hook);
+
+  block->u.next = thread_cache.free_lists[class_index];
+  thread_cache.free_lists[class_index] = block;
+  thread_cache.free_list_sizes[class_index]++;
+  thread_cache.stats.cached_bytes += class_size(class_index);
+}
+
+static void * pool_realloc(void * ptr, size_t size, void * context) {
+  if (ptr == NULL) return pool_alloc(size, context);
+
+  struct nb_pool_block * block = block_of(ptr);
+  if (block->class_index == NB_POOL_HUGE_CLASS && size > NB_POOL_MAX_CLASS_SIZE) {
+    block = realloc(block, NB_POOL_HEADER_SIZE + size);
+    if (block == NULL) return NULL;
+    block->u.size = size;
+    return block_data(block);
+  }
+
+  if (block->class_index != NB_POOL_HUGE_CLASS && size <= NB_POOL_MAX_CLASS_SIZE &&
+      class_of(size) == block->class_index) {
+    thread_cache.stats.in_place_reallocs++;
+    return ptr;
+  }
+
+  void * new_ptr = pool_alloc(size, context);
+  if (new_ptr == NULL) return NULL;
+  const size_t old_size = block_usable_size(block);
+  memcpy(new_ptr, ptr, old_size < size ? old_size : size);
+  pool_release(ptr, context);
+  return new_ptr;
+}
+
+static size_t pool_usable_size(void * ptr, void * context) {
+  (void) context;
+  return block_usable_size(block_of(ptr));
+}
+
+static struct nb_buffer_memory_context pool_memory_context = {
+    .alloc_fn = pool_alloc,
+    .realloc_fn = pool_realloc,
+    .free_fn = pool_release,
+    .copy_fn = nb_memory_copy,
+    .move_fn = nb_memory_move,
+    .context = NULL,
+    .usable_size_fn = pool_usable_size
+};
+
+struct nb_buffer_memory_context * nb_pool_memory_context(void) { return &pool_memory_context; }
+
+void nb_pool_thread_stats(struct nb_pool_stats * stats) { *stats = thread_cache.stats; }
+
+void nb_pool_thread_flush(void) {
+  for (size_t class_index = 0; class_index < NB_POOL_CLASS_COUNT; class_index++) {
+    struct nb_pool_block * block = thread_cache.free_lists[class_index];
+    while (block != NULL) {
+      struct nb_pool_block * next = block->u.next;
+      free(block);
+      thread_cache.stats.system_releases++;
+      block = next;
+    }
+    thread_cache.free_lists[class_index] = NULL;
+    thread_cache.free_list_sizes[class_index] = 0;
+  }
+  thread_cache.stats.cached_bytes = 0;
+}
+
+// blocks released by the destructors that run after this one register the thread again
+static void flush_at_exit(void) {
+  nb_pool_thread_flush();
+  thread_cache.flushes_at_exit = 0;
+}
@@ -0,0 +1,141 @@
+#include "naughty-buffers/queue.h"
+#include "atomic.h"
+#include "memory.h"
+
+#include <stdint.h>
+
+// the producer fields and the consumer fields are kept NB_CACHE_LINE_SIZE bytes apart, so enqueuing does not
+// invalidate the cache line the consumer is reading and vice versa. Each side keeps a copy of the index of the other
+// side and only loads the shared one when the copy says the ring is full (or empty).
+struct nb_spsc_queue {
+  struct nb_buffer slots;
+  size_t mask;
+
+  uint8_t producer_padding[NB_CACHE_LINE_SIZE];
+  nb_atomic_size tail;
+  size_t cached_head;
+
+  uint8_t consumer_padding[NB_CACHE_LINE_SIZE];
+  nb_atomic_size head;
+  size_t cached_tail;
+
+  uint8_t end_padding[NB_CACHE_LINE_SIZE];
+};
+
+static void * ctx_alloc(struct nb_buffer_memory_context * memory_context, size_t size) {
+  return memory_context->alloc_fn(size, memory_context->context);
+}
+
+static void ctx_release(struct nb_buffer_memory_context * memory_context, void * ptr) {
+  memory_context->free_fn(ptr, memory_context->context);
+}
+
+static void ctx_copy(struct nb_spsc_queue * queue, void * destination, const void * source, size_t size) {
+  queue->slots.memory_context->copy_fn(destination, source, size, queue->slots.memory_context->context);
+}
+
+static uint8_t * slot_at(struct nb_spsc_queue * queue, size_t index) {
+  return (uint8_t *) queue->slots.data + ((index & queue->mask) * queue->slots.block_size);
+}
+
+// copies `count` blocks between `blocks` and the ring starting at `index`, in two pieces if the range wraps around
+static void ring_copy(struct nb_spsc_queue * queue, size_t index, uint8_t * blocks, size_t count, uint8_t to_ring) {
+  const size_t block_size = queue->slots.block_size;
+  const size_t until_end = queue->mask + 1 - (index & queue->mask);
+  const size_t first = count < until_end ? count : until_end;
+
+  if (to_ring) {
+    ctx_copy(queue, slot_at(queue, index), blocks, first * block_size);
+    if (count > first) ctx_copy(queue, slot_at(queue, 0), blocks + (first * block_size), (count - first) * block_size);
+  } else {
+    ctx_copy(queue, blocks, slot_at(queue, index), first * block_size);
+    if (count > first) ctx_copy(queue, blocks + (first * block_size), slot_at(queue, 0), (count - first) * block_size);
+  }
+}
+
+struct nb_spsc_queue * nb_spsc_queue_create(size_t block_size, size_t capacity) {
+  return nb_spsc_queue_create_advanced(block_size, capacity, &default_memory_context);
+}
+
+struct nb_spsc_queue * nb_spsc_queue_create_advanced(
+    size_t block_size,
+    size_t capacity,
+    struct nb_buffer_memory_context * memory_context
+) {
+  size_t rounded = 1;
+  while (rounded < capacity) {
+    if (rounded > SIZE_MAX / 2) return NULL;
+    rounded *= 2;
+  }
+  if (block_size == 0 || rounded > SIZE_MAX / block_size) return NULL;
+
+  struct nb_spsc_queue * queue = ctx_alloc(memory_context, sizeof(struct nb_spsc_queue));
+  if (queue == NULL) return NULL;
+
+  nb_init_lazy_advanced(&queue->slots, block_size, memory_context);
+  if (nb_reserve(&queue->slots, rounded) != NB_RESERVE_OK) {
+    ctx_release(memory_context, queue);
+    return NULL;
+  }
+
+  queue->mask = rounded - 1;
+  queue->cached_head = 0;
+  queue->cached_tail = 0;
+  nb_atomic_store_relaxed(&queue->tail, 0);
+  nb_atomic_store_relaxed(&queue->head, 0);
+  return queue;
+}
+
+void nb_spsc_queue_destroy(struct nb_spsc_queue * queue) {
+  if (queue == NULL) return;
+  struct nb_buffer_memory_context * memory_context = queue->slots.memory_context;
+  nb_release(&queue->slots);
+  ctx_release(memory_context, queue);
+}
+
+size_t nb_spsc_queue_capacity(const struct nb_spsc_queue * queue) { return queue->mask + 1; }
+
+enum NB_ENQUEUE_RESULT nb_spsc_enqueue(struct nb_spsc_queue * queue, const void * data) {
+  return nb_spsc_enqueue_many(queue, data, 1) == 1 ? NB_ENQUEUE_OK : NB_ENQUEUE_FULL;
+}
+
+enum NB_DEQUEUE_RESULT nb_spsc_dequeue(struct nb_spsc_queue * queue, void * destination) {
+  return nb_spsc_dequeue_many(queue, destination, 1) == 1 ? NB_DEQUEUE_OK : NB_DEQUEUE_EMPTY;
+}
+
+size_t nb_spsc_enqueue_many(struct nb_spsc_queue * queue, const void * data, size_t block_count) {
+  const size_t capacity = queue->mask + 1;
+  const size_t tail = nb_atomic_load_relaxed(&queue->tail);
+
+  size_t free_slots = capacity - (tail - queue->cached_head);
+  if (free_slots < block_count) {
+    // acquire pairs with the release in dequeue: the consumer is done reading the slots it gave back
+    queue->cached_head = nb_atomic_load_acquire(&queue->head);
+    free_slots = capacity - (tail - queue->cached_head);
+  }
+
+  const size_t count = block_count < free_slots ? block_count : free_slots;
+  if (count == 0) return 0;
+
+  ring_copy(queue, tail, (uint8_t *) data, count, 1);
+  nb_atomic_store_release(&queue->tail, tail + count);
+  return count;
+}
+
+size_t nb_spsc_dequeue_many(struct nb_spsc_queue * queue, void * destination, size_t block_count) {
+  const size_t head = nb_atomic_load_relaxed(&queue->head);
+
+  size_t available = queue->cached_tail - head;
+  if (available < block_count) {
+    // acquire pairs with the release in enqueue: the blocks written by the producer are visible
+    queue->cached_tail = nb_atomic_load_acquire(&queue->tail);
+    available = queue->cached_tail - head;
+  }
+
+  const size_t count = block_count < available ? block_count : available;
+  if (count == 0) return 0;
+
+  ring_copy(queue, head, destination, count, 0);
+  nb_atomic_store_release(&queue->head, head + count);
+  return count;
+}
@@ -0,0 +1,113 @@
+#include "naughty-buffers/search.h"
+
+#include <string.h>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define NB_PREFETCH(address) _mm_prefetch((const char *) (address), _MM_HINT_T0)
+#elif defined(__GNUC__) || defined(__clang__)
+#define NB_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define NB_PREFETCH(address) ((void) (address))
+#endif
+
+// the searched range shrinks by half on every probe, without a branch on the result of the comparison, which
+// compilers turn into conditional moves. Without branches there is no speculation either, so both possible next
+// probes are prefetched instead. Returns the first index in [first, end) whose block goes after the key if `upper` is
+// set, or does not go before it otherwise.
+static size_t search_partition(
+    const struct nb_buffer * buffer,
+    size_t first,
+    size_t end,
+    const void * key,
+    nb_compare_fn compare_fn,
+    uint8_t upper
+) {
+  const uint8_t * data = buffer->data;
+  const size_t block_size = buffer->block_size;
+  size_t count = end - first;
+  if (count == 0) return first;
+
+  while (count > 1) {
+    const size_t half = count / 2;
+    // the next probe is in one of the two halves, fetching both hides the cache miss of the one taken
+    NB_PREFETCH(data + ((first + (half / 2)) * block_size));
+    NB_PREFETCH(data + ((first + half + (half / 2)) * block_size));
+    const int comparison = compare_fn(data + ((first + half) * block_size), key);
+    first = (upper ? comparison <= 0 : comparison < 0) ? first + half : first;
+    count -= half;
+  }
+  const int comparison = compare_fn(data + (first * block_size), key);
+  return first + (upper ? comparison <= 0 : comparison < 0);
+}
+
+size_t nb_lower_bound(const struct nb_buffer * buffer, const void * key, nb_compare_fn compare_fn) {
+  return search_partition(buffer, 0, buffer->block_count, key, compare_fn, 0);
+}
+
+size_t nb_upper_bound(const struct nb_buffer * buffer, const void * key, nb_compare_fn compare_fn) {
+  return search_partition(buffer, 0, buffer->block_count, key, compare_fn, 1);
+}
+
+struct nb_index_range nb_equal_range(const struct nb_buffer * buffer, const void * key, nb_compare_fn compare_fn) {
+  const size_t first = search_partition(buffer, 0, buffer->block_count, key, compare_fn, 0);
+  const size_t end = search_partition(buffer, first, buffer->block_count, key, compare_fn, 1);
+  return (struct nb_index_range) {.first = first, .end = end};
+}
+
+enum NB_INSERT_RESULT nb_insert_sorted(struct nb_buffer * buffer, void * data, nb_compare_fn compare_fn) {
+  const size_t sorted_count = buffer->sorted_count;
+  const size_t index = search_partition(buffer, 0, buffer->block_count, data, compare_fn, 1);
+  const enum NB_INSERT_RESULT result = nb_insert(buffer, index, data);
+  if (result == NB_INSERT_OK && index <= sorted_count) buffer->sorted_count = sorted_count + 1;
+  return result;
+}
+
+// the children of the block at `index` are at `2 * index + 1` and `2 * index + 2`, so an in-order walk of the
+// implicit tree visits the positions in the order of the sorted blocks
+static size_t eytzinger_fill(
+    const uint8_t * source,
+    uint8_t * destination,
+    size_t block_size,
+    size_t block_count,
+    size_t source_index,
+    size_t index
+) {
+  if (index >= block_count) return source_index;
+  source_index = eytzinger_fill(source, destination, block_size, block_count, source_index, (index * 2) + 1);
+  memcpy(destination + (index * block_size), source + (source_index * block_size), block_size);
+  return eytzinger_fill(source, destination, block_size, block_count, source_index + 1, (index * 2) + 2);
+}
+
+enum NB_EYTZINGER_RESULT nb_build_eytzinger(const struct nb_buffer * source, struct nb_buffer * destination) {
+  if (source->block_size != destination->block_size) return NB_EYTZINGER_BLOCK_SIZE_MISMATCH;
+  const size_t block_count = source->block_count;
+  if (nb_reserve(destination, block_count) != NB_RESERVE_OK) return NB_EYTZINGER_OUT_OF_MEMORY;
+
+  nb_remove_range(destination, 0, nb_block_count(destination));
+  if (block_count == 0) return NB_EYTZINGER_OK;
+  uint8_t * blocks = nb_push_uninit(destination, block_count);
+  eytzinger_fill(source->data, blocks, source->block_size, block_count, 0, 0);
+  return NB_EYTZINGER_OK;
+}
+
+size_t nb_eytzinger_find(const struct nb_buffer * eytzinger, const void * key, nb_compare_fn compare_fn) {
+  const uint8_t * data = eytzinger->data;
+  const size_t block_size = eytzinger->block_size;
+  const size_t block_count = eytzinger->block_count;
+
+  size_t index = 0;
+  while (index < block_count) {
+    // the 16 blocks four levels below start at 16 * index + 15, and are contiguous
+    const size_t descendant = (index * 16) + 15;
+    if (descendant < block_count) NB_PREFETCH(data + (descendant * block_size));
+    index = (index * 2) + 1 + (compare_fn(data + (index * block_size), key) < 0);
+  }
+
+  // going right means the block went before the key. The answer is where the walk last went left: dropping the
+  // trailing right turns (and the last left one) from the 1-based position gives it back
+  size_t position = index + 1;
+  while (position & 1) position >>= 1;
+  position >>= 1;
+  return position == 0 ? block_count : position - 1;
+}
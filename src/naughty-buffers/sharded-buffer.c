@@ -0,0 +1,171 @@
+#include "naughty-buffers/sharded-buffer.h"
+#include "atomic.h"
+#include "memory.h"
+#include "thread.h"
+
+#include <stdint.h>
+
+#define NB_COLLECT_MAX_THREADS 64
+#define NB_COLLECT_MIN_CHUNK ((size_t) 1 << 18)
+
+// every shard is followed by a cache line of padding, so pushing to a shard (which writes its block count) does not
+// invalidate the cache lines holding the other shards, wherever the allocator placed them
+struct sharded_shard {
+  struct nb_buffer buffer;
+  uint8_t padding[NB_CACHE_LINE_SIZE];
+};
+
+struct nb_sharded_buffer {
+  struct nb_buffer shards;
+  size_t shard_count;
+};
+
+// a worker copies the bytes in [begin, end) of the concatenation of all shards to the same place in `destination`
+struct collect_worker {
+  struct nb_thread thread;
+  const struct nb_sharded_buffer * buffer;
+  struct nb_buffer_memory_context * memory_context;
+  uint8_t * destination;
+  size_t begin;
+  size_t end;
+};
+
+static void * ctx_alloc(struct nb_buffer_memory_context * memory_context, size_t size) {
+  return memory_context->alloc_fn(size, memory_context->context);
+}
+
+static void ctx_release(struct nb_buffer_memory_context * memory_context, void * ptr) {
+  memory_context->free_fn(ptr, memory_context->context);
+}
+
+static struct nb_buffer * shard_at(const struct nb_sharded_buffer * buffer, size_t shard) {
+  return &((struct sharded_shard *) buffer->shards.data)[shard].buffer;
+}
+
+static void collect_work(void * argument) {
+  const struct collect_worker * worker = argument;
+  struct nb_buffer_memory_context * memory_context = worker->memory_context;
+  size_t offset = 0;
+
+  for (size_t i = 0; i < worker->buffer->shard_count && offset < worker->end; i++) {
+    const struct nb_buffer * shard = shard_at(worker->buffer, i);
+    const size_t size = shard->block_count * shard->block_size;
+    const size_t first = worker->begin > offset ? worker->begin : offset;
+    const size_t last = worker->end < offset + size ? worker->end : offset + size;
+    if (first < last) {
+      const uint8_t * source = (const uint8_t *) nb_at(shard, 0) + (first - offset);
+      memory_context->copy_fn(worker->destination + first, source, last - first, memory_context->context);
+    }
+    offset += size;
+  }
+}
+
+// runs the workers, the first one on the calling thread. Workers whose thread could not be started also run on the
+// calling thread.
+static void collect_run(struct collect_worker * workers, size_t worker_count) {
+  uint8_t started[NB_COLLECT_MAX_THREADS] = {0};
+  for (size_t i = 1; i < worker_count; i++) {
+    started[i] = (uint8_t) nb_thread_start(&workers[i].thread, collect_work, &workers[i]);
+  }
+
+  collect_work(&workers[0]);
+  for (size_t i = 1; i < worker_count; i++) {
+    if (started[i]) nb_thread_join(&workers[i].thread);
+    else collect_work(&workers[i]);
+  }
+}
+
+struct nb_sharded_buffer * nb_sharded_buffer_create(size_t block_size, size_t shard_count) {
+  return nb_sharded_buffer_create_advanced(block_size, shard_count, &default_memory_context);
+}
+
+struct nb_sharded_buffer * nb_sharded_buffer_create_advanced(
+    size_t block_size,
+    size_t shard_count,
+    struct nb_buffer_memory_context * memory_context
+) {
+  if (shard_count == 0) return NULL;
+
+  struct nb_sharded_buffer * buffer = ctx_alloc(memory_context, sizeof(struct nb_sharded_buffer));
+  if (buffer == NULL) return NULL;
+
+  nb_init_lazy_advanced(&buffer->shards, sizeof(struct sharded_shard), memory_context);
+  if (nb_reserve(&buffer->shards, shard_count) != NB_RESERVE_OK) {
+    ctx_release(memory_context, buffer);
+    return NULL;
+  }
+
+  buffer->shard_count = shard_count;
+  for (size_t i = 0; i < shard_count; i++) nb_init_lazy_advanced(shard_at(buffer, i), block_size, memory_context);
+  return buffer;
+}
+
+void nb_sharded_buffer_destroy(struct nb_sharded_buffer * buffer) {
+  if (buffer == NULL) return;
+  struct nb_buffer_memory_context * memory_context = buffer->shards.memory_context;
+  for (size_t i = 0; i < buffer->shard_count; i++) nb_release(shard_at(buffer, i));
+  nb_release(&buffer->shards);
+  ctx_release(memory_context, buffer);
+}
+
+size_t nb_sharded_shard_count(const struct nb_sharded_buffer * buffer) { return buffer->shard_count; }
+
+struct nb_buffer * nb_sharded_shard(struct nb_sharded_buffer * buffer, size_t shard) {
+  if (shard >= buffer->shard_count) return NULL;
+  return shard_at(buffer, shard);
+}
+
+size_t nb_sharded_block_count(const struct nb_sharded_buffer * buffer) {
+  size_t block_count = 0;
+  for (size_t i = 0; i < buffer->shard_count; i++) block_count += nb_block_count(shard_at(buffer, i));
+  return block_count;
+}
+
+size_t nb_sharded_spans(const struct nb_sharded_buffer * buffer, struct nb_sharded_span * spans) {
+  size_t span_count = 0;
+  for (size_t i = 0; i < buffer->shard_count; i++) {
+    struct nb_buffer * shard = shard_at(buffer, i);
+    if (shard->block_count == 0) continue;
+    spans[span_count++] = (struct nb_sharded_span) {nb_at(shard, 0), shard->block_count};
+  }
+  return span_count;
+}
+
+void nb_sharded_clear(struct nb_sharded_buffer * buffer) {
+  for (size_t i = 0; i < buffer->shard_count; i++) {
+    struct nb_buffer * shard = shard_at(buffer, i);
+    nb_remove_range(shard, 0, shard->block_count);
+  }
+}
+
+enum NB_COLLECT_RESULT
+nb_sharded_collect(struct nb_sharded_buffer * buffer, struct nb_buffer * destination, size_t thread_count) {
+  if (destination->block_size != shard_at(buffer, 0)->block_size) return NB_COLLECT_BLOCK_SIZE_MISMATCH;
+  const size_t block_count = nb_sharded_block_count(buffer);
+  if (block_count == 0) return NB_COLLECT_OK;
+
+  const size_t first_block = destination->block_count;
+  if (nb_push_uninit(destination, block_count) == NULL) return NB_COLLECT_OUT_OF_MEMORY;
+  const size_t size = block_count * destination->block_size;
+
+  if (thread_count == 0) thread_count = nb_thread_hardware_count();
+  if (thread_count > NB_COLLECT_MAX_THREADS) thread_count = NB_COLLECT_MAX_THREADS;
+  if (thread_count > size / NB_COLLECT_MIN_CHUNK) thread_count = size / NB_COLLECT_MIN_CHUNK;
+  if (size < NB_PARALLEL_COLLECT_THRESHOLD || thread_count < 2) thread_count = 1;
+
+  // each thread copies about the same amount of bytes, wherever the shard boundaries are
+  struct collect_worker workers[NB_COLLECT_MAX_THREADS];
+  for (size_t i = 0; i < thread_count; i++) {
+    workers[i] = (struct collect_worker) {
+        .buffer = buffer,
+        .memory_context = destination->memory_context,
+        .destination = nb_at(destination, first_block),
+        .begin = (size / thread_count) * i,
+        .end = i + 1 == thread_count ? size : (size / thread_count) * (i + 1)
+    };
+  }
+  collect_run(workers, thread_count);
+
+  nb_sharded_clear(buffer);
+  return NB_COLLECT_OK;
+}
@@ -0,0 +1,678 @@
+#include "naughty-buffers/sort.h"
+#include "thread.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static void * ctx_alloc(struct nb_buffer * buffer, size_t size) {
+  return buffer->memory_context->alloc_fn(size, buffer->memory_context->context);
+}
+
+static void * ctx_copy(struct nb_buffer * buffer, void * destination, void * source, size_t size) {
+  return buffer->memory_context->copy_fn(destination, source, size, buffer->memory_context->context);
+}
+
+static void ctx_release(struct nb_buffer * buffer, void * ptr) {
+  buffer->memory_context->free_fn(ptr, buffer->memory_context->context);
+}
+
+#define NB_RADIX_BITS 8
+#define NB_RADIX_SIZE (1 << NB_RADIX_BITS)
+#define NB_RADIX_MAX_PASSES 8
+
+struct nb_radix_key {
+  size_t offset;
+  size_t width;
+  enum NB_KEY_TYPE type;
+};
+
+// reads a key and maps it to an unsigned integer with the same ordering
+static uint64_t radix_key(const uint8_t * block, const struct nb_radix_key * key) {
+  const uint8_t * key_data = block + key->offset;
+  uint64_t value;
+  switch (key->width) {
+  case 1: {
+    uint8_t narrow;
+    memcpy(&narrow, key_data, 1);
+    value = narrow;
+    break;
+  }
+  case 2: {
+    uint16_t narrow;
+    memcpy(&narrow, key_data, 2);
+    value = narrow;
+    break;
+  }
+  case 4: {
+    uint32_t narrow;
+    memcpy(&narrow, key_data, 4);
+    value = narrow;
+    break;
+  }
+  default: memcpy(&value, key_data, 8); break;
+  }
+
+  const uint64_t sign_bit = (uint64_t) 1 << (key->width * 8 - 1);
+  switch (key->type) {
+  case NB_KEY_SIGNED: return value ^ sign_bit;
+  case NB_KEY_FLOAT:
+    // negative numbers have all bits flipped so bigger magnitudes come first, positive ones just get the sign bit set
+    if (value & sign_bit) return ~value & (sign_bit | (sign_bit - 1));
+    return value | sign_bit;
+  default: return value;
+  }
+}
+
+// copies a block, letting the compiler inline the copy for the most common block sizes
+static void copy_block(uint8_t * destination, const uint8_t * source, size_t block_size) {
+  switch (block_size) {
+  case 4: memcpy(destination, source, 4); break;
+  case 8: memcpy(destination, source, 8); break;
+  case 16: memcpy(destination, source, 16); break;
+  default: memcpy(destination, source, block_size); break;
+  }
+}
+
+static uint8_t radix_key_is_valid(const struct nb_radix_key * key, size_t block_size) {
+  if (key->offset > block_size || key->width > block_size - key->offset) return 0;
+  if (key->type == NB_KEY_FLOAT) return key->width == 4 || key->width == 8;
+  return key->width == 1 || key->width == 2 || key->width == 4 || key->width == 8;
+}
+
+enum NB_SORT_RESULT
+nb_sort_by_key(struct nb_buffer * buffer, size_t key_offset, size_t key_width, enum NB_KEY_TYPE key_type) {
+  const struct nb_radix_key key = {.offset = key_offset, .width = key_width, .type = key_type};
+  const size_t block_size = buffer->block_size;
+  const size_t block_count = buffer->block_count;
+  if (!radix_key_is_valid(&key, block_size)) return NB_SORT_INVALID_KEY;
+  if (block_count < 2) {
+    buffer->sorted_count = block_count;
+    return NB_SORT_OK;
+  }
+
+  // histograms of every pass are built at once, in a single read of the buffer
+  size_t counts[NB_RADIX_MAX_PASSES][NB_RADIX_SIZE];
+  memset(counts, 0, sizeof(counts));
+  const uint8_t * data = buffer->data;
+  for (size_t i = 0; i < block_count; i++) {
+    const uint64_t value = radix_key(data + (i * block_size), &key);
+    for (size_t pass = 0; pass < key_width; pass++) counts[pass][(value >> (pass * NB_RADIX_BITS)) & 0xFF]++;
+  }
+
+  uint8_t * scratch = NULL;
+  uint8_t * source = buffer->data;
+  for (size_t pass = 0; pass < key_width; pass++) {
+    size_t * pass_counts = counts[pass];
+
+    // every key has the same byte in this pass, it would not change the order
+    const uint64_t first_byte = (radix_key(source, &key) >> (pass * NB_RADIX_BITS)) & 0xFF;
+    if (pass_counts[first_byte] == block_count) continue;
+
+    if (scratch == NULL) {
+      scratch = ctx_alloc(buffer, block_size * block_count);
+      if (scratch == NULL) return NB_SORT_OUT_OF_MEMORY;
+    }
+    uint8_t * destination = source == buffer->data ? scratch : buffer->data;
+
+    size_t offset = 0;
+    for (size_t digit = 0; digit < NB_RADIX_SIZE; digit++) {
+      const size_t digit_count = pass_counts[digit];
+      pass_counts[digit] = offset;
+      offset += digit_count;
+    }
+
+    for (size_t i = 0; i < block_count; i++) {
+      const uint8_t * block = source + (i * block_size);
+      const size_t digit = (radix_key(block, &key) >> (pass * NB_RADIX_BITS)) & 0xFF;
+      copy_block(destination + (pass_counts[digit]++ * block_size), block, block_size);
+    }
+    source = destination;
+  }
+
+  if (source != buffer->data) ctx_copy(buffer, buffer->data, source, block_size * block_count);
+  if (scratch != NULL) ctx_release(buffer, scratch);
+  buffer->sorted_count = block_count;
+  return NB_SORT_OK;
+}
+
+#define NB_PARALLEL_MAX_THREADS 64
+#define NB_PARALLEL_MIN_CHUNK 4096
+
+// a slice of work for a parallel sort worker: sorting `left` in place if `destination` is NULL, or merging `left` and
+// `right` into `destination` otherwise
+struct parallel_task {
+  uint8_t * left;
+  size_t left_count;
+  const uint8_t * right;
+  size_t right_count;
+  uint8_t * destination;
+};
+
+struct parallel_worker {
+  struct nb_thread thread;
+  const struct parallel_task * tasks;
+  size_t task_count;
+  size_t first_task;
+  size_t task_stride;
+  size_t block_size;
+  nb_compare_fn compare_fn;
+};
+
+static void parallel_merge(const struct parallel_task * task, size_t block_size, nb_compare_fn compare_fn) {
+  const uint8_t * left = task->left;
+  const uint8_t * right = task->right;
+  size_t left_count = task->left_count;
+  size_t right_count = task->right_count;
+  uint8_t * destination = task->destination;
+
+  while (left_count > 0 && right_count > 0) {
+    if (compare_fn(right, left) < 0) {
+      memcpy(destination, right, block_size);
+      right += block_size;
+      right_count--;
+    } else {
+      memcpy(destination, left, block_size);
+      left += block_size;
+      left_count--;
+    }
+    destination += block_size;
+  }
+  if (left_count > 0) memcpy(destination, left, left_count * block_size);
+  if (right_count > 0) memcpy(destination, right, right_count * block_size);
+}
+
+static void parallel_work(void * argument) {
+  const struct parallel_worker * worker = argument;
+  for (size_t i = worker->first_task; i < worker->task_count; i += worker->task_stride) {
+    const struct parallel_task * task = worker->tasks + i;
+    if (task->destination == NULL) qsort(task->left, task->left_count, worker->block_size, worker->compare_fn);
+    else parallel_merge(task, worker->block_size, worker->compare_fn);
+  }
+}
+
+// runs the tasks on `worker_count` workers, the first one on the calling thread. Workers whose thread could not be
+// started also run on the calling thread.
+static void parallel_run(struct parallel_worker * workers, size_t worker_count, size_t task_count) {
+  uint8_t started[NB_PARALLEL_MAX_THREADS] = {0};
+  for (size_t i = 0; i < worker_count; i++) workers[i].task_count = task_count;
+  for (size_t i = 1; i < worker_count; i++) {
+    started[i] = (uint8_t) nb_thread_start(&workers[i].thread, parallel_work, &workers[i]);
+  }
+
+  parallel_work(&workers[0]);
+  for (size_t i = 1; i < worker_count; i++) {
+    if (started[i]) nb_thread_join(&workers[i].thread);
+    else parallel_work(&workers[i]);
+  }
+}
+
+// number of blocks taken from `left` when the first `output_count` blocks of the merge of `left` and `right` are output
+static size_t parallel_split(
+    const uint8_t * left,
+    size_t left_count,
+    const uint8_t * right,
+    size_t right_count,
+    size_t output_count,
+    size_t block_size,
+    nb_compare_fn compare_fn
+) {
+  size_t low = output_count > right_count ? output_count - right_count : 0;
+  size_t high = output_count < left_count ? output_count : left_count;
+  while (low < high) {
+    const size_t taken = low + (high - low) / 2;
+    const uint8_t * left_block = left + (taken * block_size);
+    const uint8_t * right_block = right + ((output_count - taken - 1) * block_size);
+    if (compare_fn(left_block, right_block) <= 0) low = taken + 1;
+    else high = taken;
+  }
+  return low;
+}
+
+enum NB_SORT_RESULT nb_sort_parallel(struct nb_buffer * buffer, nb_compare_fn compare_fn, size_t thread_count) {
+  const size_t block_size = buffer->block_size;
+  const size_t block_count = buffer->block_count;
+  if (thread_count == 0) thread_count = nb_thread_hardware_count();
+  if (thread_count > NB_PARALLEL_MAX_THREADS) thread_count = NB_PARALLEL_MAX_THREADS;
+  if (thread_count > block_count / NB_PARALLEL_MIN_CHUNK) thread_count = block_count / NB_PARALLEL_MIN_CHUNK;
+  if (block_count < NB_PARALLEL_SORT_THRESHOLD || thread_count < 2) {
+    nb_sort(buffer, compare_fn);
+    return NB_SORT_OK;
+  }
+
+  uint8_t * scratch = ctx_alloc(buffer, block_size * block_count);
+  if (scratch == NULL) return NB_SORT_OUT_OF_MEMORY;
+
+  struct parallel_worker workers[NB_PARALLEL_MAX_THREADS];
+  struct parallel_task tasks[NB_PARALLEL_MAX_THREADS + 1];
+  size_t run_starts[NB_PARALLEL_MAX_THREADS + 1];
+  for (size_t i = 0; i < thread_count; i++) {
+    workers[i] = (struct parallel_worker) {
+        .tasks = tasks, .first_task = i, .task_stride = thread_count, .block_size = block_size, .compare_fn = compare_fn
+    };
+  }
+
+  // each thread sorts a run of about the same size
+  uint8_t * source = buffer->data;
+  const size_t run_size = block_count / thread_count;
+  const size_t run_remainder = block_count % thread_count;
+  for (size_t i = 0; i <= thread_count; i++) run_starts[i] = (i * run_size) + (i < run_remainder ? i : run_remainder);
+  for (size_t i = 0; i < thread_count; i++) {
+    tasks[i] = (struct parallel_task) {
+        .left = source + (run_starts[i] * block_size), .left_count = run_starts[i + 1] - run_starts[i]
+    };
+  }
+  parallel_run(workers, thread_count, thread_count);
+
+  // then pairs of runs are merged until a single one is left, each merge split among the threads so all of them stay
+  // busy even in the last rounds
+  uint8_t * destination = scratch;
+  size_t run_count = thread_count;
+  while (run_count > 1) {
+    const size_t pair_count = run_count / 2;
+    const size_t piece_count = thread_count / pair_count;
+    size_t task_count = 0;
+
+    for (size_t pair = 0; pair < pair_count; pair++) {
+      const size_t first = run_starts[pair * 2];
+      const size_t left_count = run_starts[(pair * 2) + 1] - first;
+      const size_t right_count = run_starts[(pair * 2) + 2] - run_starts[(pair * 2) + 1];
+      uint8_t * left = source + (first * block_size);
+      const uint8_t * right = left + (left_count * block_size);
+
+      size_t output_start = 0;
+      size_t left_start = 0;
+      for (size_t piece = 1; piece <= piece_count; piece++) {
+        const size_t total = left_count + right_count;
+        const size_t output_end = piece == piece_count ? total : (total / piece_count) * piece;
+        const size_t left_end = parallel_split(left, left_count, right, right_count, output_end, block_size, compare_fn);
+        const size_t right_start = output_start - left_start;
+        tasks[task_count++] = (struct parallel_task) {
+            .left = left + (left_start * block_size),
+            .left_count = left_end - left_start,
+            .right = right + (right_start * block_size),
+            .right_count = (output_end - left_end) - right_start,
+            .destination = destination + ((first + output_start) * block_size)
+        };
+        output_start = output_end;
+        left_start = left_end;
+      }
+    }
+
+    // an odd run out is just copied
+    if (run_count % 2 == 1) {
+      const size_t first = run_starts[run_count - 1];
+      tasks[task_count++] = (struct parallel_task) {
+          .left = source + (first * block_size),
+          .left_count = block_count - first,
+          .destination = destination + (first * block_size)
+      };
+    }
+    parallel_run(workers, thread_count, task_count);
+
+    run_count = (run_count + 1) / 2;
+    for (size_t i = 0; i < run_count; i++) run_starts[i] = run_starts[i * 2];
+    run_starts[run_count] = block_count;
+
+    uint8_t * merged = destination;
+    destination = source;
+    source = merged;
+  }
+
+  if (source != buffer->data) ctx_copy(buffer, buffer->data, source, block_size * block_count);
+  ctx_release(buffer, scratch);
+  buffer->sorted_count = block_count;
+  return NB_SORT_OK;
+}
+
+#define NB_ARGSORT_RUN 16
+
+struct argsort {
+  const uint8_t * data;
+  size_t block_size;
+  nb_compare_fn compare_fn;
+  size_t * scratch;
+};
+
+static int argsort_less(const struct argsort * sort, size_t a, size_t b) {
+  return sort->compare_fn(sort->data + (a * sort->block_size), sort->data + (b * sort->block_size)) < 0;
+}
+
+// a top-down merge sort: ranges are sorted depth first, so the blocks of the ranges being merged are still in the
+// cache, unlike when merging runs of increasing width over the whole buffer
+static void argsort_range(const struct argsort * sort, size_t * indices, size_t count) {
+  if (count <= NB_ARGSORT_RUN) {
+    for (size_t i = 1; i < count; i++) {
+      const size_t index = indices[i];
+      size_t j = i;
+      for (; j > 0 && argsort_less(sort, index, indices[j - 1]); j--) indices[j] = indices[j - 1];
+      indices[j] = index;
+    }
+    return;
+  }
+
+  const size_t left_count = count / 2;
+  size_t * right = indices + left_count;
+  const size_t right_count = count - left_count;
+  argsort_range(sort, indices, left_count);
+  argsort_range(sort, right, right_count);
+  if (!argsort_less(sort, right[0], indices[left_count - 1])) return;
+
+  // the left half is moved aside and merged back, the output never catches up with the right half
+  size_t * left = sort->scratch;
+  memcpy(left, indices, left_count * sizeof(size_t));
+  size_t l = 0;
+  size_t r = 0;
+  size_t output = 0;
+  while (l < left_count && r < right_count) {
+    indices[output++] = argsort_less(sort, right[r], left[l]) ? right[r++] : left[l++];
+  }
+  while (l < left_count) indices[output++] = left[l++];
+}
+
+enum NB_SORT_RESULT nb_argsort(struct nb_buffer * buffer, nb_compare_fn compare_fn, size_t * out_indices) {
+  const size_t block_count = buffer->block_count;
+  for (size_t i = 0; i < block_count; i++) out_indices[i] = i;
+
+  struct argsort sort = {
+      .data = buffer->data, .block_size = buffer->block_size, .compare_fn = compare_fn, .scratch = NULL
+  };
+  if (block_count > NB_ARGSORT_RUN) {
+    sort.scratch = ctx_alloc(buffer, (block_count / 2) * sizeof(size_t));
+    if (sort.scratch == NULL) return NB_SORT_OUT_OF_MEMORY;
+  }
+
+  // only indices move, blocks are only read
+  argsort_range(&sort, out_indices, block_count);
+  if (sort.scratch != NULL) ctx_release(buffer, sort.scratch);
+  return NB_SORT_OK;
+}
+
+enum NB_SORT_RESULT nb_apply_permutation(struct nb_buffer * buffer, const size_t * indices) {
+  const size_t block_size = buffer->block_size;
+  const size_t block_count = buffer->block_count;
+  if (block_count < 2) return NB_SORT_OK;
+
+  uint8_t * held = ctx_alloc(buffer, block_size);
+  if (held == NULL) return NB_SORT_OUT_OF_MEMORY;
+  uint8_t * placed = ctx_alloc(buffer, (block_count + 7) / 8);
+  if (placed == NULL) {
+    ctx_release(buffer, held);
+    return NB_SORT_OUT_OF_MEMORY;
+  }
+  memset(placed, 0, (block_count + 7) / 8);
+
+  // each cycle of the permutation is walked once: the first block of the cycle is held aside, every other block is
+  // moved straight to its final position and the held one goes to the last free position
+  uint8_t * data = buffer->data;
+  for (size_t start = 0; start < block_count; start++) {
+    if (placed[start / 8] & (1u << (start % 8))) continue;
+    placed[start / 8] |= (uint8_t) (1u << (start % 8));
+    if (indices[start] == start) continue;
+
+    memcpy(held, data + (start * block_size), block_size);
+    size_t position = start;
+    for (size_t source = indices[position]; source != start; source = indices[position]) {
+      memcpy(data + (position * block_size), data + (source * block_size), block_size);
+      placed[source / 8] |= (uint8_t) (1u << (source % 8));
+      position = source;
+    }
+    memcpy(data + (position * block_size), held, block_size);
+  }
+
+  ctx_release(buffer, placed);
+  ctx_release(buffer, held);
+  buffer->sorted_count = 0;
+  return NB_SORT_OK;
+}
+
+#define NB_STABLE_MAX_RUNS 128
+
+struct stable_sort {
+  uint8_t * data;
+  size_t block_size;
+  nb_compare_fn compare_fn;
+  uint8_t * scratch;
+  size_t run_starts[NB_STABLE_MAX_RUNS];
+  size_t run_lengths[NB_STABLE_MAX_RUNS];
+  size_t run_count;
+};
+
+static uint8_t * stable_block(const struct stable_sort * sort, size_t index) {
+  return sort->data + (index * sort->block_size);
+}
+
+static int stable_less(const struct stable_sort * sort, const void * a, const void * b) {
+  return sort->compare_fn(a, b) < 0;
+}
+
+static void stable_reverse(struct stable_sort * sort, size_t first, size_t count) {
+  for (size_t low = first, high = first + count - 1; low < high; low++, high--) {
+    memcpy(sort->scratch, stable_block(sort, low), sort->block_size);
+    memcpy(stable_block(sort, low), stable_block(sort, high), sort->block_size);
+    memcpy(stable_block(sort, high), sort->scratch, sort->block_size);
+  }
+}
+
+// length of the run starting at `first`. Strictly descending runs are reversed, so equal blocks keep their order.
+static size_t stable_find_run(struct stable_sort * sort, size_t first, size_t end) {
+  size_t last = first + 1;
+  if (last >= end) return end - first;
+  if (stable_less(sort, stable_block(sort, last), stable_block(sort, first))) {
+    while (last + 1 < end && stable_less(sort, stable_block(sort, last + 1), stable_block(sort, last))) last++;
+    stable_reverse(sort, first, last - first + 1);
+  } else {
+    while (last + 1 < end && !stable_less(sort, stable_block(sort, last + 1), stable_block(sort, last))) last++;
+  }
+  return last - first + 1;
+}
+
+// first index in [first, first + count) whose block goes after `block` (upper bound)
+static size_t stable_upper_bound(const struct stable_sort * sort, const void * block, size_t first, size_t count) {
+  while (count > 0) {
+    const size_t half = count / 2;
+    if (stable_less(sort, block, stable_block(sort, first + half))) {
+      count = half;
+    } else {
+      first += half + 1;
+      count -= half + 1;
+    }
+  }
+  return first;
+}
+
+// first index in [first, first + count) whose block does not go before `block` (lower bound)
+static size_t stable_lower_bound(const struct stable_sort * sort, const void * block, size_t first, size_t count) {
+  while (count > 0) {
+    const size_t half = count / 2;
+    if (stable_less(sort, stable_block(sort, first + half), block)) {
+      first += half + 1;
+      count -= half + 1;
+    } else {
+      count = half;
+    }
+  }
+  return first;
+}
+
+// extends the sorted range [first, first + sorted_count) to [first, first + count) with binary insertions
+static void stable_insertion(struct stable_sort * sort, size_t first, size_t sorted_count, size_t count) {
+  const size_t block_size = sort->block_size;
+  for (size_t i = first + sorted_count; i < first + count; i++) {
+    const size_t position = stable_upper_bound(sort, stable_block(sort, i), first, i - first);
+    if (position == i) continue;
+    memcpy(sort->scratch, stable_block(sort, i), block_size);
+    memmove(stable_block(sort, position + 1), stable_block(sort, position), (i - position) * block_size);
+    memcpy(stable_block(sort, position), sort->scratch, block_size);
+  }
+}
+
+// merges the adjacent sorted ranges [first, middle) and [middle, end), copying the smaller one to the scratch area
+static void stable_merge(struct stable_sort * sort, size_t first, size_t middle, size_t end) {
+  const size_t block_size = sort->block_size;
+
+  // blocks already in their final place on both ends are left alone, which makes merging near-sorted runs cheap
+  first = stable_upper_bound(sort, stable_block(sort, middle), first, middle - first);
+  if (first == middle) return;
+  end = stable_lower_bound(sort, stable_block(sort, middle - 1), middle, end - middle);
+
+  const size_t left_count = middle - first;
+  const size_t right_count = end - middle;
+  if (left_count <= right_count) {
+    const uint8_t * left = sort->scratch;
+    const uint8_t * left_end = left + (left_count * block_size);
+    const uint8_t * right = stable_block(sort, middle);
+    const uint8_t * right_end = stable_block(sort, end);
+    uint8_t * output = stable_block(sort, first);
+    memcpy(sort->scratch, output, left_count * block_size);
+    while (left < left_end && right < right_end) {
+      if (stable_less(sort, right, left)) {
+        copy_block(output, right, block_size);
+        right += block_size;
+      } else {
+        copy_block(output, left, block_size);
+        left += block_size;
+      }
+      output += block_size;
+    }
+    if (left < left_end) memcpy(output, left, (size_t) (left_end - left));
+  } else {
+    // merged from the back, so the left range is never overwritten before being read
+    const uint8_t * left_begin = stable_block(sort, first);
+    const uint8_t * left = stable_block(sort, middle);
+    const uint8_t * right_begin = sort->scratch;
+    const uint8_t * right = right_begin + (right_count * block_size);
+    uint8_t * output = stable_block(sort, end);
+    memcpy(sort->scratch, left, right_count * block_size);
+    while (left > left_begin && right > right_begin) {
+      output -= block_size;
+      if (stable_less(sort, right - block_size, left - block_size)) {
+        left -= block_size;
+        copy_block(output, left, block_size);
+      } else {
+        right -= block_size;
+        copy_block(output, right, block_size);
+      }
+    }
+    if (right > right_begin) memcpy(output - (right - right_begin), right_begin, (size_t) (right - right_begin));
+  }
+}
+
+static void stable_merge_at(struct stable_sort * sort, size_t run) {
+  const size_t first = sort->run_starts[run];
+  const size_t middle = first + sort->run_lengths[run];
+  stable_merge(sort, first, middle, middle + sort->run_lengths[run + 1]);
+  sort->run_lengths[run] += sort->run_lengths[run + 1];
+  for (size_t i = run + 1; i + 1 < sort->run_count; i++) {
+    sort->run_starts[i] = sort->run_starts[i + 1];
+    sort->run_lengths[i] = sort->run_lengths[i + 1];
+  }
+  sort->run_count--;
+}
+
+// merges runs until their lengths shrink at least as fast as the fibonacci numbers towards the top of the stack,
+// keeping merges balanced and the stack small
+static void stable_collapse(struct stable_sort * sort) {
+  const size_t * lengths = sort->run_lengths;
+  while (sort->run_count > 1) {
+    size_t run = sort->run_count - 2;
+    if ((run > 0 && lengths[run - 1] <= lengths[run] + lengths[run + 1]) ||
+        (run > 1 && lengths[run - 2] <= lengths[run - 1] + lengths[run])) {
+      if (lengths[run - 1] < lengths[run + 1]) run--;
+    } else if (lengths[run] > lengths[run + 1]) {
+      break;
+    }
+    stable_merge_at(sort, run);
+  }
+}
+
+// runs shorter than this are extended with insertions. It is chosen so the number of runs is a power of two or just
+// below one, which keeps the final merges balanced.
+static size_t stable_min_run(size_t block_count) {
+  size_t odd_bits = 0;
+  while (block_count >= 64) {
+    odd_bits |= block_count & 1;
+    block_count >>= 1;
+  }
+  return block_count + odd_bits;
+}
+
+// sorts [first, first + count), which needs a scratch area of half that many blocks
+static void stable_sort_range(struct stable_sort * sort, size_t first, size_t count) {
+  const size_t end = first + count;
+  const size_t min_run = stable_min_run(count);
+  sort->run_count = 0;
+  for (size_t run_start = first; run_start < end;) {
+    size_t run_length = stable_find_run(sort, run_start, end);
+    if (run_length < min_run) {
+      const size_t forced_length = end - run_start < min_run ? end - run_start : min_run;
+      stable_insertion(sort, run_start, run_length, forced_length);
+      run_length = forced_length;
+    }
+
+    sort->run_starts[sort->run_count] = run_start;
+    sort->run_lengths[sort->run_count] = run_length;
+    sort->run_count++;
+    stable_collapse(sort);
+    run_start += run_length;
+  }
+
+  while (sort->run_count > 1) {
+    size_t run = sort->run_count - 2;
+    if (run > 0 && sort->run_lengths[run - 1] < sort->run_lengths[run + 1]) run--;
+    stable_merge_at(sort, run);
+  }
+}
+
+enum NB_SORT_RESULT nb_stable_sort(struct nb_buffer * buffer, nb_compare_fn compare_fn, struct nb_buffer * scratch) {
+  const size_t block_size = buffer->block_size;
+  const size_t block_count = buffer->block_count;
+  struct stable_sort sort = {.data = buffer->data, .block_size = block_size, .compare_fn = compare_fn, .run_count = 0};
+
+  // sorted buffers need no scratch area at all
+  size_t sorted_count = block_count > 0 ? 1 : 0;
+  while (sorted_count < block_count &&
+         !stable_less(&sort, stable_block(&sort, sorted_count), stable_block(&sort, sorted_count - 1))) {
+    sorted_count++;
+  }
+  if (sorted_count == block_count) {
+    buffer->sorted_count = block_count;
+    return NB_SORT_OK;
+  }
+
+  // merges never copy more than half of the blocks aside
+  const size_t scratch_size = ((block_count / 2) + 1) * block_size;
+  if (scratch != NULL) {
+    nb_remove_range(scratch, 0, nb_block_count(scratch));
+    const size_t scratch_blocks = (scratch_size + scratch->block_size - 1) / scratch->block_size;
+    if (nb_reserve(scratch, scratch_blocks) != NB_RESERVE_OK) return NB_SORT_OUT_OF_MEMORY;
+    sort.scratch = scratch->data;
+  } else {
+    sort.scratch = ctx_alloc(buffer, scratch_size);
+    if (sort.scratch == NULL) return NB_SORT_OUT_OF_MEMORY;
+  }
+
+  stable_sort_range(&sort, 0, block_count);
+  if (scratch == NULL) ctx_release(buffer, sort.scratch);
+  buffer->sorted_count = block_count;
+  return NB_SORT_OK;
+}
+
+enum NB_SORT_RESULT nb_sort_incremental(struct nb_buffer * buffer, nb_compare_fn compare_fn) {
+  const size_t block_size = buffer->block_size;
+  const size_t block_count = buffer->block_count;
+  const size_t sorted_count = buffer->sorted_count;
+  const size_t tail_count = block_count - sorted_count;
+  if (tail_count == 0) return NB_SORT_OK;
+
+  // the tail sort copies at most half the tail aside and the final merge at most the whole tail
+  struct stable_sort sort = {.data = buffer->data, .block_size = block_size, .compare_fn = compare_fn, .run_count = 0};
+  sort.scratch = ctx_alloc(buffer, tail_count * block_size);
+  if (sort.scratch == NULL) return NB_SORT_OUT_OF_MEMORY;
+
+  stable_sort_range(&sort, sorted_count, tail_count);
+  if (sorted_count > 0) stable_merge(&sort, 0, sorted_count, block_count);
+
+  ctx_release(buffer, sort.scratch);
+  buffer->sorted_count = block_count;
+  return NB_SORT_OK;
+}
@@ -0,0 +1,169 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+// WaitOnAddress needs Windows 8
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0602
+#endif
+
+#include "thread.h"
+
+#include <limits.h>
+
+#if !defined(_WIN32)
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#define NB_EXIT_HOOK_NEW 0
+#define NB_EXIT_HOOK_CREATING 1
+#define NB_EXIT_HOOK_READY 2
+#define NB_EXIT_HOOK_FAILED 3
+
+#if defined(_WIN32)
+
+// the slot value is the hook itself, it only needs to be non-NULL for the callback to run
+static VOID WINAPI exit_hook_run(PVOID value) {
+  struct nb_thread_exit_hook * hook = value;
+  if (hook != NULL) hook->fn();
+}
+
+static int exit_hook_create(struct nb_thread_exit_hook * hook) {
+  hook->index = FlsAlloc(exit_hook_run);
+  return hook->index != FLS_OUT_OF_INDEXES;
+}
+
+static int exit_hook_set(struct nb_thread_exit_hook * hook) { return FlsSetValue(hook->index, hook) != 0; }
+
+static DWORD WINAPI thread_entry(LPVOID argument) {
+  struct nb_thread * thread = argument;
+  thread->fn(thread->argument);
+  return 0;
+}
+
+int nb_thread_start(struct nb_thread * thread, nb_thread_fn fn, void * argument) {
+  thread->fn = fn;
+  thread->argument = argument;
+  thread->handle = CreateThread(NULL, 0, thread_entry, thread, 0, NULL);
+  return thread->handle != NULL;
+}
+
+void nb_thread_join(struct nb_thread * thread) {
+  WaitForSingleObject(thread->handle, INFINITE);
+  CloseHandle(thread->handle);
+}
+
+void nb_thread_yield(void) { SwitchToThread(); }
+
+void nb_thread_wait(nb_atomic_u32 * address, uint32_t expected, long timeout_ms) {
+  WaitOnAddress(address, &expected, sizeof(expected), timeout_ms < 0 ? INFINITE : (DWORD) timeout_ms);
+}
+
+void nb_thread_wake(nb_atomic_u32 * address, uint32_t count) {
+  if (count == 1) WakeByAddressSingle((PVOID) address);
+  else WakeByAddressAll((PVOID) address);
+}
+
+uint64_t nb_thread_clock_ms(void) { return GetTickCount64(); }
+
+size_t nb_thread_hardware_count(void) {
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+}
+
+#else
+
+// the key value is the hook itself, it only needs to be non-NULL for the destructor to run
+static void exit_hook_run(void * value) {
+  struct nb_thread_exit_hook * hook = value;
+  hook->fn();
+}
+
+static int exit_hook_create(struct nb_thread_exit_hook * hook) {
+  return pthread_key_create(&hook->key, exit_hook_run) == 0;
+}
+
+static int exit_hook_set(struct nb_thread_exit_hook * hook) { return pthread_setspecific(hook->key, hook) == 0; }
+
+static void * thread_entry(void * argument) {
+  struct nb_thread * thread = argument;
+  thread->fn(thread->argument);
+  return NULL;
+}
+
+int nb_thread_start(struct nb_thread * thread, nb_thread_fn fn, void * argument) {
+  thread->fn = fn;
+  thread->argument = argument;
+  return pthread_create(&thread->handle, NULL, thread_entry, thread) == 0;
+}
+
+void nb_thread_join(struct nb_thread * thread) { pthread_join(thread->handle, NULL); }
+
+void nb_thread_yield(void) { sched_yield(); }
+
+#if defined(__linux__)
+
+void nb_thread_wait(nb_atomic_u32 * address, uint32_t expected, long timeout_ms) {
+  struct timespec timeout = {timeout_ms / 1000, (timeout_ms % 1000) * 1000000};
+  syscall(SYS_futex, (uint32_t *) address, FUTEX_WAIT_PRIVATE, expected, timeout_ms < 0 ? NULL : &timeout, NULL, 0);
+}
+
+void nb_thread_wake(nb_atomic_u32 * address, uint32_t count) {
+  syscall(SYS_futex, (uint32_t *) address, FUTEX_WAKE_PRIVATE, count > INT_MAX ? INT_MAX : (int) count, NULL, NULL, 0);
+}
+
+#else
+
+void nb_thread_wait(nb_atomic_u32 * address, uint32_t expected, long timeout_ms) {
+  (void) address;
+  (void) expected;
+  (void) timeout_ms;
+  sched_yield();
+}
+
+void nb_thread_wake(nb_atomic_u32 * address, uint32_t count) {
+  (void) address;
+  (void) count;
+}
+
+#endif
+
+uint64_t nb_thread_clock_ms(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t) now.tv_sec * 1000 + (uint64_t) now.tv_nsec / 1000000;
+}
+
+size_t nb_thread_hardware_count(void) {
+  const long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (size_t) count : 1;
+}
+
+#endif
+
+// the first thread to get here creates the key, the others sleep until it is done
+int nb_thread_at_exit(struct nb_thread_exit_hook * hook) {
+  uint32_t state = nb_atomic_u32_load(&hook->state);
+  while (state == NB_EXIT_HOOK_NEW || state == NB_EXIT_HOOK_CREATING) {
+    uint32_t expected = NB_EXIT_HOOK_NEW;
+    if (nb_atomic_u32_compare_exchange(&hook->state, &expected, NB_EXIT_HOOK_CREATING)) {
+      state = exit_hook_create(hook) ? NB_EXIT_HOOK_READY : NB_EXIT_HOOK_FAILED;
+      nb_atomic_u32_store(&hook->state, state);
+      nb_thread_wake(&hook->state, UINT32_MAX);
+      break;
+    }
+    nb_thread_wait(&hook->state, NB_EXIT_HOOK_CREATING, -1);
+    state = nb_atomic_u32_load(&hook->state);
+  }
+
+  if (state != NB_EXIT_HOOK_READY) return 0;
+  return exit_hook_set(hook);
+}
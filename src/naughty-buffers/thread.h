@@ -0,0 +1,75 @@
+#ifndef NAUGHTY_BUFFERS_THREAD_H
+#define NAUGHTY_BUFFERS_THREAD_H
+
+#include "atomic.h"
+#include "naughty-buffers/naughty-buffers-export.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+typedef void (*nb_thread_fn)(void * argument);
+
+struct nb_thread {
+#if defined(_WIN32)
+  HANDLE handle;
+#else
+  pthread_t handle;
+#endif
+  nb_thread_fn fn;
+  void * argument;
+};
+
+typedef void (*nb_thread_exit_fn)(void);
+
+/*
+ * Runs `fn` in every thread registered with nb_thread_at_exit when that thread exits. Define it statically with only
+ * `fn` set, the rest is set up by the first registration.
+ */
+struct nb_thread_exit_hook {
+  nb_thread_exit_fn fn;
+  nb_atomic_u32 state;
+#if defined(_WIN32)
+  DWORD index;
+#else
+  pthread_key_t key;
+#endif
+};
+
+/* Starts a thread running `fn(argument)`. Returns 0 if the thread could not be started. */
+NAUGHTY_BUFFERS_NO_EXPORT int nb_thread_start(struct nb_thread * thread, nb_thread_fn fn, void * argument);
+
+/* Waits for a thread started with nb_thread_start to finish */
+NAUGHTY_BUFFERS_NO_EXPORT void nb_thread_join(struct nb_thread * thread);
+
+/* Gives the processor to another thread that is ready to run, if any */
+NAUGHTY_BUFFERS_NO_EXPORT void nb_thread_yield(void);
+
+/*
+ * Sleeps while `*address` holds `expected`, for at most `timeout_ms` milliseconds (forever if negative). Uses futexes
+ * on Linux and WaitOnAddress on Windows; elsewhere it only yields the processor. It can return early for no reason, so
+ * callers check again what they were waiting for.
+ */
+NAUGHTY_BUFFERS_NO_EXPORT void nb_thread_wait(nb_atomic_u32 * address, uint32_t expected, long timeout_ms);
+
+/* Wakes up to `count` threads sleeping in nb_thread_wait on `address` */
+NAUGHTY_BUFFERS_NO_EXPORT void nb_thread_wake(nb_atomic_u32 * address, uint32_t count);
+
+/*
+ * Makes `hook->fn` run when the calling thread exits, using a pthread key on POSIX and a fiber-local storage slot on
+ * Windows. Registering a thread more than once runs `hook->fn` only once. Returns 0 if the key or slot could not be
+ * created.
+ */
+NAUGHTY_BUFFERS_NO_EXPORT int nb_thread_at_exit(struct nb_thread_exit_hook * hook);
+
+/* Milliseconds from a fixed point in the past, never going backwards */
+NAUGHTY_BUFFERS_NO_EXPORT uint64_t nb_thread_clock_ms(void);
+
+/* Number of processors available to the program, at least 1 */
+NAUGHTY_BUFFERS_NO_EXPORT size_t nb_thread_hardware_count(void);
+
+#endif // NAUGHTY_BUFFERS_THREAD_H
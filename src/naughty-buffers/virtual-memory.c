@@ -0,0 +1,480 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "naughty-buffers/virtual-memory.h"
+#include "memory.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#define NB_HAS_MREMAP 1
+#else
+#define NB_HAS_MREMAP 0
+#endif
+
+#define NB_REMAP_HEADER_SIZE 16
+
+struct nb_remap_header {
+  /** Size of the mapping holding the block, including the header, or 0 if the block was allocated with malloc */
+  size_t mapping_size;
+
+  /** Size requested for the block */
+  size_t size;
+};
+
+static struct nb_remap_header * header_of(void * ptr) {
+  return (struct nb_remap_header *) ((uint8_t *) ptr - NB_REMAP_HEADER_SIZE);
+}
+
+static void * header_data(struct nb_remap_header * header) { return (uint8_t *) header + NB_REMAP_HEADER_SIZE; }
+
+static size_t page_size(void) {
+#if defined(_WIN32)
+  SYSTEM_INFO system_info;
+  GetSystemInfo(&system_info);
+  return (size_t) system_info.dwPageSize;
+#else
+  return (size_t) sysconf(_SC_PAGESIZE);
+#endif
+}
+
+static size_t page_round(size_t size) {
+  const size_t page = page_size();
+  return (size + page - 1) / page * page;
+}
+
+#if NB_HAS_MREMAP
+static struct nb_remap_header * map_header(size_t size) {
+  const size_t mapping_size = page_round(NB_REMAP_HEADER_SIZE + size);
+  void * mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping == MAP_FAILED) return NULL;
+  struct nb_remap_header * header = mapping;
+  header->mapping_size = mapping_size;
+  header->size = size;
+  return header;
+}
+
+static struct nb_remap_header * remap_header(struct nb_remap_header * header, size_t size) {
+  const size_t mapping_size = page_round(NB_REMAP_HEADER_SIZE + size);
+  if (mapping_size != header->mapping_size) {
+    void * mapping = mremap(header, header->mapping_size, mapping_size, MREMAP_MAYMOVE);
+    if (mapping == MAP_FAILED) return NULL;
+    header = mapping;
+    header->mapping_size = mapping_size;
+  }
+  header->size = size;
+  return header;
+}
+#endif
+
+static void * remap_alloc(size_t size, void * context) {
+  (void) context;
+  struct nb_remap_header * header;
+#if NB_HAS_MREMAP
+  if (size >= NB_REMAP_THRESHOLD) {
+    header = map_header(size);
+    return header == NULL ? NULL : header_data(header);
+  }
+#endif
+  header = malloc(NB_REMAP_HEADER_SIZE + size);
+  if (header == NULL) return NULL;
+  header->mapping_size = 0;
+  header->size = size;
+  return header_data(header);
+}
+
+static void remap_release(void * ptr, void * context) {
+  (void) context;
+  if (ptr == NULL) return;
+  struct nb_remap_header * header = header_of(ptr);
+#if NB_HAS_MREMAP
+  if (header->mapping_size > 0) {
+    munmap(header, header->mapping_size);
+    return;
+  }
+#endif
+  free(header);
+}
+
+static void * remap_realloc(void * ptr, size_t size, void * context) {
+  if (ptr == NULL) return remap_alloc(size, context);
+  struct nb_remap_header * header = header_of(ptr);
+
+#if NB_HAS_MREMAP
+  if (header->mapping_size > 0) {
+    header = remap_header(header, size);
+    return header == NULL ? NULL : header_data(header);
+  }
+
+  if (size >= NB_REMAP_THRESHOLD) {
+    struct nb_remap_header * new_header = map_header(size);
+    if (new_header == NULL) return NULL;
+    memcpy(header_data(new_header), ptr, header->size < size ? header->size : size);
+    free(header);
+    return header_data(new_header);
+  }
+#endif
+
+  header = realloc(header, NB_REMAP_HEADER_SIZE + size);
+  if (header == NULL) return NULL;
+  header->size = size;
+  return header_data(header);
+}
+
+static size_t remap_usable_size(void * ptr, void * context) {
+  (void) context;
+  struct nb_remap_header * header = header_of(ptr);
+  if (header->mapping_size > 0) return header->mapping_size - NB_REMAP_HEADER_SIZE;
+  return header->size;
+}
+
+static struct nb_buffer_memory_context remap_memory_context = {
+    .alloc_fn = remap_alloc,
+    .realloc_fn = remap_realloc,
+    .free_fn = remap_release,
+    .copy_fn = nb_memory_copy,
+    .move_fn = nb_memory_move,
+    .context = NULL,
+    .usable_size_fn = remap_usable_size
+};
+
+struct nb_buffer_memory_context * nb_remap_memory_context(void) { return &remap_memory_context; }
+
+struct nb_reserved_header {
+  /** Size of the whole reserved range, including the header */
+  size_t reserved_size;
+
+  /** Size of the committed (readable and writable) part of the range, including the header */
+  size_t committed_size;
+};
+
+static struct nb_reserved_header * reserved_header_of(void * ptr) {
+  return (struct nb_reserved_header *) ((uint8_t *) ptr - NB_REMAP_HEADER_SIZE);
+}
+
+static uint8_t commit_range(void * address, size_t size) {
+#if defined(_WIN32)
+  return VirtualAlloc(address, size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+#else
+  return mprotect(address, size, PROT_READ | PROT_WRITE) == 0;
+#endif
+}
+
+static void decommit_range(void * address, size_t size) {
+#if defined(_WIN32)
+  VirtualFree(address, size, MEM_DECOMMIT);
+#else
+  madvise(address, size, MADV_DONTNEED);
+  mprotect(address, size, PROT_NONE);
+#endif
+}
+
+static void * reserve_range(size_t size) {
+#if defined(_WIN32)
+  return VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+#else
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+  flags |= MAP_NORESERVE;
+#endif
+  void * address = mmap(NULL, size, PROT_NONE, flags, -1, 0);
+  return address == MAP_FAILED ? NULL : address;
+#endif
+}
+
+static void release_range(void * address, size_t size) {
+#if defined(_WIN32)
+  (void) size;
+  VirtualFree(address, 0, MEM_RELEASE);
+#else
+  munmap(address, size);
+#endif
+}
+
+static void * reserved_alloc(size_t size, void * context) {
+  const struct nb_reserved_memory * reserved = context;
+  const size_t committed_size = page_round(NB_REMAP_HEADER_SIZE + size);
+  size_t reserved_size = page_round(NB_REMAP_HEADER_SIZE + reserved->reserve_size);
+  if (reserved_size < committed_size) return NULL;
+
+  uint8_t * address = reserve_range(reserved_size);
+  if (address == NULL) return NULL;
+  if (!commit_range(address, committed_size)) {
+    release_range(address, reserved_size);
+    return NULL;
+  }
+
+  struct nb_reserved_header * header = (struct nb_reserved_header *) address;
+  header->reserved_size = reserved_size;
+  header->committed_size = committed_size;
+  return address + NB_REMAP_HEADER_SIZE;
+}
+
+static void * reserved_realloc(void * ptr, size_t size, void * context) {
+  if (ptr == NULL) return reserved_alloc(size, context);
+
+  struct nb_reserved_header * header = reserved_header_of(ptr);
+  uint8_t * address = (uint8_t *) header;
+  const size_t committed_size = page_round(NB_REMAP_HEADER_SIZE + size);
+  if (committed_size > header->reserved_size) return NULL;
+
+  if (committed_size > header->committed_size) {
+    if (!commit_range(address + header->committed_size, committed_size - header->committed_size)) return NULL;
+  } else if (committed_size < header->committed_size) {
+    decommit_range(address + committed_size, header->committed_size - committed_size);
+  }
+  header->committed_size = committed_size;
+  return ptr;
+}
+
+static void reserved_release(void * ptr, void * context) {
+  (void) context;
+  if (ptr == NULL) return;
+  struct nb_reserved_header * header = reserved_header_of(ptr);
+  release_range(header, header->reserved_size);
+}
+
+static size_t reserved_usable_size(void * ptr, void * context) {
+  (void) context;
+  return reserved_header_of(ptr)->committed_size - NB_REMAP_HEADER_SIZE;
+}
+
+void nb_reserved_memory_init(struct nb_reserved_memory * reserved, size_t reserve_size) {
+  reserved->reserve_size = reserve_size;
+  reserved->memory_context = (struct nb_buffer_memory_context) {
+    .alloc_fn = reserved_alloc,
+    .realloc_fn = reserved_realloc,
+    .free_fn = reserved_release,
+    .copy_fn = nb_memory_copy,
+    .move_fn = nb_memory_move,
+    .context = reserved,
+    .usable_size_fn = reserved_usable_size,
+    .keeps_addresses = 1
+  };
+}
+
+#if defined(_WIN32)
+enum NB_MAP_RESULT nb_init_mapped(struct nb_buffer * buffer, size_t block_size, const char * path, unsigned flags) {
+  (void) buffer;
+  (void) block_size;
+  (void) path;
+  (void) flags;
+  return NB_MAP_UNSUPPORTED;
+}
+
+enum NB_SYNC_RESULT nb_sync(struct nb_buffer * buffer) {
+  (void) buffer;
+  return NB_SYNC_OK;
+}
+#else
+#define NB_MAPPED_HEADER_SIZE 64
+
+static const char mapped_magic[8] = {'N', 'B', 'U', 'F', 'F', 'E', 'R', '1'};
+
+struct nb_mapped_file_header {
+  char magic[8];
+  uint64_t block_size;
+  uint64_t block_count;
+};
+
+struct nb_mapped_file {
+  /** Memory context of the mapping. Must be the first member, see mapped_file_of */
+  struct nb_buffer_memory_context memory_context;
+
+  /** The buffer the file was mapped for, used to store its block count back in the file */
+  struct nb_buffer * buffer;
+
+  /** Start of the mapping, where the file header lives */
+  uint8_t * mapping;
+
+  /** Size of the mapping and of the file */
+  size_t mapping_size;
+
+  int fd;
+};
+
+static struct nb_mapped_file_header * mapped_file_header(struct nb_mapped_file * file) {
+  return (struct nb_mapped_file_header *) file->mapping;
+}
+
+static uint8_t * mapped_blocks(const struct nb_mapped_file * file) { return file->mapping + NB_MAPPED_HEADER_SIZE; }
+
+// resizes the file and the mapping so the blocks area holds `size` bytes
+static void * mapped_remap(struct nb_mapped_file * file, size_t size) {
+  const size_t mapping_size = page_round(NB_MAPPED_HEADER_SIZE + size);
+  if (mapping_size == file->mapping_size) return mapped_blocks(file);
+
+  // grow the file before the mapping and shrink it after, so the mapping never goes past the end of the file
+  if (mapping_size > file->mapping_size && ftruncate(file->fd, (off_t) mapping_size) != 0) return NULL;
+
+#if NB_HAS_MREMAP
+  void * mapping = mremap(file->mapping, file->mapping_size, mapping_size, MREMAP_MAYMOVE);
+#else
+  munmap(file->mapping, file->mapping_size);
+  void * mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd, 0);
+#endif
+  if (mapping == MAP_FAILED) {
+#if !NB_HAS_MREMAP
+    // the old mapping is gone, try to get it back so the buffer stays usable
+    mapping = mmap(NULL, file->mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd, 0);
+    if (mapping != MAP_FAILED) file->mapping = mapping;
+#endif
+    return NULL;
+  }
+
+  if (mapping_size < file->mapping_size) {
+    // if shrinking fails the file just keeps its old size: reopening it gives a buffer with more capacity
+    const int truncated = ftruncate(file->fd, (off_t) mapping_size);
+    (void) truncated;
+  }
+  file->mapping = mapping;
+  file->mapping_size = mapping_size;
+  return mapped_blocks(file);
+}
+
+// the buffer only ever reallocates and releases its own blocks, which live in the mapping. Any other memory taken from
+// the context, like the scratch areas of the sorting functions, comes from the heap.
+static void * mapped_alloc(size_t size, void * context) {
+  (void) context;
+  return malloc(size);
+}
+
+static void * mapped_realloc(void * ptr, size_t size, void * context) {
+  struct nb_mapped_file * file = context;
+  if (ptr != mapped_blocks(file)) return realloc(ptr, size);
+  return mapped_remap(file, size);
+}
+
+// blocks removed from the front leave room before the first block, which the file header does not know about
+static void mapped_store_blocks(struct nb_mapped_file * file) {
+  struct nb_buffer * buffer = file->buffer;
+  uint8_t * blocks = mapped_blocks(file);
+  if (buffer->data != blocks) {
+    memmove(blocks, buffer->data, buffer->block_count * buffer->block_size);
+    buffer->data = blocks;
+    buffer->block_capacity += buffer->block_offset;
+    buffer->block_offset = 0;
+  }
+  mapped_file_header(file)->block_count = buffer->block_count;
+}
+
+// releasing the blocks, which ::nb_release does, closes the file
+static void mapped_release(void * ptr, void * context) {
+  struct nb_mapped_file * file = context;
+  if (ptr != mapped_blocks(file)) {
+    free(ptr);
+    return;
+  }
+
+  mapped_store_blocks(file);
+  munmap(file->mapping, file->mapping_size);
+  close(file->fd);
+  free(file);
+}
+
+static size_t mapped_usable_size(void * ptr, void * context) {
+  const struct nb_mapped_file * file = context;
+  if (ptr != mapped_blocks(file)) return 0;
+  return file->mapping_size - NB_MAPPED_HEADER_SIZE;
+}
+
+static struct nb_mapped_file * mapped_file_of(struct nb_buffer * buffer) {
+  if (buffer->memory_context == NULL || buffer->memory_context->free_fn != mapped_release) return NULL;
+  return (struct nb_mapped_file *) buffer->memory_context;
+}
+
+static enum NB_MAP_RESULT map_file(struct nb_mapped_file * file, size_t block_size, unsigned flags) {
+  struct stat file_stat;
+  if (fstat(file->fd, &file_stat) != 0) return NB_MAP_IO_ERROR;
+
+  const size_t file_size = (size_t) file_stat.st_size;
+  const uint8_t is_new = file_size == 0 || (flags & NB_MAP_TRUNCATE);
+  if (!is_new && file_size < NB_MAPPED_HEADER_SIZE) return NB_MAP_INVALID_FILE;
+
+  file->mapping_size = is_new ? page_round(NB_MAPPED_HEADER_SIZE + block_size * 2) : file_size;
+  if (is_new && ftruncate(file->fd, 0) != 0) return NB_MAP_IO_ERROR;
+  if (is_new && ftruncate(file->fd, (off_t) file->mapping_size) != 0) return NB_MAP_IO_ERROR;
+
+  void * mapping = mmap(NULL, file->mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd, 0);
+  if (mapping == MAP_FAILED) return NB_MAP_OUT_OF_MEMORY;
+  file->mapping = mapping;
+
+  struct nb_mapped_file_header * header = mapped_file_header(file);
+  if (is_new) {
+    memcpy(header->magic, mapped_magic, sizeof(mapped_magic));
+    header->block_size = block_size;
+    header->block_count = 0;
+    return NB_MAP_OK;
+  }
+
+  const size_t block_capacity = (file->mapping_size - NB_MAPPED_HEADER_SIZE) / block_size;
+  if (memcmp(header->magic, mapped_magic, sizeof(mapped_magic)) != 0 || header->block_size != block_size ||
+      header->block_count > block_capacity) {
+    munmap(file->mapping, file->mapping_size);
+    return NB_MAP_INVALID_FILE;
+  }
+  return NB_MAP_OK;
+}
+
+enum NB_MAP_RESULT nb_init_mapped(struct nb_buffer * buffer, size_t block_size, const char * path, unsigned flags) {
+  if (block_size == 0) return NB_MAP_INVALID_FILE;
+
+  struct nb_mapped_file * file = malloc(sizeof(struct nb_mapped_file));
+  if (file == NULL) return NB_MAP_OUT_OF_MEMORY;
+
+  file->fd = open(path, O_RDWR | ((flags & NB_MAP_CREATE) ? O_CREAT : 0), 0644);
+  if (file->fd < 0) {
+    free(file);
+    return NB_MAP_IO_ERROR;
+  }
+
+  const enum NB_MAP_RESULT result = map_file(file, block_size, flags);
+  if (result != NB_MAP_OK) {
+    close(file->fd);
+    free(file);
+    return result;
+  }
+
+  file->buffer = buffer;
+  file->memory_context = (struct nb_buffer_memory_context) {
+    .alloc_fn = mapped_alloc,
+    .realloc_fn = mapped_realloc,
+    .free_fn = mapped_release,
+    .copy_fn = nb_memory_copy,
+    .move_fn = nb_memory_move,
+    .context = file,
+    .usable_size_fn = mapped_usable_size
+  };
+
+  buffer->block_size = block_size;
+  buffer->block_count = (size_t) mapped_file_header(file)->block_count;
+  buffer->block_capacity = (file->mapping_size - NB_MAPPED_HEADER_SIZE) / block_size;
+  buffer->memory_context = &file->memory_context;
+  buffer->block_offset = 0;
+  buffer->sorted_count = 0;
+  buffer->uses_inline_storage = 0;
+  buffer->data = mapped_blocks(file);
+  return NB_MAP_OK;
+}
+
+enum NB_SYNC_RESULT nb_sync(struct nb_buffer * buffer) {
+  struct nb_mapped_file * file = mapped_file_of(buffer);
+  if (file == NULL) return NB_SYNC_OK;
+
+  mapped_store_blocks(file);
+  const size_t used_size = page_round(NB_MAPPED_HEADER_SIZE + buffer->block_count * buffer->block_size);
+  if (msync(file->mapping, used_size, MS_SYNC) != 0) return NB_SYNC_IO_ERROR;
+  return NB_SYNC_OK;
+}
+#endif
@@ -0,0 +1,90 @@
+#include "naughty-buffers/arena.h"
+#include <assert.h>
+
+#define assert_eq(a, b) assert((a) == (b))
+
+void arena_buffers_work() {
+  struct nb_arena * arena = nb_arena_create(1024);
+  struct nb_buffer buffer_a;
+  struct nb_buffer buffer_b;
+
+  nb_init_advanced(&buffer_a, sizeof(uint32_t), nb_arena_memory_context(arena));
+  nb_init_advanced(&buffer_b, sizeof(uint32_t), nb_arena_memory_context(arena));
+
+  for (uint32_t i = 0; i < 1000; i++) {
+    nb_push(&buffer_a, &i);
+    uint32_t value = i * 2;
+    nb_push(&buffer_b, &value);
+  }
+
+  for (uint32_t i = 0; i < 1000; i++) {
+    assert_eq(*(uint32_t *)nb_at(&buffer_a, i), i);
+    assert_eq(*(uint32_t *)nb_at(&buffer_b, i), i * 2);
+  }
+
+  nb_arena_destroy(arena);
+}
+
+void arena_realloc_of_last_allocation_grows_in_place() {
+  struct nb_arena * arena = nb_arena_create(64 * 1024);
+  struct nb_buffer buffer;
+
+  nb_init_advanced(&buffer, sizeof(uint32_t), nb_arena_memory_context(arena));
+  void * data = buffer.data;
+  for (uint32_t i = 0; i < 1000; i++) nb_push(&buffer, &i);
+  assert(buffer.data == data);
+  assert(nb_arena_used(arena) < 64 * 1024);
+
+  nb_arena_destroy(arena);
+}
+
+void arena_release_of_last_allocation_gives_memory_back() {
+  struct nb_arena * arena = nb_arena_create(1024);
+  struct nb_buffer buffer;
+
+  nb_init_advanced(&buffer, sizeof(uint32_t), nb_arena_memory_context(arena));
+  assert(nb_arena_used(arena) > 0);
+  nb_release(&buffer);
+  assert_eq(nb_arena_used(arena), 0);
+
+  nb_arena_destroy(arena);
+}
+
+void arena_reset_frees_everything_and_reuses_chunks() {
+  struct nb_arena * arena = nb_arena_create(256);
+  struct nb_buffer buffer;
+
+  for (int round = 0; round < 10; round++) {
+    nb_init_advanced(&buffer, sizeof(uint64_t), nb_arena_memory_context(arena));
+    for (uint64_t i = 0; i < 500; i++) nb_push(&buffer, &i);
+    for (uint64_t i = 0; i < 500; i++) assert_eq(*(uint64_t *)nb_at(&buffer, i), i);
+    assert(nb_arena_used(arena) >= 500 * sizeof(uint64_t));
+
+    nb_arena_reset(arena);
+    assert_eq(nb_arena_used(arena), 0);
+  }
+
+  nb_arena_destroy(arena);
+}
+
+void arena_allocations_are_aligned() {
+  struct nb_arena * arena = nb_arena_create(1024);
+  struct nb_buffer_memory_context * ctx = nb_arena_memory_context(arena);
+
+  for (size_t size = 1; size < 100; size += 7) {
+    void * ptr = ctx->alloc_fn(size, ctx->context);
+    assert_eq((uintptr_t)ptr % 16, 0);
+  }
+
+  nb_arena_destroy(arena);
+}
+
+int main(void) {
+  arena_buffers_work();
+  arena_realloc_of_last_allocation_grows_in_place();
+  arena_release_of_last_allocation_gives_memory_back();
+  arena_reset_frees_everything_and_reuses_chunks();
+  arena_allocations_are_aligned();
+
+  return 0;
+}
@@ -18,6 +18,15 @@ int nb_test_compare(const void * ptr_a, const void * ptr_b) {
 NAUGHTY_BUFFERS_ARRAY_DECLARATION(test_array, struct nb_test)
 NAUGHTY_BUFFERS_ARRAY_DEFINITION(test_array, struct nb_test)
 
+NAUGHTY_BUFFERS_INLINE_ARRAY_DECLARATION(inline_test_array, struct nb_test, 4)
+NAUGHTY_BUFFERS_INLINE_ARRAY_DEFINITION(inline_test_array, struct nb_test, 4)
+
+NAUGHTY_BUFFERS_ARRAY_SORT_DECLARATION(test_array, struct nb_test)
+NAUGHTY_BUFFERS_ARRAY_SORT_DEFINITION(test_array, struct nb_test, a->value < b->value)
+
+NAUGHTY_BUFFERS_ARRAY_SEARCH_DECLARATION(test_array, struct nb_test)
+NAUGHTY_BUFFERS_ARRAY_SEARCH_DEFINITION(test_array, struct nb_test, a->value < b->value)
+
 #define assert_eq(a, b) assert((a) == (b))
 
 void * nb_test_alloc(size_t size, void * _) {
@@ -117,6 +126,109 @@ void array_generator_push_ptr_adds_correct_values_not_pointers() {
   test_array_release(&test_array);
 }
 
+void array_generator_push_many_and_pop_many_work() {
+  struct test_array test_array;
+  struct nb_test tests[4] = {{.value = 10}, {.value = 20}, {.value = 30}, {.value = 40}};
+  struct nb_test popped[2];
+  test_array_init(&test_array);
+
+  test_array_push_many(&test_array, tests, 4);
+  assert(test_array_count(&test_array) == 4);
+  assert(test_array_at_ptr(&test_array, 3)->value == 40);
+
+  const size_t popped_count = test_array_pop_many(&test_array, popped, 2);
+  assert(popped_count == 2);
+  assert(test_array_count(&test_array) == 2);
+  assert(popped[0].value == 30);
+  assert(popped[1].value == 40);
+
+  test_array_release(&test_array);
+}
+
+void array_generator_push_front_and_pop_front_work() {
+  struct test_array test_array;
+  struct nb_test test = {.value = 10};
+  test_array_init(&test_array);
+
+  test_array_push(&test_array, test);
+  test.value = 20;
+  test_array_push_front(&test_array, test);
+  assert(test_array_front(&test_array).value == 20);
+
+  enum NB_POP_RESULT result = test_array_pop_front(&test_array, &test);
+  assert(result == NB_POP_OK);
+  assert(test.value == 20);
+  result = test_array_pop_back(&test_array, &test);
+  assert(result == NB_POP_OK);
+  assert(test.value == 10);
+  result = test_array_pop_back(&test_array, &test);
+  assert(result == NB_POP_EMPTY);
+
+  test_array_release(&test_array);
+}
+
+int array_generator_is_even(const void * block, void * context) {
+  (void)context;
+  return ((const struct nb_test *)block)->value % 2 == 0;
+}
+
+void array_generator_remove_range_if_and_indices_work() {
+  struct test_array test_array;
+  test_array_init(&test_array);
+  for (long i = 0; i < 10; i++) test_array_push(&test_array, (struct nb_test){.value = i});
+
+  size_t removed = test_array_remove_range(&test_array, 0, 2);
+  assert(removed == 2);
+  assert(test_array_front(&test_array).value == 2);
+  removed = test_array_remove_if(&test_array, array_generator_is_even, NULL);
+  assert(removed == 4);
+  assert(test_array_count(&test_array) == 4);
+  assert(test_array_at(&test_array, 0).value == 3);
+
+  const size_t indices[] = {1, 2};
+  removed = test_array_remove_indices(&test_array, indices, 2);
+  assert(removed == 2);
+  assert(test_array_at(&test_array, 0).value == 3);
+  assert(test_array_at(&test_array, 1).value == 9);
+
+  test_array_release(&test_array);
+}
+
+void array_generator_insert_many_and_insert_batch_work() {
+  struct test_array test_array;
+  struct nb_test tests[2] = {{.value = 10}, {.value = 20}};
+  test_array_init(&test_array);
+
+  test_array_insert_many(&test_array, 0, tests, 2);
+  const size_t indices[2] = {1, 2};
+  test_array_insert_batch(&test_array, indices, tests, 2);
+  assert(test_array_count(&test_array) == 4);
+  assert(test_array_at(&test_array, 0).value == 10);
+  assert(test_array_at(&test_array, 1).value == 10);
+  assert(test_array_at(&test_array, 2).value == 20);
+  assert(test_array_at(&test_array, 3).value == 20);
+
+  test_array_release(&test_array);
+}
+
+void array_generator_emplace_and_swap_remove_work() {
+  struct test_array test_array;
+  test_array_init(&test_array);
+
+  test_array_emplace_back(&test_array)->value = 10;
+  struct nb_test * tests = test_array_push_uninit(&test_array, 2);
+  tests[0].value = 20;
+  tests[1].value = 30;
+  assert(test_array_count(&test_array) == 3);
+
+  test_array_swap_remove(&test_array, 0);
+  assert(test_array_count(&test_array) == 2);
+  assert(test_array_at(&test_array, 0).value == 30);
+  assert(test_array_at(&test_array, 1).value == 20);
+
+  test_array_release(&test_array);
+}
+
 void array_generator_assign_ptr_adds_correct_values_not_pointers() {
   struct test_array test_array;
   struct nb_test test = {.value = 10};
@@ -282,6 +394,56 @@ void array_generator_sort_sorts() {
   test_array_release(&test_array);
 }
 
+void array_generator_introsort_sorts() {
+  struct test_array test_array;
+  test_array_init(&test_array);
+
+  // sorted, reversed, few distinct values and random ones, long enough to go through every part of the sort
+  const size_t count = 20000;
+  for (int round = 0; round < 4; round++) {
+    srand(round);
+    for (size_t i = 0; i < count; i++) {
+      long value = round == 0 ? (long)i : round == 1 ? (long)(count - i) : round == 2 ? rand() % 3 : rand();
+      struct nb_test test = {.value = value};
+      test_array_push_ptr(&test_array, &test);
+    }
+
+    test_array_introsort(&test_array);
+    assert_eq(test_array_count(&test_array), count);
+    for (size_t i = 1; i < count; i++) {
+      assert(test_array_at_ptr(&test_array, i - 1)->value <= test_array_at_ptr(&test_array, i)->value);
+    }
+    test_array_remove_range(&test_array, 0, count);
+  }
+
+  test_array_introsort(&test_array);
+  test_array_release(&test_array);
+}
+
+void array_generator_search_works() {
+  struct test_array test_array;
+  test_array_init(&test_array);
+
+  // 0, 0, 3, 3, 6, 6, ... inserted out of order
+  for (long i = 29; i >= 0; i--) {
+    struct nb_test test = {.value = (i / 2) * 3};
+    const enum NB_INSERT_RESULT result = test_array_insert_sorted(&test_array, test);
+    assert_eq(result, NB_INSERT_OK);
+  }
+
+  for (long value = -1; value <= 46; value++) {
+    struct nb_test key = {.value = value};
+    const size_t lower = (size_t)((value + 2) / 3) * 2;
+    const size_t upper = value >= 0 && value % 3 == 0 ? lower + 2 : lower;
+    assert_eq(test_array_lower_bound(&test_array, &key), value < 0 ? 0 : (lower > 30 ? 30 : lower));
+    assert_eq(test_array_upper_bound(&test_array, &key), value < 0 ? 0 : (upper > 30 ? 30 : upper));
+    const struct nb_index_range range = test_array_equal_range(&test_array, &key);
+    assert_eq(range.end - range.first, value >= 0 && value % 3 == 0 && value <= 42 ? 2 : 0);
+  }
+
+  test_array_release(&test_array);
+}
+
 void array_generator_remove_decreases_count_correctly() {
   struct test_array test_array;
   struct nb_test test = {.value = 0};
@@ -358,19 +520,48 @@ void array_generator_remove_keeps_values_and_ordering() {
   test_array_release(&test_array);
 }
 
+void array_generator_inline_array_works() {
+  struct inline_test_array test_array;
+  struct nb_test test;
+  inline_test_array_init(&test_array);
+
+  for (long i = 0; i < 4; i++) {
+    test.value = i;
+    inline_test_array_push(&test_array, test);
+  }
+  assert(nb_is_inline(&test_array.buffer));
+  assert(inline_test_array_at_ptr(&test_array, 0) == &test_array.inline_blocks[0]);
+
+  test.value = 4;
+  inline_test_array_push(&test_array, test);
+  assert(!nb_is_inline(&test_array.buffer));
+
+  for (long i = 0; i < 5; i++) assert_eq(inline_test_array_at(&test_array, i).value, i);
+
+  inline_test_array_release(&test_array);
+}
+
 int main(void) {
   array_generator_init_works();
   array_generator_init_advanced_works();
   array_generator_push_adds_correct_values();
   array_generator_push_ptr_adds_correct_values_not_pointers();
+  array_generator_push_many_and_pop_many_work();
+  array_generator_push_front_and_pop_front_work();
+  array_generator_remove_range_if_and_indices_work();
+  array_generator_insert_many_and_insert_batch_work();
+  array_generator_emplace_and_swap_remove_work();
   array_generator_assign_ptr_adds_correct_values_not_pointers();
   array_generator_assign_adds_correct_values();
   array_generator_insert_ptr_adds_correct_values_not_pointers();
   array_generator_insert_adds_correct_values();
   array_generator_automatic_growth();
   array_generator_sort_sorts();
+  array_generator_introsort_sorts();
+  array_generator_search_works();
   array_generator_remove_decreases_count_correctly();
   array_generator_remove_keeps_values_and_ordering();
+  array_generator_inline_array_works();
 
   return 0;
 }
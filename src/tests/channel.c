@@ -0,0 +1,213 @@
+#include "naughty-buffers/channel.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "test-thread.h"
+
+#define assert_eq(a, b) assert((a) == (b))
+
+void channel_keeps_blocks_in_order() {
+  struct nb_channel * channel = nb_channel_create(sizeof(int), 3);
+  assert(channel != NULL);
+  assert_eq(nb_channel_capacity(channel), 4);
+
+  int value = 0;
+  enum NB_RECEIVE_RESULT receive_result = nb_channel_receive(channel, &value, 0);
+  assert_eq(receive_result, NB_RECEIVE_TIMEOUT);
+  enum NB_SEND_RESULT send_result;
+  for (int i = 0; i < 4; i++) {
+    send_result = nb_channel_send(channel, &i, 0);
+    assert_eq(send_result, NB_SEND_OK);
+  }
+  value = 4;
+  send_result = nb_channel_send(channel, &value, 0);
+  assert_eq(send_result, NB_SEND_TIMEOUT);
+
+  for (int i = 0; i < 4; i++) {
+    receive_result = nb_channel_receive(channel, &value, 0);
+    assert_eq(receive_result, NB_RECEIVE_OK);
+    assert_eq(value, i);
+  }
+  receive_result = nb_channel_receive(channel, &value, 0);
+  assert_eq(receive_result, NB_RECEIVE_TIMEOUT);
+
+  nb_channel_destroy(channel);
+}
+
+void channel_batches_wrap_around() {
+  struct nb_channel * channel = nb_channel_create(sizeof(int), 8);
+  int in[20];
+  int out[20];
+  for (int i = 0; i < 20; i++) in[i] = i;
+
+  size_t moved = nb_channel_send_many(channel, in, 5, 0);
+  assert_eq(moved, 5);
+  moved = nb_channel_receive_many(channel, out, 5, 0);
+  assert_eq(moved, 5);
+
+  // only 8 fit, the rest time out right away
+  moved = nb_channel_send_many(channel, in, 20, 0);
+  assert_eq(moved, 8);
+  moved = nb_channel_receive_many(channel, out, 3, 0);
+  assert_eq(moved, 3);
+  for (int i = 0; i < 3; i++) assert_eq(out[i], i);
+
+  moved = nb_channel_send_many(channel, in + 8, 12, 0);
+  assert_eq(moved, 3);
+  moved = nb_channel_receive_many(channel, out, 20, 0);
+  assert_eq(moved, 8);
+  for (int i = 0; i < 8; i++) assert_eq(out[i], i + 3);
+  moved = nb_channel_receive_many(channel, out, 20, 0);
+  assert_eq(moved, 0);
+  moved = nb_channel_receive_many(channel, out, 0, NB_CHANNEL_WAIT_FOREVER);
+  assert_eq(moved, 0);
+
+  nb_channel_destroy(channel);
+}
+
+void channel_waits_until_the_timeout() {
+  struct nb_channel * channel = nb_channel_create(sizeof(int), 1);
+  int value = 1;
+  assert_eq(nb_channel_capacity(channel), 2);
+
+  unsigned long long start = test_clock_ms();
+  const enum NB_RECEIVE_RESULT receive_result = nb_channel_receive(channel, &value, 50);
+  assert_eq(receive_result, NB_RECEIVE_TIMEOUT);
+  assert(test_clock_ms() - start >= 49);
+
+  const size_t sent = nb_channel_send_many(channel, &value, 1, 0);
+  assert_eq(sent, 1);
+  enum NB_SEND_RESULT send_result = nb_channel_send(channel, &value, 50);
+  assert_eq(send_result, NB_SEND_OK);
+  start = test_clock_ms();
+  send_result = nb_channel_send(channel, &value, 50);
+  assert_eq(send_result, NB_SEND_TIMEOUT);
+  assert(test_clock_ms() - start >= 49);
+  assert(test_clock_ms() - start < 5000);
+
+  nb_channel_destroy(channel);
+}
+
+void closed_channels_are_drained() {
+  struct nb_channel * channel = nb_channel_create(sizeof(int), 8);
+  int value = 7;
+
+  enum NB_SEND_RESULT send_result = nb_channel_send(channel, &value, 0);
+  assert_eq(send_result, NB_SEND_OK);
+  nb_channel_close(channel);
+  nb_channel_close(channel);
+
+  send_result = nb_channel_send(channel, &value, NB_CHANNEL_WAIT_FOREVER);
+  assert_eq(send_result, NB_SEND_CLOSED);
+  const size_t sent = nb_channel_send_many(channel, &value, 1, 0);
+  assert_eq(sent, 0);
+
+  value = 0;
+  enum NB_RECEIVE_RESULT receive_result = nb_channel_receive(channel, &value, NB_CHANNEL_WAIT_FOREVER);
+  assert_eq(receive_result, NB_RECEIVE_OK);
+  assert_eq(value, 7);
+  receive_result = nb_channel_receive(channel, &value, NB_CHANNEL_WAIT_FOREVER);
+  assert_eq(receive_result, NB_RECEIVE_CLOSED);
+  const size_t received = nb_channel_receive_many(channel, &value, 1, NB_CHANNEL_WAIT_FOREVER);
+  assert_eq(received, 0);
+
+  nb_channel_destroy(channel);
+}
+
+#define PRODUCERS 4
+#define CONSUMERS 4
+#define MESSAGES_PER_PRODUCER 100000
+
+struct message {
+  uint32_t producer;
+  uint32_t sequence;
+};
+
+struct worker {
+  struct nb_channel * channel;
+  uint32_t id;
+  uint8_t * seen;
+  size_t received;
+};
+
+static void produce(void * argument) {
+  struct worker * worker = argument;
+  struct message batch[5];
+  uint32_t sequence = 0;
+
+  while (sequence < MESSAGES_PER_PRODUCER) {
+    // odd producers send in batches, even ones one message at a time
+    const uint32_t count = worker->id % 2 == 0 ? 1 : 5;
+    for (uint32_t i = 0; i < count; i++) batch[i] = (struct message) {worker->id, sequence + i};
+    size_t sent;
+    if (count == 1) sent = nb_channel_send(worker->channel, batch, NB_CHANNEL_WAIT_FOREVER) == NB_SEND_OK;
+    else sent = nb_channel_send_many(worker->channel, batch, count, NB_CHANNEL_WAIT_FOREVER);
+    assert_eq(sent, count);
+    sequence += count;
+  }
+}
+
+static void consume(void * argument) {
+  struct worker * worker = argument;
+  struct message batch[3];
+
+  for (;;) {
+    size_t count;
+    if (worker->id % 2 == 0) {
+      count = nb_channel_receive(worker->channel, batch, NB_CHANNEL_WAIT_FOREVER) == NB_RECEIVE_OK;
+    } else {
+      count = nb_channel_receive_many(worker->channel, batch, 3, NB_CHANNEL_WAIT_FOREVER);
+    }
+    if (count == 0) return;
+
+    for (size_t i = 0; i < count; i++) {
+      assert(batch[i].producer < PRODUCERS);
+      assert(batch[i].sequence < MESSAGES_PER_PRODUCER);
+      worker->seen[(size_t) batch[i].producer * MESSAGES_PER_PRODUCER + batch[i].sequence]++;
+    }
+    worker->received += count;
+  }
+}
+
+void producers_and_consumers_share_the_channel() {
+  struct nb_channel * channel = nb_channel_create(sizeof(struct message), 64);
+  struct worker workers[PRODUCERS + CONSUMERS];
+  struct test_call calls[PRODUCERS + CONSUMERS];
+  test_thread threads[PRODUCERS + CONSUMERS];
+  const size_t total = (size_t) PRODUCERS * MESSAGES_PER_PRODUCER;
+
+  for (uint32_t i = 0; i < PRODUCERS + CONSUMERS; i++) {
+    const int producer = i < PRODUCERS;
+    workers[i] = (struct worker) {channel, producer ? i : i - PRODUCERS, producer ? NULL : calloc(total, 1), 0};
+    calls[i] = (struct test_call) {producer ? produce : consume, &workers[i]};
+    test_thread_start(&threads[i], &calls[i]);
+  }
+
+  for (uint32_t i = 0; i < PRODUCERS; i++) test_thread_join(threads[i]);
+  nb_channel_close(channel);
+  for (uint32_t i = PRODUCERS; i < PRODUCERS + CONSUMERS; i++) test_thread_join(threads[i]);
+
+  // every message was received exactly once, by one of the consumers
+  size_t received = 0;
+  for (uint32_t i = PRODUCERS; i < PRODUCERS + CONSUMERS; i++) received += workers[i].received;
+  assert_eq(received, total);
+  for (size_t message = 0; message < total; message++) {
+    size_t times = 0;
+    for (uint32_t i = PRODUCERS; i < PRODUCERS + CONSUMERS; i++) times += workers[i].seen[message];
+    assert_eq(times, 1);
+  }
+
+  for (uint32_t i = PRODUCERS; i < PRODUCERS + CONSUMERS; i++) free(workers[i].seen);
+  nb_channel_destroy(channel);
+}
+
+int main(void) {
+  channel_keeps_blocks_in_order();
+  channel_batches_wrap_around();
+  channel_waits_until_the_timeout();
+  closed_channels_are_drained();
+  producers_and_consumers_share_the_channel();
+
+  return 0;
+}
@@ -0,0 +1,110 @@
+#include "naughty-buffers/compact-buffer.h"
+#include <assert.h>
+
+#define assert_eq(a, b) assert((a) == (b))
+
+void compact_buffer_is_small() {
+  assert(sizeof(struct nb_compact_buffer) <= sizeof(void *) + 2 * sizeof(uint32_t));
+}
+
+void compact_buffer_init_does_not_allocate() {
+  struct nb_compact_buffer buffer;
+  nb_compact_init(&buffer);
+  assert(buffer.data == NULL);
+  assert_eq(nb_compact_block_count(&buffer), 0);
+}
+
+void compact_buffer_push_and_at_work() {
+  struct nb_compact_context context;
+  struct nb_compact_buffer buffer;
+  nb_compact_context_init(&context, sizeof(uint32_t));
+  nb_compact_init(&buffer);
+
+  for (uint32_t i = 0; i < 100; i++) {
+    const enum NB_PUSH_RESULT result = nb_compact_push(&context, &buffer, &i);
+    assert_eq(result, NB_PUSH_OK);
+  }
+  assert_eq(nb_compact_block_count(&buffer), 100);
+  for (uint32_t i = 0; i < 100; i++) assert_eq(*(uint32_t *)nb_compact_at(&context, &buffer, i), i);
+  assert(nb_compact_at(&context, &buffer, 100) == NULL);
+
+  uint32_t values[] = {100, 101, 102};
+  nb_compact_push_many(&context, &buffer, values, 3);
+  assert_eq(nb_compact_block_count(&buffer), 103);
+  assert_eq(*(uint32_t *)nb_compact_at(&context, &buffer, 102), 102);
+
+  nb_compact_release(&context, &buffer);
+  assert_eq(nb_compact_block_count(&buffer), 0);
+}
+
+void compact_buffer_assign_insert_and_remove_work() {
+  struct nb_compact_context context;
+  struct nb_compact_buffer buffer;
+  nb_compact_context_init(&context, sizeof(uint32_t));
+  nb_compact_init(&buffer);
+
+  uint32_t value = 5;
+  nb_compact_assign(&context, &buffer, 5, &value);
+  assert_eq(nb_compact_block_count(&buffer), 6);
+  assert_eq(*(uint32_t *)nb_compact_at(&context, &buffer, 5), 5);
+
+  value = 1;
+  nb_compact_insert(&context, &buffer, 0, &value);
+  assert_eq(nb_compact_block_count(&buffer), 7);
+  assert_eq(*(uint32_t *)nb_compact_at(&context, &buffer, 0), 1);
+  assert_eq(*(uint32_t *)nb_compact_at(&context, &buffer, 6), 5);
+
+  nb_compact_remove_at(&context, &buffer, 0);
+  assert_eq(nb_compact_block_count(&buffer), 6);
+  assert_eq(*(uint32_t *)nb_compact_at(&context, &buffer, 5), 5);
+
+  nb_compact_release(&context, &buffer);
+}
+
+void compact_buffer_iterator_works() {
+  struct nb_compact_context context;
+  struct nb_compact_buffer buffer;
+  nb_compact_context_init(&context, sizeof(uint32_t));
+  nb_compact_init(&buffer);
+
+  const enum NB_RESERVE_RESULT result = nb_compact_reserve(&context, &buffer, 50);
+  assert_eq(result, NB_RESERVE_OK);
+  assert(buffer.block_capacity >= 50);
+
+  for (uint32_t i = 0; i < 50; i++) nb_compact_push(&context, &buffer, &i);
+
+  struct nb_buffer_iterator itr = nb_compact_iterator(&context, &buffer);
+  uint32_t expected = 0;
+  for (uint8_t * block = itr.begin; block != itr.end; block += itr.increment) {
+    assert_eq(*(uint32_t *)block, expected);
+    expected++;
+  }
+  assert_eq(expected, 50);
+
+  nb_compact_release(&context, &buffer);
+}
+
+void compact_buffer_accepts_empty_blocks() {
+  struct nb_compact_context context;
+  struct nb_compact_buffer buffer;
+  nb_compact_context_init(&context, 0);
+  nb_compact_init(&buffer);
+
+  uint8_t value = 0;
+  const enum NB_PUSH_RESULT result = nb_compact_push(&context, &buffer, &value);
+  assert_eq(result, NB_PUSH_OK);
+  assert_eq(nb_compact_block_count(&buffer), 1);
+
+  nb_compact_release(&context, &buffer);
+}
+
+int main(void) {
+  compact_buffer_is_small();
+  compact_buffer_init_does_not_allocate();
+  compact_buffer_push_and_at_work();
+  compact_buffer_assign_insert_and_remove_work();
+  compact_buffer_iterator_works();
+  compact_buffer_accepts_empty_blocks();
+
+  return 0;
+}
@@ -0,0 +1,241 @@
+#include "naughty-buffers/concurrent-buffer.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test-thread.h"
+
+#define assert_eq(a, b) assert((a) == (b))
+
+struct record {
+  uint32_t producer;
+  uint32_t sequence;
+  uint64_t check;
+};
+
+static uint64_t record_check(uint32_t producer, uint32_t sequence) {
+  return ((uint64_t) producer << 32 | sequence) * 0x9E3779B97F4A7C15ull;
+}
+
+void watermark_waits_for_earlier_blocks() {
+  struct nb_concurrent_buffer * buffer = nb_concurrent_buffer_create(sizeof(int));
+  size_t indices[3];
+  int * blocks[3];
+
+  for (int i = 0; i < 3; i++) {
+    blocks[i] = nb_concurrent_reserve(buffer, &indices[i]);
+    assert(blocks[i] != NULL);
+    assert_eq(indices[i], (size_t) i);
+    *blocks[i] = i * 10;
+  }
+  assert_eq(nb_concurrent_published_count(buffer), 0);
+  assert(nb_concurrent_at(buffer, 0) == NULL);
+
+  nb_concurrent_publish(buffer, indices[2]);
+  assert_eq(nb_concurrent_published_count(buffer), 0);
+  nb_concurrent_publish(buffer, indices[0]);
+  assert_eq(nb_concurrent_published_count(buffer), 1);
+  nb_concurrent_publish(buffer, indices[1]);
+  assert_eq(nb_concurrent_published_count(buffer), 3);
+  const size_t published = nb_concurrent_wait_published(buffer, 3);
+  assert_eq(published, 3);
+
+  for (int i = 0; i < 3; i++) assert_eq(*(int *) nb_concurrent_at(buffer, (size_t) i), i * 10);
+  assert(nb_concurrent_at(buffer, 3) == NULL);
+
+  nb_concurrent_buffer_destroy(buffer);
+}
+
+void blocks_never_move() {
+  struct nb_concurrent_buffer * buffer = nb_concurrent_buffer_create(sizeof(int));
+  int values[100];
+  for (int i = 0; i < 100; i++) values[i] = i;
+
+  enum NB_PUSH_RESULT result = nb_concurrent_push(buffer, &values[0]);
+  assert_eq(result, NB_PUSH_OK);
+  int * first = nb_concurrent_at(buffer, 0);
+
+  // batches of 100 keep crossing the end of segments
+  for (int round = 0; round < 1000; round++) {
+    result = nb_concurrent_push_many(buffer, values, 100);
+    assert_eq(result, NB_PUSH_OK);
+  }
+  result = nb_concurrent_push_many(buffer, values, 0);
+  assert_eq(result, NB_PUSH_OK);
+
+  assert_eq(nb_concurrent_published_count(buffer), 100001);
+  assert(nb_concurrent_at(buffer, 0) == first);
+  for (size_t i = 1; i < 100001; i++) assert_eq(*(int *) nb_concurrent_at(buffer, i), (int) ((i - 1) % 100));
+
+  nb_concurrent_buffer_destroy(buffer);
+}
+
+// fails every allocation while the int its context points to is not 0
+void * failing_alloc(size_t size, void * context) {
+  if (*(int *) context) return NULL;
+  return malloc(size);
+}
+
+void * failing_realloc(void * ptr, size_t size, void * context) {
+  if (*(int *) context) return NULL;
+  return realloc(ptr, size);
+}
+
+void failing_release(void * ptr, void * context) {
+  (void) context;
+  free(ptr);
+}
+
+void * failing_copy(void * destination, const void * source, size_t size, void * context) {
+  (void) context;
+  return memcpy(destination, source, size);
+}
+
+void * failing_move(void * destination, const void * source, size_t size, void * context) {
+  (void) context;
+  return memmove(destination, source, size);
+}
+
+void failed_allocations_do_not_stop_the_watermark() {
+  int failing = 0;
+  struct nb_buffer_memory_context memory_context = {
+      .alloc_fn = failing_alloc,
+      .realloc_fn = failing_realloc,
+      .free_fn = failing_release,
+      .copy_fn = failing_copy,
+      .move_fn = failing_move,
+      .context = &failing
+  };
+  struct nb_concurrent_buffer * buffer = nb_concurrent_buffer_create_advanced(sizeof(int), &memory_context);
+
+  // the first segment holds 1024 blocks, so the last 4 of this batch land in the second one
+  int values[1028];
+  for (int i = 0; i < 1028; i++) values[i] = i;
+  size_t index;
+  int * block = nb_concurrent_reserve(buffer, &index);
+  *block = -1;
+
+  failing = 1;
+  enum NB_PUSH_RESULT result = nb_concurrent_push_many(buffer, values, 1028);
+  assert_eq(result, NB_PUSH_OUT_OF_MEMORY);
+  block = nb_concurrent_reserve(buffer, &index);
+  assert(block == NULL);
+
+  // the lost blocks wait for the first one like any other, then the watermark moves past them
+  assert_eq(nb_concurrent_published_count(buffer), 0);
+  nb_concurrent_publish(buffer, 0);
+  size_t published = nb_concurrent_wait_published(buffer, 1030);
+  assert_eq(published, 1030);
+  assert_eq(*(int *) nb_concurrent_at(buffer, 0), -1);
+  for (size_t i = 1; i < 1030; i++) assert(nb_concurrent_at(buffer, i) == NULL);
+
+  // the second segment stays lost, so the next blocks start in the third one
+  failing = 0;
+  for (size_t i = 1030; i < 1024 + 2048; i++) {
+    result = nb_concurrent_push(buffer, &values[0]);
+    assert_eq(result, NB_PUSH_OUT_OF_MEMORY);
+  }
+  result = nb_concurrent_push_many(buffer, values, 3);
+  assert_eq(result, NB_PUSH_OK);
+  published = nb_concurrent_wait_published(buffer, 1024 + 2048 + 3);
+  assert_eq(published, 1024 + 2048 + 3);
+  for (size_t i = 1030; i < 1024 + 2048; i++) assert(nb_concurrent_at(buffer, i) == NULL);
+  for (int i = 0; i < 3; i++) assert_eq(*(int *) nb_concurrent_at(buffer, (size_t) (1024 + 2048 + i)), i);
+
+  nb_concurrent_buffer_destroy(buffer);
+}
+
+#define PRODUCERS 4
+#define RECORDS_PER_PRODUCER 200000
+
+struct producer {
+  struct nb_concurrent_buffer * buffer;
+  uint32_t id;
+};
+
+// mixes the three ways of appending so they race with each other
+static void produce(void * argument) {
+  struct producer * producer = argument;
+  struct record batch[7];
+  uint32_t sequence = 0;
+
+  while (sequence < RECORDS_PER_PRODUCER) {
+    const uint32_t mode = sequence % 3;
+    if (mode == 0) {
+      size_t index;
+      struct record * record = nb_concurrent_reserve(producer->buffer, &index);
+      assert(record != NULL);
+      *record = (struct record) {producer->id, sequence, record_check(producer->id, sequence)};
+      nb_concurrent_publish(producer->buffer, index);
+      sequence++;
+    } else if (mode == 1) {
+      struct record record = {producer->id, sequence, record_check(producer->id, sequence)};
+      const enum NB_PUSH_RESULT result = nb_concurrent_push(producer->buffer, &record);
+      assert_eq(result, NB_PUSH_OK);
+      sequence++;
+    } else {
+      uint32_t count = RECORDS_PER_PRODUCER - sequence < 7 ? RECORDS_PER_PRODUCER - sequence : 7;
+      for (uint32_t i = 0; i < count; i++) {
+        batch[i] = (struct record) {producer->id, sequence + i, record_check(producer->id, sequence + i)};
+      }
+      const enum NB_PUSH_RESULT result = nb_concurrent_push_many(producer->buffer, batch, count);
+      assert_eq(result, NB_PUSH_OK);
+      sequence += count;
+    }
+  }
+}
+
+void producers_append_concurrently() {
+  struct nb_concurrent_buffer * buffer = nb_concurrent_buffer_create(sizeof(struct record));
+  struct producer producers[PRODUCERS];
+  struct test_call calls[PRODUCERS];
+  test_thread threads[PRODUCERS];
+
+  for (uint32_t p = 0; p < PRODUCERS; p++) {
+    producers[p] = (struct producer) {buffer, p};
+    calls[p] = (struct test_call) {produce, &producers[p]};
+    test_thread_start(&threads[p], &calls[p]);
+  }
+
+  // reads blocks as soon as they are published: each one must be fully written and be the next record of its
+  // producer, since each producer reserves its blocks in order
+  uint32_t next_sequence[PRODUCERS] = {0};
+  const size_t total = (size_t) PRODUCERS * RECORDS_PER_PRODUCER;
+  size_t read = 0;
+  while (read < total) {
+    const size_t published = nb_concurrent_wait_published(buffer, read + 1);
+    for (; read < published; read++) {
+      const struct record * record = nb_concurrent_at(buffer, read);
+      assert(record != NULL);
+      assert(record->producer < PRODUCERS);
+      assert_eq(record->sequence, next_sequence[record->producer]);
+      assert_eq(record->check, record_check(record->producer, record->sequence));
+      next_sequence[record->producer] = record->sequence + 1;
+    }
+  }
+
+  for (uint32_t p = 0; p < PRODUCERS; p++) test_thread_join(threads[p]);
+  assert_eq(nb_concurrent_published_count(buffer), total);
+
+  // every record is there exactly once
+  uint8_t * seen = calloc(total, 1);
+  for (size_t i = 0; i < total; i++) {
+    const struct record * record = nb_concurrent_at(buffer, i);
+    const size_t slot = (size_t) record->producer * RECORDS_PER_PRODUCER + record->sequence;
+    assert_eq(seen[slot], 0);
+    seen[slot] = 1;
+  }
+  free(seen);
+
+  nb_concurrent_buffer_destroy(buffer);
+}
+
+int main(void) {
+  watermark_waits_for_earlier_blocks();
+  blocks_never_move();
+  failed_allocations_do_not_stop_the_watermark();
+  producers_append_concurrently();
+
+  return 0;
+}
@@ -0,0 +1,190 @@
+#include "naughty-buffers/buffer.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+size_t move_call_count = 0;
+
+void * nb_test_move(void * destination, const void * source, size_t size, void * _) {
+  (void)_;
+  move_call_count++;
+  return memmove(destination, source, size);
+}
+
+void * nb_test_alloc(size_t size, void * _) {
+  (void)_;
+  return malloc(size);
+}
+
+void * nb_test_realloc(void * ptr, size_t size, void * _) {
+  (void)_;
+  return realloc(ptr, size);
+}
+
+void * nb_test_copy(void * destination, const void * source, size_t size, void * _) {
+  (void)_;
+  return memcpy(destination, source, size);
+}
+
+void nb_test_release(void * ptr, void * _) {
+  (void)_;
+  free(ptr);
+}
+
+struct nb_buffer_memory_context ctx = {
+    .move_fn = nb_test_move,
+    .alloc_fn = nb_test_alloc,
+    .realloc_fn = nb_test_realloc,
+    .copy_fn = nb_test_copy,
+    .free_fn = nb_test_release
+};
+
+void deque_push_front_and_pop_front() {
+  struct nb_buffer buffer;
+  nb_init(&buffer, sizeof(int));
+
+  for (int i = 0; i < 100; i++) {
+    const enum NB_PUSH_RESULT result = nb_push_front(&buffer, &i);
+    assert(result == NB_PUSH_OK);
+  }
+  assert(nb_block_count(&buffer) == 100);
+  for (int i = 0; i < 100; i++) assert(*(int *) nb_at(&buffer, i) == 99 - i);
+
+  int value = -1;
+  enum NB_POP_RESULT result = nb_pop_front(&buffer, &value);
+  assert(result == NB_POP_OK);
+  assert(value == 99);
+  result = nb_pop_back(&buffer, &value);
+  assert(result == NB_POP_OK);
+  assert(value == 0);
+  assert(nb_block_count(&buffer) == 98);
+
+  while (nb_pop_front(&buffer, NULL) == NB_POP_OK) {}
+  assert(nb_block_count(&buffer) == 0);
+  result = nb_pop_front(&buffer, &value);
+  assert(result == NB_POP_EMPTY);
+  result = nb_pop_back(&buffer, &value);
+  assert(result == NB_POP_EMPTY);
+
+  nb_release(&buffer);
+}
+
+void deque_fifo_does_not_move_blocks_on_dequeue() {
+  struct nb_buffer buffer;
+  nb_init_advanced(&buffer, sizeof(int), &ctx);
+
+  for (int i = 0; i < 1000; i++) nb_push(&buffer, &i);
+  move_call_count = 0;
+  for (int i = 0; i < 1000; i++) {
+    int value;
+    const enum NB_POP_RESULT result = nb_pop_front(&buffer, &value);
+    assert(result == NB_POP_OK);
+    assert(value == i);
+  }
+  assert(move_call_count == 0);
+
+  // a long-running queue slides its blocks back only once in a while
+  int next_in = 0, next_out = 0;
+  move_call_count = 0;
+  for (int round = 0; round < 10000; round++) {
+    nb_push(&buffer, &next_in);
+    next_in++;
+    nb_push(&buffer, &next_in);
+    next_in++;
+    int value;
+    nb_pop_front(&buffer, &value);
+    assert(value == next_out);
+    nb_pop_front(&buffer, &value);
+    assert(value == next_out + 1);
+    next_out += 2;
+  }
+  assert(move_call_count < 100);
+
+  nb_release(&buffer);
+}
+
+void deque_matches_a_reference_model() {
+  struct nb_buffer buffer;
+  nb_init(&buffer, sizeof(int));
+
+  int model[4096];
+  size_t model_count = 0;
+  srand(42);
+
+  for (int step = 0; step < 20000; step++) {
+    const int op = rand() % 8;
+    int value = rand();
+    if (op == 0 && model_count < 4096) {
+      nb_push_front(&buffer, &value);
+      memmove(model + 1, model, model_count * sizeof(int));
+      model[0] = value;
+      model_count++;
+    } else if (op == 1 && model_count < 4096) {
+      nb_push(&buffer, &value);
+      model[model_count++] = value;
+    } else if (op == 2 && model_count > 0) {
+      nb_pop_front(&buffer, &value);
+      assert(value == model[0]);
+      memmove(model, model + 1, --model_count * sizeof(int));
+    } else if (op == 3 && model_count > 0) {
+      nb_pop_back(&buffer, &value);
+      model_count--;
+      assert(value == model[model_count]);
+    } else if (op == 4 && model_count < 4096) {
+      const size_t index = (size_t) rand() % (model_count + 1);
+      nb_insert(&buffer, index, &value);
+      memmove(model + index + 1, model + index, (model_count - index) * sizeof(int));
+      model[index] = value;
+      model_count++;
+    } else if (op == 5 && model_count > 0) {
+      const size_t index = (size_t) rand() % model_count;
+      nb_remove_at(&buffer, index);
+      memmove(model + index, model + index + 1, (model_count - index - 1) * sizeof(int));
+      model_count--;
+    } else if (op == 6 && rand() % 50 == 0) {
+      const enum NB_SHRINK_RESULT result = nb_shrink_to_fit(&buffer);
+      assert(result == NB_SHRINK_OK);
+    }
+
+    assert(nb_block_count(&buffer) == model_count);
+    if (model_count > 0) assert(*(int *) nb_front(&buffer) == model[0]);
+  }
+
+  struct nb_buffer_iterator itr = nb_iterator(&buffer);
+  size_t index = 0;
+  for (int * block = itr.begin; (void *) block != itr.end; block++, index++) assert(*block == model[index]);
+  assert(index == model_count);
+
+  nb_release(&buffer);
+}
+
+void deque_inline_storage_uses_free_room_at_the_front() {
+  int storage[8];
+  struct nb_buffer buffer;
+  nb_init_inline(&buffer, sizeof(int), storage, 8);
+
+  int value = 1;
+  nb_push(&buffer, &value);
+  value = 0;
+  nb_push_front(&buffer, &value);
+  assert(nb_is_inline(&buffer));
+  assert(*(int *) nb_at(&buffer, 0) == 0);
+  assert(*(int *) nb_at(&buffer, 1) == 1);
+
+  for (int i = 0; i < 10; i++) nb_push_front(&buffer, &i);
+  assert(!nb_is_inline(&buffer));
+  assert(nb_block_count(&buffer) == 12);
+  assert(*(int *) nb_front(&buffer) == 9);
+  assert(*(int *) nb_back(&buffer) == 1);
+
+  nb_release(&buffer);
+}
+
+int main(void) {
+  deque_push_front_and_pop_front();
+  deque_fifo_does_not_move_blocks_on_dequeue();
+  deque_matches_a_reference_model();
+  deque_inline_storage_uses_free_room_at_the_front();
+
+  return 0;
+}
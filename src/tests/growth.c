@@ -0,0 +1,152 @@
+#include "naughty-buffers/buffer.h"
+#include <assert.h>
+
+size_t growth_call_count = 0;
+
+size_t add_ten_growth(size_t block_capacity, size_t required_capacity, void * context) {
+  (void)required_capacity;
+  (void)context;
+  growth_call_count++;
+  return block_capacity + 10;
+}
+
+void growth_default_policy_doubles() {
+  struct nb_buffer buffer;
+  uint32_t value = 0;
+  nb_init(&buffer, sizeof(uint32_t));
+
+  for (size_t i = 0; i < 100; i++) nb_push(&buffer, &value);
+  assert(nb_block_capacity(&buffer) >= 100);
+
+  nb_release(&buffer);
+}
+
+void growth_custom_policy_is_called() {
+  struct nb_buffer buffer;
+  struct nb_buffer_memory_context memory_context;
+  struct nb_buffer_growth_policy policy = {.growth_fn = add_ten_growth, .context = NULL};
+  uint32_t value = 0;
+  growth_call_count = 0;
+
+  nb_memory_context_init(&memory_context);
+  memory_context.growth_policy = &policy;
+  nb_init_advanced(&buffer, sizeof(uint32_t), &memory_context);
+
+  size_t capacity = nb_block_capacity(&buffer);
+  while (nb_block_count(&buffer) < capacity) nb_push(&buffer, &value);
+  assert(growth_call_count == 0);
+
+  nb_push(&buffer, &value);
+  assert(growth_call_count == 1);
+  assert(nb_block_capacity(&buffer) >= capacity + 10);
+
+  nb_release(&buffer);
+}
+
+void growth_policy_result_is_never_smaller_than_required() {
+  struct nb_buffer buffer;
+  struct nb_buffer_memory_context memory_context;
+  struct nb_buffer_growth_policy policy = {.growth_fn = add_ten_growth, .context = NULL};
+  uint32_t value = 0;
+
+  nb_memory_context_init(&memory_context);
+  memory_context.growth_policy = &policy;
+  nb_init_advanced(&buffer, sizeof(uint32_t), &memory_context);
+
+  nb_assign(&buffer, 1000, &value);
+  assert(nb_block_count(&buffer) == 1001);
+  assert(nb_block_capacity(&buffer) >= 1001);
+
+  nb_release(&buffer);
+}
+
+void growth_parametric_geometric() {
+  struct nb_growth_parameters parameters = {.factor = 1.5, .increment = 0, .linear_threshold = 0};
+
+  assert(nb_parametric_growth(100, 101, &parameters) == 150);
+  assert(nb_parametric_growth(100, 200, &parameters) == 225);
+  assert(nb_parametric_growth(1, 2, &parameters) == 2);
+  assert(nb_parametric_growth(0, 1, &parameters) == 1);
+}
+
+void growth_parametric_fixed_increment() {
+  struct nb_growth_parameters parameters = {.factor = 0, .increment = 64, .linear_threshold = 0};
+
+  assert(nb_parametric_growth(100, 101, &parameters) == 164);
+  assert(nb_parametric_growth(100, 300, &parameters) == 356);
+}
+
+void growth_parametric_capped() {
+  struct nb_growth_parameters parameters = {.factor = 2.0, .increment = 1000, .linear_threshold = 1024};
+
+  assert(nb_parametric_growth(256, 257, &parameters) == 512);
+  assert(nb_parametric_growth(512, 513, &parameters) == 1024);
+  assert(nb_parametric_growth(700, 701, &parameters) == 1024);
+  assert(nb_parametric_growth(1024, 1025, &parameters) == 2024);
+  assert(nb_parametric_growth(2024, 4000, &parameters) == 4024);
+}
+
+void growth_reserve_sets_capacity() {
+  struct nb_buffer buffer;
+  uint32_t value = 0;
+  nb_init(&buffer, sizeof(uint32_t));
+
+  enum NB_RESERVE_RESULT result = nb_reserve(&buffer, 1000);
+  assert(result == NB_RESERVE_OK);
+  assert(nb_block_capacity(&buffer) >= 1000);
+  assert(nb_block_count(&buffer) == 0);
+
+  void * data = buffer.data;
+  for (size_t i = 0; i < 1000; i++) nb_push(&buffer, &value);
+  assert(buffer.data == data);
+
+  result = nb_reserve(&buffer, 10);
+  assert(result == NB_RESERVE_OK);
+  assert(nb_block_capacity(&buffer) >= 1000);
+
+  nb_release(&buffer);
+}
+
+void growth_shrink_to_fit_keeps_values() {
+  struct nb_buffer buffer;
+  nb_init(&buffer, sizeof(uint32_t));
+
+  for (uint32_t i = 0; i < 1000; i++) nb_push(&buffer, &i);
+  for (uint32_t i = 0; i < 990; i++) nb_remove_back(&buffer);
+
+  const enum NB_SHRINK_RESULT result = nb_shrink_to_fit(&buffer);
+  assert(result == NB_SHRINK_OK);
+  assert(nb_block_capacity(&buffer) >= 10);
+  assert(nb_block_capacity(&buffer) < 1000);
+
+  for (uint32_t i = 0; i < 10; i++) assert(*(uint32_t *)nb_at(&buffer, i) == i);
+
+  nb_release(&buffer);
+}
+
+void growth_accepts_empty_blocks() {
+  struct nb_buffer buffer;
+  nb_init(&buffer, 0);
+  assert(nb_block_capacity(&buffer) >= 2);
+
+  uint8_t value = 0;
+  nb_push(&buffer, &value);
+  nb_push(&buffer, &value);
+  assert(nb_block_count(&buffer) == 2);
+
+  nb_release(&buffer);
+}
+
+int main(void) {
+  growth_default_policy_doubles();
+  growth_custom_policy_is_called();
+  growth_policy_result_is_never_smaller_than_required();
+  growth_parametric_geometric();
+  growth_parametric_fixed_increment();
+  growth_parametric_capped();
+  growth_reserve_sets_capacity();
+  growth_shrink_to_fit_keeps_values();
+  growth_accepts_empty_blocks();
+
+  return 0;
+}
@@ -0,0 +1,160 @@
+#include "naughty-buffers/buffer.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+size_t alloc_call_count = 0;
+
+void * nb_test_alloc(size_t size, void * _) {
+  (void)_;
+  alloc_call_count++;
+  return malloc(size);
+}
+
+size_t release_call_count = 0;
+
+void nb_test_release(void * ptr, void * _) {
+  (void)_;
+  release_call_count++;
+  free(ptr);
+}
+
+size_t realloc_call_count = 0;
+
+void * nb_test_realloc(void * ptr, size_t size, void * _) {
+  (void)_;
+  realloc_call_count++;
+  return realloc(ptr, size);
+}
+
+void * nb_test_copy(void * destination, const void * source, size_t size, void * _) {
+  (void)_;
+  return memcpy(destination, source, size);
+}
+
+void * nb_test_move(void * destination, const void * source, size_t size, void * _) {
+  (void)_;
+  return memmove(destination, source, size);
+}
+
+struct nb_buffer_memory_context ctx = {
+    .move_fn = nb_test_move,
+    .alloc_fn = nb_test_alloc,
+    .realloc_fn = nb_test_realloc,
+    .copy_fn = nb_test_copy,
+    .free_fn = nb_test_release
+};
+
+void reset() {
+  alloc_call_count = 0;
+  realloc_call_count = 0;
+  release_call_count = 0;
+}
+
+void inline_does_not_allocate_until_spilling() {
+  reset();
+  struct nb_buffer buffer;
+  uint32_t storage[4];
+  nb_init_inline_advanced(&buffer, sizeof(uint32_t), storage, 4, &ctx);
+  assert(alloc_call_count == 0);
+  assert(nb_is_inline(&buffer));
+
+  for (uint32_t i = 0; i < 4; i++) nb_push(&buffer, &i);
+  assert(alloc_call_count == 0);
+  assert(nb_is_inline(&buffer));
+  assert(nb_at(&buffer, 0) == &storage[0]);
+
+  uint32_t value = 4;
+  nb_push(&buffer, &value);
+  assert(alloc_call_count == 1);
+  assert(realloc_call_count == 0);
+  assert(!nb_is_inline(&buffer));
+
+  for (uint32_t i = 0; i < 5; i++) assert(*(uint32_t *)nb_at(&buffer, i) == i);
+
+  nb_push(&buffer, &value);
+  nb_push(&buffer, &value);
+  nb_push(&buffer, &value);
+  nb_push(&buffer, &value);
+  assert(alloc_call_count == 1);
+  assert(realloc_call_count == 1);
+
+  nb_release(&buffer);
+  assert(release_call_count == 1);
+}
+
+void inline_release_does_not_free_inline_storage() {
+  reset();
+  struct nb_buffer buffer;
+  uint32_t storage[4];
+  nb_init_inline_advanced(&buffer, sizeof(uint32_t), storage, 4, &ctx);
+
+  uint32_t value = 10;
+  nb_push(&buffer, &value);
+  nb_release(&buffer);
+  assert(release_call_count == 0);
+}
+
+void inline_iterator_is_transparent() {
+  struct nb_buffer buffer;
+  uint32_t storage[8];
+  nb_init_inline(&buffer, sizeof(uint32_t), storage, 8);
+
+  for (uint32_t i = 0; i < 6; i++) nb_push(&buffer, &i);
+
+  struct nb_buffer_iterator itr = nb_iterator(&buffer);
+  uint32_t expected = 0;
+  for (uint8_t * block = itr.begin; block != itr.end; block += itr.increment) {
+    assert(*(uint32_t *)block == expected);
+    expected++;
+  }
+  assert(expected == 6);
+
+  nb_release(&buffer);
+}
+
+void inline_shrink_to_fit_keeps_inline_storage() {
+  struct nb_buffer buffer;
+  uint32_t storage[8];
+  nb_init_inline(&buffer, sizeof(uint32_t), storage, 8);
+
+  uint32_t value = 1;
+  nb_push(&buffer, &value);
+  const enum NB_SHRINK_RESULT result = nb_shrink_to_fit(&buffer);
+  assert(result == NB_SHRINK_OK);
+  assert(nb_is_inline(&buffer));
+  assert(nb_block_capacity(&buffer) == 8);
+
+  nb_release(&buffer);
+}
+
+void inline_front_removals_keep_inline_storage() {
+  reset();
+  struct nb_buffer buffer;
+  uint32_t storage[4];
+  nb_init_inline_advanced(&buffer, sizeof(uint32_t), storage, 4, &ctx);
+
+  for (uint32_t i = 0; i < 4; i++) nb_push(&buffer, &i);
+  nb_remove_front(&buffer);
+  nb_remove_front(&buffer);
+  assert(nb_is_inline(&buffer));
+  assert(nb_at(&buffer, 0) == &storage[2]);
+
+  for (uint32_t i = 4; i < 8; i++) nb_push(&buffer, &i);
+  assert(alloc_call_count == 1);
+  assert(!nb_is_inline(&buffer));
+  for (uint32_t i = 0; i < 6; i++) assert(*(uint32_t *)nb_at(&buffer, i) == i + 2);
+
+  nb_release(&buffer);
+  assert(release_call_count == 1);
+}
+
+int main(void) {
+  inline_does_not_allocate_until_spilling();
+  inline_release_does_not_free_inline_storage();
+  inline_iterator_is_transparent();
+  inline_shrink_to_fit_keeps_inline_storage();
+  inline_front_removals_keep_inline_storage();
+
+  return 0;
+}
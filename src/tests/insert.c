@@ -119,12 +119,96 @@ void insert_properly_keeps_other_values() {
   nb_release(&buffer);
 }
 
+void insert_many_keeps_order() {
+  struct nb_buffer buffer;
+  nb_init(&buffer, sizeof(uint32_t));
+
+  uint32_t values[6] = {0, 1, 4, 5, 6, 7};
+  nb_push_many(&buffer, values, 6);
+
+  uint32_t middle[2] = {2, 3};
+  enum NB_INSERT_RESULT result = nb_insert_many(&buffer, 2, middle, 2);
+  assert(result == NB_INSERT_OK);
+  uint32_t front[3] = {100, 101, 102};
+  result = nb_insert_many(&buffer, 0, front, 3);
+  assert(result == NB_INSERT_OK);
+  uint32_t back[2] = {8, 9};
+  result = nb_insert_many(&buffer, 11, back, 2);
+  assert(result == NB_INSERT_OK);
+  result = nb_insert_many(&buffer, 1, back, 0);
+  assert(result == NB_INSERT_OK);
+
+  const uint32_t expected[13] = {100, 101, 102, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  assert(nb_block_count(&buffer) == 13);
+  for (size_t i = 0; i < 13; i++) assert(*(uint32_t *)nb_at(&buffer, i) == expected[i]);
+
+  // blocks dropped from the front leave room to move the first blocks back instead of the last ones
+  nb_remove_range(&buffer, 0, 3);
+  result = nb_insert_many(&buffer, 1, front, 3);
+  assert(result == NB_INSERT_OK);
+  assert(*(uint32_t *)nb_at(&buffer, 0) == 0);
+  assert(*(uint32_t *)nb_at(&buffer, 1) == 100);
+  assert(*(uint32_t *)nb_at(&buffer, 3) == 102);
+  assert(*(uint32_t *)nb_at(&buffer, 4) == 1);
+  assert(*(uint32_t *)nb_back(&buffer) == 9);
+
+  nb_release(&buffer);
+}
+
+void insert_batch_merges_in_a_single_pass() {
+  struct nb_buffer buffer;
+  nb_init(&buffer, sizeof(uint32_t));
+
+  uint32_t values[5] = {10, 20, 30, 40, 50};
+  nb_push_many(&buffer, values, 5);
+
+  uint32_t new_values[6] = {0, 1, 25, 35, 36, 60};
+  const size_t indices[6] = {0, 0, 2, 3, 3, 5};
+  enum NB_INSERT_RESULT result = nb_insert_batch(&buffer, indices, new_values, 6);
+  assert(result == NB_INSERT_OK);
+
+  const uint32_t expected[11] = {0, 1, 10, 20, 25, 30, 35, 36, 40, 50, 60};
+  assert(nb_block_count(&buffer) == 11);
+  for (size_t i = 0; i < 11; i++) assert(*(uint32_t *)nb_at(&buffer, i) == expected[i]);
+
+  result = nb_insert_batch(&buffer, indices, new_values, 0);
+  assert(result == NB_INSERT_OK);
+  assert(nb_block_count(&buffer) == 11);
+
+  nb_release(&buffer);
+}
+
+void insert_batch_rejects_invalid_indices() {
+  struct nb_buffer buffer;
+  nb_init(&buffer, sizeof(uint32_t));
+
+  uint32_t values[3] = {10, 20, 30};
+  nb_push_many(&buffer, values, 3);
+
+  uint32_t new_values[2] = {0, 40};
+  const size_t past_the_end[2] = {0, 4};
+  enum NB_INSERT_RESULT result = nb_insert_batch(&buffer, past_the_end, new_values, 2);
+  assert(result == NB_INSERT_INVALID_INDICES);
+
+  const size_t out_of_order[2] = {2, 1};
+  result = nb_insert_batch(&buffer, out_of_order, new_values, 2);
+  assert(result == NB_INSERT_INVALID_INDICES);
+
+  assert(nb_block_count(&buffer) == 3);
+  for (size_t i = 0; i < 3; i++) assert(*(uint32_t *)nb_at(&buffer, i) == values[i]);
+
+  nb_release(&buffer);
+}
+
 int main(void) {
   insert_increases_count_correctly();
   insert_stores_the_right_values();
   insert_store_values_not_addresses();
   insert_properly_stretches_the_buffer();
   insert_properly_keeps_other_values();
+  insert_many_keeps_order();
+  insert_batch_merges_in_a_single_pass();
+  insert_batch_rejects_invalid_indices();
 
   return 0;
 }
\ No newline at end of file
@@ -74,6 +74,39 @@ void memory_custom_memory_functions_and_context_are_initialized_properly() {
   nb_release(&buffer);
 }
 
+void memory_lazy_init_does_not_allocate() {
+  reset();
+
+  struct nb_buffer buffer;
+  size_t value = 1;
+  nb_init_lazy_advanced(&buffer, sizeof(uint32_t), &ctx);
+  assert(alloc_call_count == 0);
+  assert(nb_block_count(&buffer) == 0);
+  assert(nb_at(&buffer, 0) == NULL);
+
+  struct nb_buffer_iterator itr = nb_iterator(&buffer);
+  assert(itr.begin == itr.end);
+
+  nb_push(&buffer, &value);
+  assert(alloc_call_count == 1);
+  assert(realloc_call_count == 0);
+  assert(nb_block_count(&buffer) == 1);
+
+  release_call_count = 0;
+  nb_release(&buffer);
+  assert(release_call_count == 1);
+}
+
+void memory_lazy_init_release_without_writes_does_not_free() {
+  reset();
+
+  struct nb_buffer buffer;
+  nb_init_lazy_advanced(&buffer, sizeof(uint32_t), &ctx);
+  nb_release(&buffer);
+  assert(alloc_call_count == 0);
+  assert(release_call_count == 0);
+}
+
 void memory_custom_memory_is_properly_called_with_push() {
   reset();
 
@@ -108,6 +141,56 @@ void memory_custom_memory_is_properly_called_with_push() {
   assert(release_call_count == 1);
 }
 
+void memory_custom_memory_is_properly_called_with_push_many() {
+  reset();
+
+  struct nb_buffer buffer;
+  uint32_t values[100] = { 0 };
+  nb_init_advanced(&buffer, sizeof(uint32_t), &ctx);
+
+  realloc_call_count = 0;
+  copy_call_count = 0;
+  copy_call_size = 0;
+
+  nb_push_many(&buffer, values, 100);
+  assert(copy_call_count == 1);
+  assert(copy_call_size == sizeof(uint32_t) * 100);
+  assert(realloc_call_count == 1);
+
+  copy_call_count = 0;
+  nb_pop_many(&buffer, values, 50);
+  assert(copy_call_count == 1);
+  assert(copy_call_size == sizeof(uint32_t) * 50);
+
+  release_call_count = 0;
+  nb_release(&buffer);
+  assert(release_call_count == 1);
+}
+
+void memory_custom_memory_is_properly_called_with_reserve_and_shrink() {
+  reset();
+
+  struct nb_buffer buffer;
+  size_t value = 1;
+  nb_init_advanced(&buffer, sizeof(uint32_t), &ctx);
+
+  nb_reserve(&buffer, 100);
+  assert(realloc_call_count == 1);
+  assert(buffer.block_capacity == 100);
+
+  for (size_t i = 0; i < 100; i++) nb_push(&buffer, &value);
+  assert(realloc_call_count == 1);
+
+  nb_pop_many(&buffer, NULL, 90);
+  nb_shrink_to_fit(&buffer);
+  assert(realloc_call_count == 2);
+  assert(buffer.block_capacity == 10);
+
+  release_call_count = 0;
+  nb_release(&buffer);
+  assert(release_call_count == 1);
+}
+
 void memory_custom_memory_is_properly_called_with_assign() {
   reset();
 
@@ -175,19 +258,23 @@ void memory_custom_memory_is_properly_called_with_remove() {
   reset();
 
   nb_remove_front(&buffer);
-  assert(move_call_count == 1);
+  assert(move_call_count == 0);
 
   reset();
 
   nb_remove_at(&buffer, 0);
-  assert(move_call_count == 1);
+  assert(move_call_count == 0);
 
   nb_release(&buffer);
 }
 
 int main(void) {
   memory_custom_memory_functions_and_context_are_initialized_properly();
+  memory_lazy_init_does_not_allocate();
+  memory_lazy_init_release_without_writes_does_not_free();
   memory_custom_memory_is_properly_called_with_push();
+  memory_custom_memory_is_properly_called_with_push_many();
+  memory_custom_memory_is_properly_called_with_reserve_and_shrink();
   memory_custom_memory_is_properly_called_with_assign();
   memory_custom_memory_is_properly_called_with_insert();
   memory_custom_memory_is_properly_called_with_remove();
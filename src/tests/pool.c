@@ -0,0 +1,128 @@
+#include "naughty-buffers/pool.h"
+#include "test-thread.h"
+#include <assert.h>
+
+#define assert_eq(a, b) assert((a) == (b))
+
+void pool_buffers_work() {
+  struct nb_buffer buffer;
+  nb_init_advanced(&buffer, sizeof(uint32_t), nb_pool_memory_context());
+
+  for (uint32_t i = 0; i < 10000; i++) nb_push(&buffer, &i);
+  for (uint32_t i = 0; i < 10000; i++) assert_eq(*(uint32_t *)nb_at(&buffer, i), i);
+
+  nb_release(&buffer);
+  nb_pool_thread_flush();
+}
+
+void pool_released_blocks_are_reused() {
+  struct nb_pool_stats stats;
+  struct nb_buffer buffer;
+  nb_pool_thread_flush();
+
+  nb_init_advanced(&buffer, sizeof(uint32_t), nb_pool_memory_context());
+  void * data = buffer.data;
+  nb_release(&buffer);
+
+  nb_pool_thread_stats(&stats);
+  assert(stats.cached_bytes > 0);
+  size_t hits = stats.cache_hits;
+
+  nb_init_advanced(&buffer, sizeof(uint32_t), nb_pool_memory_context());
+  assert(buffer.data == data);
+  nb_pool_thread_stats(&stats);
+  assert_eq(stats.cache_hits, hits + 1);
+
+  nb_release(&buffer);
+  nb_pool_thread_flush();
+  nb_pool_thread_stats(&stats);
+  assert_eq(stats.cached_bytes, 0);
+}
+
+void pool_realloc_within_class_is_in_place() {
+  struct nb_buffer_memory_context * ctx = nb_pool_memory_context();
+  struct nb_pool_stats stats;
+
+  void * ptr = ctx->alloc_fn(33, ctx->context);
+  assert(ctx->usable_size_fn(ptr, ctx->context) == 64);
+
+  nb_pool_thread_stats(&stats);
+  size_t in_place = stats.in_place_reallocs;
+  void * same = ctx->realloc_fn(ptr, 60, ctx->context);
+  assert(same == ptr);
+  nb_pool_thread_stats(&stats);
+  assert_eq(stats.in_place_reallocs, in_place + 1);
+
+  void * bigger = ctx->realloc_fn(ptr, 65, ctx->context);
+  assert(ctx->usable_size_fn(bigger, ctx->context) == 128);
+
+  ctx->free_fn(bigger, ctx->context);
+  nb_pool_thread_flush();
+}
+
+void pool_huge_allocations_bypass_the_cache() {
+  struct nb_buffer_memory_context * ctx = nb_pool_memory_context();
+  struct nb_pool_stats stats;
+  nb_pool_thread_flush();
+
+  nb_pool_thread_stats(&stats);
+  size_t huge = stats.huge_allocations;
+
+  uint8_t * ptr = ctx->alloc_fn(NB_POOL_MAX_CLASS_SIZE + 1, ctx->context);
+  ptr[NB_POOL_MAX_CLASS_SIZE] = 42;
+  ptr = ctx->realloc_fn(ptr, NB_POOL_MAX_CLASS_SIZE * 2, ctx->context);
+  assert_eq(ptr[NB_POOL_MAX_CLASS_SIZE], 42);
+  ctx->free_fn(ptr, ctx->context);
+
+  nb_pool_thread_stats(&stats);
+  assert_eq(stats.huge_allocations, huge + 1);
+  assert_eq(stats.cached_bytes, 0);
+}
+
+void pool_free_lists_are_bounded() {
+  struct nb_buffer_memory_context * ctx = nb_pool_memory_context();
+  struct nb_pool_stats stats;
+  void * ptrs[NB_POOL_MAX_CACHED_BLOCKS + 10];
+  nb_pool_thread_flush();
+
+  for (size_t i = 0; i < NB_POOL_MAX_CACHED_BLOCKS + 10; i++) ptrs[i] = ctx->alloc_fn(16, ctx->context);
+  for (size_t i = 0; i < NB_POOL_MAX_CACHED_BLOCKS + 10; i++) ctx->free_fn(ptrs[i], ctx->context);
+
+  nb_pool_thread_stats(&stats);
+  assert_eq(stats.cached_bytes, NB_POOL_MAX_CACHED_BLOCKS * 16);
+
+  nb_pool_thread_flush();
+}
+
+void fill_and_release_without_flushing(void * argument) {
+  (void) argument;
+  struct nb_buffer buffer;
+  nb_init_advanced(&buffer, sizeof(uint32_t), nb_pool_memory_context());
+
+  for (uint32_t i = 0; i < 1000; i++) nb_push(&buffer, &i);
+  nb_release(&buffer);
+
+  struct nb_pool_stats stats;
+  nb_pool_thread_stats(&stats);
+  assert(stats.cached_bytes > 0);
+}
+
+// the cached blocks are given back when the threads exit, the leak checker of sanitized builds reports them otherwise
+void pool_thread_exit_flushes_the_cache() {
+  struct test_call call = {.fn = fill_and_release_without_flushing, .argument = NULL};
+  test_thread threads[4];
+
+  for (size_t i = 0; i < 4; i++) test_thread_start(&threads[i], &call);
+  for (size_t i = 0; i < 4; i++) test_thread_join(threads[i]);
+}
+
+int main(void) {
+  pool_buffers_work();
+  pool_released_blocks_are_reused();
+  pool_realloc_within_class_is_in_place();
+  pool_huge_allocations_bypass_the_cache();
+  pool_free_lists_are_bounded();
+  pool_thread_exit_flushes_the_cache();
+
+  return 0;
+}
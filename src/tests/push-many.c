@@ -0,0 +1,91 @@
+#include "naughty-buffers/buffer.h"
+#include <assert.h>
+
+void push_many_increases_count_correctly() {
+  struct nb_buffer buffer;
+  uint32_t values[] = { 0, 1, 2, 3, 4 };
+  nb_init(&buffer, sizeof(uint32_t));
+  assert(buffer.block_count == 0);
+  nb_push_many(&buffer, values, 5);
+  assert(buffer.block_count == 5);
+  nb_push_many(&buffer, values, 0);
+  assert(buffer.block_count == 5);
+  nb_push_many(&buffer, values, 3);
+  assert(buffer.block_count == 8);
+  assert(buffer.block_capacity >= 8);
+  nb_release(&buffer);
+}
+
+void push_many_stores_the_right_values() {
+  struct nb_buffer buffer;
+  uint32_t values[1000];
+  uint32_t * read_value = NULL;
+
+  for (uint32_t i = 0; i < 1000; i++) values[i] = i * 3;
+
+  nb_init(&buffer, sizeof(uint32_t));
+
+  uint32_t first = 42;
+  nb_push(&buffer, &first);
+  nb_push_many(&buffer, values, 1000);
+
+  read_value = nb_at(&buffer, 0);
+  assert(*read_value == 42);
+  for (size_t i = 0; i < 1000; i++) {
+    read_value = nb_at(&buffer, i + 1);
+    assert(*read_value == values[i]);
+    assert(read_value != &values[i]);
+  }
+
+  nb_release(&buffer);
+}
+
+void pop_many_removes_from_the_back_keeping_order() {
+  struct nb_buffer buffer;
+  uint32_t values[] = { 0, 1, 2, 3, 4 };
+  uint32_t popped[5] = { 0 };
+
+  nb_init(&buffer, sizeof(uint32_t));
+  nb_push_many(&buffer, values, 5);
+
+  size_t popped_count = nb_pop_many(&buffer, popped, 2);
+  assert(popped_count == 2);
+  assert(nb_block_count(&buffer) == 3);
+  assert(popped[0] == 3);
+  assert(popped[1] == 4);
+
+  popped_count = nb_pop_many(&buffer, NULL, 1);
+  assert(popped_count == 1);
+  assert(nb_block_count(&buffer) == 2);
+  assert(*(uint32_t *) nb_back(&buffer) == 1);
+
+  nb_release(&buffer);
+}
+
+void pop_many_stops_at_empty_buffer() {
+  struct nb_buffer buffer;
+  uint32_t values[] = { 0, 1, 2 };
+  uint32_t popped[10] = { 0 };
+
+  nb_init(&buffer, sizeof(uint32_t));
+  nb_push_many(&buffer, values, 3);
+
+  size_t popped_count = nb_pop_many(&buffer, popped, 10);
+  assert(popped_count == 3);
+  assert(nb_block_count(&buffer) == 0);
+  assert(popped[0] == 0 && popped[1] == 1 && popped[2] == 2);
+
+  popped_count = nb_pop_many(&buffer, popped, 10);
+  assert(popped_count == 0);
+
+  nb_release(&buffer);
+}
+
+int main(void) {
+  push_many_increases_count_correctly();
+  push_many_stores_the_right_values();
+  pop_many_removes_from_the_back_keeping_order();
+  pop_many_stops_at_empty_buffer();
+
+  return 0;
+}
@@ -63,10 +63,31 @@ void push_store_values_not_addresses() {
   nb_release(&buffer);
 }
 
+void push_uninit_returns_slots_in_the_buffer() {
+  struct nb_buffer buffer;
+  nb_init(&buffer, sizeof(uint32_t));
+
+  uint32_t * slot = nb_emplace_back(&buffer);
+  assert(slot != NULL);
+  *slot = 10;
+  assert(nb_block_count(&buffer) == 1);
+  assert(slot == nb_at(&buffer, 0));
+
+  uint32_t * slots = nb_push_uninit(&buffer, 100);
+  assert(slots != NULL);
+  for (uint32_t i = 0; i < 100; i++) slots[i] = i;
+  assert(nb_block_count(&buffer) == 101);
+  assert(*(uint32_t *)nb_at(&buffer, 0) == 10);
+  assert(*(uint32_t *)nb_at(&buffer, 100) == 99);
+
+  nb_release(&buffer);
+}
+
 int main(void) {
   push_increases_count_correctly();
   push_stores_the_right_values();
   push_store_values_not_addresses();
+  push_uninit_returns_slots_in_the_buffer();
 
   return 0;
 }
\ No newline at end of file
@@ -80,9 +80,151 @@ void remove_keeps_values_and_ordering() {
   nb_release(&buffer);
 }
 
+void remove_range_removes_contiguous_blocks() {
+  struct nb_buffer buffer;
+  nb_init(&buffer, sizeof(uint32_t));
+  for (uint32_t i = 0; i < 20; i++) nb_push(&buffer, &i);
+
+  size_t removed = nb_remove_range(&buffer, 2, 3);
+  assert_eq(removed, 3);
+  assert_eq(nb_block_count(&buffer), 17);
+  assert_eq(buffer_read_uint32_t(&buffer, 0), 0);
+  assert_eq(buffer_read_uint32_t(&buffer, 1), 1);
+  assert_eq(buffer_read_uint32_t(&buffer, 2), 5);
+  assert_eq(buffer_read_uint32_t(&buffer, 16), 19);
+
+  removed = nb_remove_range(&buffer, 10, 4);
+  assert_eq(removed, 4);
+  assert_eq(nb_block_count(&buffer), 13);
+  assert_eq(buffer_read_uint32_t(&buffer, 9), 12);
+  assert_eq(buffer_read_uint32_t(&buffer, 10), 17);
+
+  removed = nb_remove_range(&buffer, 11, 100);
+  assert_eq(removed, 2);
+  removed = nb_remove_range(&buffer, 11, 1);
+  assert_eq(removed, 0);
+  assert_eq(nb_block_count(&buffer), 11);
+  assert_eq(buffer_read_uint32_t(&buffer, 10), 17);
+
+  nb_release(&buffer);
+}
+
+int is_multiple_of(const void * block, void * context) {
+  return *(const uint32_t *) block % *(uint32_t *) context == 0;
+}
+
+void remove_if_keeps_order_of_kept_blocks() {
+  struct nb_buffer buffer;
+  nb_init(&buffer, sizeof(uint32_t));
+  for (uint32_t i = 0; i < 1000; i++) nb_push(&buffer, &i);
+
+  uint32_t divisor = 3;
+  size_t removed = nb_remove_if(&buffer, is_multiple_of, &divisor);
+  assert_eq(removed, 334);
+  assert_eq(nb_block_count(&buffer), 666);
+  for (size_t i = 0; i < 666; i++) assert(buffer_read_uint32_t(&buffer, i) % 3 != 0);
+  assert_eq(buffer_read_uint32_t(&buffer, 0), 1);
+  assert_eq(buffer_read_uint32_t(&buffer, 1), 2);
+  assert_eq(buffer_read_uint32_t(&buffer, 2), 4);
+  assert_eq(buffer_read_uint32_t(&buffer, 665), 998);
+
+  divisor = 1;
+  removed = nb_remove_if(&buffer, is_multiple_of, &divisor);
+  assert_eq(removed, 666);
+  assert_eq(nb_block_count(&buffer), 0);
+
+  nb_release(&buffer);
+}
+
+// removes the first `remaining` blocks it is called for, counting every call
+struct first_blocks {
+  size_t remaining;
+  size_t calls;
+};
+
+int is_one_of_the_first(const void * block, void * context) {
+  (void) block;
+  struct first_blocks * first = context;
+  first->calls++;
+  if (first->remaining == 0) return 0;
+  first->remaining--;
+  return 1;
+}
+
+void remove_if_calls_the_predicate_once_per_block() {
+  struct nb_buffer buffer;
+  nb_init(&buffer, sizeof(uint32_t));
+  for (uint32_t i = 0; i < 10; i++) nb_push(&buffer, &i);
+
+  uint32_t divisor = 2;
+  size_t removed = nb_remove_if(&buffer, is_multiple_of, &divisor);
+  assert_eq(removed, 5);
+
+  struct first_blocks first = {2, 0};
+  removed = nb_remove_if(&buffer, is_one_of_the_first, &first);
+  assert_eq(removed, 2);
+  assert_eq(first.calls, 5);
+  assert_eq(nb_block_count(&buffer), 3);
+  assert_eq(buffer_read_uint32_t(&buffer, 0), 5);
+  assert_eq(buffer_read_uint32_t(&buffer, 1), 7);
+  assert_eq(buffer_read_uint32_t(&buffer, 2), 9);
+
+  nb_release(&buffer);
+}
+
+void remove_indices_removes_listed_blocks() {
+  struct nb_buffer buffer;
+  nb_init(&buffer, sizeof(uint32_t));
+  for (uint32_t i = 0; i < 10; i++) nb_push(&buffer, &i);
+
+  const size_t indices[] = {0, 3, 3, 4, 9, 42};
+  size_t removed = nb_remove_indices(&buffer, indices, 6);
+  assert_eq(removed, 4);
+  assert_eq(nb_block_count(&buffer), 6);
+  assert_eq(buffer_read_uint32_t(&buffer, 0), 1);
+  assert_eq(buffer_read_uint32_t(&buffer, 1), 2);
+  assert_eq(buffer_read_uint32_t(&buffer, 2), 5);
+  assert_eq(buffer_read_uint32_t(&buffer, 3), 6);
+  assert_eq(buffer_read_uint32_t(&buffer, 4), 7);
+  assert_eq(buffer_read_uint32_t(&buffer, 5), 8);
+
+  removed = nb_remove_indices(&buffer, indices + 5, 1);
+  assert_eq(removed, 0);
+  removed = nb_remove_indices(&buffer, indices, 0);
+  assert_eq(removed, 0);
+  assert_eq(nb_block_count(&buffer), 6);
+
+  nb_release(&buffer);
+}
+
+void swap_remove_moves_the_last_block() {
+  struct nb_buffer buffer;
+  nb_init(&buffer, sizeof(uint32_t));
+  for (uint32_t i = 0; i < 5; i++) nb_push(&buffer, &i);
+
+  nb_swap_remove(&buffer, 1);
+  assert_eq(nb_block_count(&buffer), 4);
+  assert_eq(buffer_read_uint32_t(&buffer, 1), 4);
+  assert_eq(buffer_read_uint32_t(&buffer, 3), 3);
+
+  nb_swap_remove(&buffer, 3);
+  assert_eq(nb_block_count(&buffer), 3);
+  assert_eq(buffer_read_uint32_t(&buffer, 2), 2);
+
+  nb_swap_remove(&buffer, 3);
+  assert_eq(nb_block_count(&buffer), 3);
+
+  nb_release(&buffer);
+}
+
 int main(void) {
   remove_decreases_count_correctly();
   remove_keeps_values_and_ordering();
+  remove_range_removes_contiguous_blocks();
+  remove_if_keeps_order_of_kept_blocks();
+  remove_if_calls_the_predicate_once_per_block();
+  remove_indices_removes_listed_blocks();
+  swap_remove_moves_the_last_block();
 
   return 0;
 }
\ No newline at end of file
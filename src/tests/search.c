@@ -0,0 +1,106 @@
+#include "naughty-buffers/search.h"
+#include <assert.h>
+#include <stdlib.h>
+
+#define assert_eq(a, b) assert((a) == (b))
+
+int int_compare(const void * ptr_a, const void * ptr_b) {
+  int a = *((int *)ptr_a);
+  int b = *((int *)ptr_b);
+  return (a < b ? -1 : (b < a ? 1 : 0));
+}
+
+int read_int(const struct nb_buffer * buffer, size_t index) { return *(int *)nb_at(buffer, index); }
+
+void bounds_find_the_edges_of_equal_blocks() {
+  struct nb_buffer buffer;
+  nb_init(&buffer, sizeof(int));
+
+  int key = 5;
+  assert_eq(nb_lower_bound(&buffer, &key, int_compare), 0);
+  assert_eq(nb_upper_bound(&buffer, &key, int_compare), 0);
+
+  // 0, 2, 2, 4, 4, 4, ..., each even value n repeated n / 2 + 1 times
+  for (int value = 0; value <= 20; value += 2) {
+    for (int i = 0; i <= value / 2; i++) nb_push(&buffer, &value);
+  }
+  const size_t count = nb_block_count(&buffer);
+
+  for (key = -1; key <= 21; key++) {
+    size_t expected_lower = 0;
+    while (expected_lower < count && read_int(&buffer, expected_lower) < key) expected_lower++;
+    size_t expected_upper = expected_lower;
+    while (expected_upper < count && read_int(&buffer, expected_upper) == key) expected_upper++;
+
+    assert_eq(nb_lower_bound(&buffer, &key, int_compare), expected_lower);
+    assert_eq(nb_upper_bound(&buffer, &key, int_compare), expected_upper);
+    const struct nb_index_range range = nb_equal_range(&buffer, &key, int_compare);
+    assert_eq(range.first, expected_lower);
+    assert_eq(range.end, expected_upper);
+  }
+
+  nb_release(&buffer);
+}
+
+void insert_sorted_keeps_the_buffer_sorted() {
+  struct nb_buffer buffer;
+  nb_init(&buffer, sizeof(int));
+
+  srand(3);
+  for (int i = 0; i < 1000; i++) {
+    int value = rand() % 100;
+    const enum NB_INSERT_RESULT result = nb_insert_sorted(&buffer, &value, int_compare);
+    assert_eq(result, NB_INSERT_OK);
+  }
+
+  assert_eq(nb_block_count(&buffer), 1000);
+  for (size_t i = 1; i < 1000; i++) assert(read_int(&buffer, i - 1) <= read_int(&buffer, i));
+  assert_eq(nb_sorted_count(&buffer), 1000);
+
+  nb_release(&buffer);
+}
+
+void eytzinger_find_matches_lower_bound() {
+  struct nb_buffer sorted;
+  struct nb_buffer eytzinger;
+  nb_init(&sorted, sizeof(int));
+  nb_init(&eytzinger, sizeof(int));
+
+  int value = 0;
+  enum NB_EYTZINGER_RESULT result = nb_build_eytzinger(&sorted, &eytzinger);
+  assert_eq(result, NB_EYTZINGER_OK);
+  assert_eq(nb_eytzinger_find(&eytzinger, &value, int_compare), 0);
+
+  // every size up to a few full levels of the tree, with repeated values
+  for (size_t count = 1; count <= 70; count++) {
+    nb_push(&sorted, &value);
+    value += (int)(count % 3);
+
+    result = nb_build_eytzinger(&sorted, &eytzinger);
+    assert_eq(result, NB_EYTZINGER_OK);
+    assert_eq(nb_block_count(&eytzinger), count);
+    for (int key = -1; key <= value + 1; key++) {
+      const size_t expected = nb_lower_bound(&sorted, &key, int_compare);
+      const size_t position = nb_eytzinger_find(&eytzinger, &key, int_compare);
+      if (expected == count) assert_eq(position, count);
+      else assert_eq(read_int(&eytzinger, position), read_int(&sorted, expected));
+    }
+  }
+
+  struct nb_buffer wrong_size;
+  nb_init(&wrong_size, sizeof(char));
+  result = nb_build_eytzinger(&sorted, &wrong_size);
+  assert_eq(result, NB_EYTZINGER_BLOCK_SIZE_MISMATCH);
+
+  nb_release(&wrong_size);
+  nb_release(&eytzinger);
+  nb_release(&sorted);
+}
+
+int main(void) {
+  bounds_find_the_edges_of_equal_blocks();
+  insert_sorted_keeps_the_buffer_sorted();
+  eytzinger_find_matches_lower_bound();
+
+  return 0;
+}
@@ -0,0 +1,181 @@
+#include "naughty-buffers/sharded-buffer.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "test-thread.h"
+
+#define assert_eq(a, b) assert((a) == (b))
+
+void sharded_buffer_has_independent_shards() {
+  struct nb_sharded_buffer * buffer = nb_sharded_buffer_create(sizeof(int), 0);
+  assert(buffer == NULL);
+
+  buffer = nb_sharded_buffer_create(sizeof(int), 3);
+  assert(buffer != NULL);
+  assert_eq(nb_sharded_shard_count(buffer), 3);
+  assert(nb_sharded_shard(buffer, 3) == NULL);
+  assert_eq(nb_sharded_block_count(buffer), 0);
+
+  for (int i = 0; i < 10; i++) nb_push(nb_sharded_shard(buffer, 0), &i);
+  for (int i = 100; i < 105; i++) nb_push(nb_sharded_shard(buffer, 2), &i);
+  assert_eq(nb_block_count(nb_sharded_shard(buffer, 0)), 10);
+  assert_eq(nb_block_count(nb_sharded_shard(buffer, 1)), 0);
+  assert_eq(nb_block_count(nb_sharded_shard(buffer, 2)), 5);
+  assert_eq(nb_sharded_block_count(buffer), 15);
+
+  nb_sharded_clear(buffer);
+  assert_eq(nb_sharded_block_count(buffer), 0);
+  assert(nb_block_capacity(nb_sharded_shard(buffer, 0)) >= 10);
+
+  nb_sharded_buffer_destroy(buffer);
+}
+
+void sharded_spans_point_into_the_shards() {
+  struct nb_sharded_buffer * buffer = nb_sharded_buffer_create(sizeof(int), 4);
+  struct nb_sharded_span spans[4];
+
+  size_t span_count = nb_sharded_spans(buffer, spans);
+  assert_eq(span_count, 0);
+  for (int i = 0; i < 3; i++) nb_push(nb_sharded_shard(buffer, 1), &i);
+  for (int i = 3; i < 7; i++) nb_push(nb_sharded_shard(buffer, 3), &i);
+
+  // empty shards are skipped
+  span_count = nb_sharded_spans(buffer, spans);
+  assert_eq(span_count, 2);
+  assert(spans[0].data == nb_at(nb_sharded_shard(buffer, 1), 0));
+  assert_eq(spans[0].block_count, 3);
+  assert(spans[1].data == nb_at(nb_sharded_shard(buffer, 3), 0));
+  assert_eq(spans[1].block_count, 4);
+  assert_eq(((int *) spans[1].data)[3], 6);
+
+  nb_sharded_buffer_destroy(buffer);
+}
+
+void sharded_collect_appends_in_shard_order() {
+  struct nb_sharded_buffer * buffer = nb_sharded_buffer_create(sizeof(int), 3);
+  struct nb_buffer destination;
+  nb_init(&destination, sizeof(int));
+  int value = -1;
+  nb_push(&destination, &value);
+
+  enum NB_COLLECT_RESULT result = nb_sharded_collect(buffer, &destination, 0);
+  assert_eq(result, NB_COLLECT_OK);
+  assert_eq(nb_block_count(&destination), 1);
+
+  for (int i = 0; i < 4; i++) nb_push(nb_sharded_shard(buffer, 2), &i);
+  for (int i = 4; i < 6; i++) nb_push(nb_sharded_shard(buffer, 0), &i);
+  result = nb_sharded_collect(buffer, &destination, 0);
+  assert_eq(result, NB_COLLECT_OK);
+
+  // shard 0 first, then shard 2, after what the destination already held
+  const int expected[] = {-1, 4, 5, 0, 1, 2, 3};
+  assert_eq(nb_block_count(&destination), 7);
+  for (size_t i = 0; i < 7; i++) assert_eq(*(int *) nb_at(&destination, i), expected[i]);
+  assert_eq(nb_sharded_block_count(buffer), 0);
+
+  nb_release(&destination);
+  nb_sharded_buffer_destroy(buffer);
+}
+
+void sharded_collect_rejects_other_block_sizes() {
+  struct nb_sharded_buffer * buffer = nb_sharded_buffer_create(sizeof(int), 2);
+  struct nb_buffer destination;
+  nb_init(&destination, sizeof(char));
+
+  int value = 1;
+  nb_push(nb_sharded_shard(buffer, 1), &value);
+  enum NB_COLLECT_RESULT result = nb_sharded_collect(buffer, &destination, 0);
+  assert_eq(result, NB_COLLECT_BLOCK_SIZE_MISMATCH);
+  assert_eq(nb_block_count(&destination), 0);
+  assert_eq(nb_sharded_block_count(buffer), 1);
+
+  nb_release(&destination);
+  nb_sharded_buffer_destroy(buffer);
+}
+
+void large_shards_are_collected_by_several_threads() {
+  const uint32_t shard_count = 5;
+  const uint32_t per_shard = 300000;
+  struct nb_sharded_buffer * buffer = nb_sharded_buffer_create(sizeof(uint32_t), shard_count);
+  struct nb_buffer destination;
+  nb_init(&destination, sizeof(uint32_t));
+
+  // uneven shards, so the pieces each thread copies start and end in the middle of them
+  for (uint32_t shard = 0; shard < shard_count; shard++) {
+    for (uint32_t i = 0; i < per_shard + shard * 1001; i++) {
+      uint32_t value = (shard << 24) | i;
+      nb_push(nb_sharded_shard(buffer, shard), &value);
+    }
+  }
+  const size_t block_count = nb_sharded_block_count(buffer);
+  assert(block_count * sizeof(uint32_t) >= NB_PARALLEL_COLLECT_THRESHOLD);
+
+  enum NB_COLLECT_RESULT result = nb_sharded_collect(buffer, &destination, 4);
+  assert_eq(result, NB_COLLECT_OK);
+  assert_eq(nb_block_count(&destination), block_count);
+
+  size_t index = 0;
+  for (uint32_t shard = 0; shard < shard_count; shard++) {
+    for (uint32_t i = 0; i < per_shard + shard * 1001; i++) {
+      assert_eq(*(uint32_t *) nb_at(&destination, index), (shard << 24) | i);
+      index++;
+    }
+  }
+
+  nb_release(&destination);
+  nb_sharded_buffer_destroy(buffer);
+}
+
+#define PRODUCERS 4
+#define RESULTS_PER_PRODUCER 50000
+
+struct producer {
+  struct nb_sharded_buffer * buffer;
+  uint32_t id;
+};
+
+static void produce(void * argument) {
+  struct producer * producer = argument;
+  struct nb_buffer * shard = nb_sharded_shard(producer->buffer, producer->id);
+  for (uint32_t i = 0; i < RESULTS_PER_PRODUCER; i++) {
+    uint32_t value = (producer->id * RESULTS_PER_PRODUCER) + i;
+    const enum NB_PUSH_RESULT result = nb_push(shard, &value);
+    assert_eq(result, NB_PUSH_OK);
+  }
+}
+
+void threads_push_to_their_own_shards() {
+  struct nb_sharded_buffer * buffer = nb_sharded_buffer_create(sizeof(uint32_t), PRODUCERS);
+  struct producer producers[PRODUCERS];
+  struct test_call calls[PRODUCERS];
+  test_thread threads[PRODUCERS];
+
+  for (uint32_t i = 0; i < PRODUCERS; i++) {
+    producers[i] = (struct producer) {buffer, i};
+    calls[i] = (struct test_call) {produce, &producers[i]};
+    test_thread_start(&threads[i], &calls[i]);
+  }
+  for (uint32_t i = 0; i < PRODUCERS; i++) test_thread_join(threads[i]);
+
+  struct nb_buffer destination;
+  nb_init(&destination, sizeof(uint32_t));
+  enum NB_COLLECT_RESULT result = nb_sharded_collect(buffer, &destination, 0);
+  assert_eq(result, NB_COLLECT_OK);
+  assert_eq(nb_block_count(&destination), PRODUCERS * RESULTS_PER_PRODUCER);
+  for (uint32_t i = 0; i < PRODUCERS * RESULTS_PER_PRODUCER; i++) assert_eq(*(uint32_t *) nb_at(&destination, i), i);
+
+  nb_release(&destination);
+  nb_sharded_buffer_destroy(buffer);
+}
+
+int main(void) {
+  sharded_buffer_has_independent_shards();
+  sharded_spans_point_into_the_shards();
+  sharded_collect_appends_in_shard_order();
+  sharded_collect_rejects_other_block_sizes();
+  large_shards_are_collected_by_several_threads();
+  threads_push_to_their_own_shards();
+
+  return 0;
+}
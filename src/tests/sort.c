@@ -1,5 +1,9 @@
 #include "naughty-buffers/buffer.h"
+#include "naughty-buffers/sort.h"
 #include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 
 #define assert_eq(a, b) assert((a) == (b))
 
@@ -11,6 +15,13 @@ int int_compare(const void * ptr_a, const void * ptr_b) {
   return (a < b ? -1 : (b < a ? 1 : 0));
 }
 
+// does not count calls, so it can be called from several threads
+int int_compare_parallel(const void * ptr_a, const void * ptr_b) {
+  int a = *((int *)ptr_a);
+  int b = *((int *)ptr_b);
+  return (a < b ? -1 : (b < a ? 1 : 0));
+}
+
 int read_int(const struct nb_buffer * buffer, size_t index) {
   int * read_value = nb_at(buffer, index);
   return *read_value;
@@ -77,9 +88,300 @@ void sort_calls_compare_fn() {
   nb_release(&buffer);
 }
 
+struct keyed {
+  uint32_t sequence;
+  int16_t small;
+  uint64_t big;
+  float real;
+  double precise;
+};
+
+void sort_by_key_sorts_every_key_type() {
+  struct nb_buffer buffer;
+  nb_init(&buffer, sizeof(struct keyed));
+
+  srand(7);
+  for (uint32_t i = 0; i < 5000; i++) {
+    struct keyed item = {
+        .sequence = i,
+        .small = (int16_t)(rand() % 2001 - 1000),
+        .big = ((uint64_t)rand() << 40) ^ (uint64_t)rand(),
+        .real = (float)(rand() % 2001 - 1000) / 7.0f,
+        .precise = (double)(rand() % 2001 - 1000) * 1e10
+    };
+    nb_push(&buffer, &item);
+  }
+
+  enum NB_SORT_RESULT result = nb_sort_by_key(&buffer, offsetof(struct keyed, small), 2, NB_KEY_SIGNED);
+  assert_eq(result, NB_SORT_OK);
+  for (size_t i = 1; i < 5000; i++) {
+    const struct keyed * a = nb_at(&buffer, i - 1);
+    const struct keyed * b = nb_at(&buffer, i);
+    assert(a->small <= b->small);
+    if (a->small == b->small) assert(a->sequence < b->sequence);
+  }
+
+  result = nb_sort_by_key(&buffer, offsetof(struct keyed, big), 8, NB_KEY_UNSIGNED);
+  assert_eq(result, NB_SORT_OK);
+  for (size_t i = 1; i < 5000; i++) {
+    assert(((struct keyed *)nb_at(&buffer, i - 1))->big <= ((struct keyed *)nb_at(&buffer, i))->big);
+  }
+
+  result = nb_sort_by_key(&buffer, offsetof(struct keyed, real), 4, NB_KEY_FLOAT);
+  assert_eq(result, NB_SORT_OK);
+  for (size_t i = 1; i < 5000; i++) {
+    assert(((struct keyed *)nb_at(&buffer, i - 1))->real <= ((struct keyed *)nb_at(&buffer, i))->real);
+  }
+
+  result = nb_sort_by_key(&buffer, offsetof(struct keyed, precise), 8, NB_KEY_FLOAT);
+  assert_eq(result, NB_SORT_OK);
+  for (size_t i = 1; i < 5000; i++) {
+    assert(((struct keyed *)nb_at(&buffer, i - 1))->precise <= ((struct keyed *)nb_at(&buffer, i))->precise);
+  }
+
+  result = nb_sort_by_key(&buffer, offsetof(struct keyed, sequence), 4, NB_KEY_UNSIGNED);
+  assert_eq(result, NB_SORT_OK);
+  for (uint32_t i = 0; i < 5000; i++) assert_eq(((struct keyed *)nb_at(&buffer, i))->sequence, i);
+
+  nb_release(&buffer);
+}
+
+void sort_by_key_rejects_invalid_keys() {
+  struct nb_buffer buffer;
+  nb_init(&buffer, sizeof(uint32_t));
+
+  uint32_t value = 1;
+  nb_push(&buffer, &value);
+  enum NB_SORT_RESULT result = nb_sort_by_key(&buffer, 0, 3, NB_KEY_UNSIGNED);
+  assert_eq(result, NB_SORT_INVALID_KEY);
+  result = nb_sort_by_key(&buffer, 0, 2, NB_KEY_FLOAT);
+  assert_eq(result, NB_SORT_INVALID_KEY);
+  result = nb_sort_by_key(&buffer, 2, 4, NB_KEY_UNSIGNED);
+  assert_eq(result, NB_SORT_INVALID_KEY);
+  result = nb_sort_by_key(&buffer, 3, 1, NB_KEY_UNSIGNED);
+  assert_eq(result, NB_SORT_OK);
+
+  nb_release(&buffer);
+}
+
+void sort_parallel_sorts() {
+  struct nb_buffer buffer;
+  struct nb_buffer expected;
+  nb_init(&buffer, sizeof(int));
+  nb_init(&expected, sizeof(int));
+
+  // odd and even thread counts, plus a buffer too small to be sorted in parallel
+  const size_t thread_counts[] = {2, 3, 8, 0};
+  const size_t block_counts[] = {NB_PARALLEL_SORT_THRESHOLD * 3 + 7, 100};
+  for (size_t c = 0; c < 2; c++) {
+    for (size_t t = 0; t < 4; t++) {
+      srand((unsigned)t);
+      for (size_t i = 0; i < block_counts[c]; i++) {
+        int value = rand() % 50000;
+        nb_push(&buffer, &value);
+        nb_push(&expected, &value);
+      }
+
+      const enum NB_SORT_RESULT result = nb_sort_parallel(&buffer, int_compare_parallel, thread_counts[t]);
+      assert_eq(result, NB_SORT_OK);
+      nb_sort(&expected, int_compare);
+      assert_eq(nb_block_count(&buffer), block_counts[c]);
+      for (size_t i = 0; i < block_counts[c]; i++) assert_eq(read_int(&buffer, i), read_int(&expected, i));
+
+      nb_remove_range(&buffer, 0, block_counts[c]);
+      nb_remove_range(&expected, 0, block_counts[c]);
+    }
+  }
+
+  nb_release(&buffer);
+  nb_release(&expected);
+}
+
+struct record {
+  uint32_t key;
+  uint32_t sequence;
+  uint8_t payload[200];
+};
+
+int record_compare(const void * ptr_a, const void * ptr_b) {
+  const struct record * a = ptr_a;
+  const struct record * b = ptr_b;
+  return (a->key > b->key) - (a->key < b->key);
+}
+
+void argsort_and_apply_permutation_sort() {
+  struct nb_buffer buffer;
+  nb_init(&buffer, sizeof(struct record));
+
+  const size_t count = 3000;
+  srand(11);
+  for (uint32_t i = 0; i < count; i++) {
+    struct record item = {.key = (uint32_t)(rand() % 100), .sequence = i};
+    memset(item.payload, (int)(i & 0xFF), sizeof(item.payload));
+    nb_push(&buffer, &item);
+  }
+
+  size_t * indices = malloc(count * sizeof(size_t));
+  enum NB_SORT_RESULT result = nb_argsort(&buffer, record_compare, indices);
+  assert_eq(result, NB_SORT_OK);
+
+  // blocks did not move, and indices list them in order with ties in their original order
+  for (uint32_t i = 0; i < count; i++) assert_eq(((struct record *)nb_at(&buffer, i))->sequence, i);
+  for (size_t i = 1; i < count; i++) {
+    const struct record * a = nb_at(&buffer, indices[i - 1]);
+    const struct record * b = nb_at(&buffer, indices[i]);
+    assert(a->key <= b->key);
+    if (a->key == b->key) assert(a->sequence < b->sequence);
+  }
+
+  result = nb_apply_permutation(&buffer, indices);
+  assert_eq(result, NB_SORT_OK);
+  for (size_t i = 0; i < count; i++) {
+    const struct record * item = nb_at(&buffer, i);
+    assert_eq(item->sequence, indices[i]);
+    assert_eq(item->payload[199], (uint8_t)(indices[i] & 0xFF));
+  }
+
+  free(indices);
+  nb_release(&buffer);
+}
+
+void check_stable_order(struct nb_buffer * buffer, size_t count) {
+  assert_eq(nb_block_count(buffer), count);
+  for (size_t i = 1; i < count; i++) {
+    const struct record * a = nb_at(buffer, i - 1);
+    const struct record * b = nb_at(buffer, i);
+    assert(a->key <= b->key);
+    if (a->key == b->key) assert(a->sequence < b->sequence);
+  }
+}
+
+void stable_sort_keeps_equal_blocks_in_order() {
+  struct nb_buffer buffer;
+  struct nb_buffer scratch;
+  nb_init(&buffer, sizeof(struct record));
+  nb_init(&scratch, sizeof(int));
+
+  // random, few distinct keys, sorted, reversed and sorted with a shuffled tail
+  const size_t count = 5000;
+  for (int round = 0; round < 5; round++) {
+    srand((unsigned)round);
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t key = (uint32_t)rand();
+      if (round == 1) key %= 7;
+      if (round == 2 || (round == 4 && i < count - 50)) key = i / 3;
+      if (round == 3) key = (uint32_t)(count - i) / 3;
+      struct record item = {.key = key, .sequence = i};
+      nb_push(&buffer, &item);
+    }
+
+    const enum NB_SORT_RESULT result = nb_stable_sort(&buffer, record_compare, round % 2 ? &scratch : NULL);
+    assert_eq(result, NB_SORT_OK);
+    check_stable_order(&buffer, count);
+    nb_remove_range(&buffer, 0, count);
+  }
+
+  // the scratch area is kept for the next sorts
+  assert(nb_block_capacity(&scratch) * sizeof(int) >= count / 2 * sizeof(struct record));
+  assert_eq(nb_block_count(&scratch), 0);
+
+  nb_release(&scratch);
+  nb_release(&buffer);
+}
+
+int is_odd(const void * block, void * context) {
+  (void)context;
+  return *(const int *)block % 2 != 0;
+}
+
+void sorted_count_follows_modifications() {
+  struct nb_buffer buffer;
+  nb_init(&buffer, sizeof(int));
+  for (int i = 0; i < 20; i++) nb_push(&buffer, &i);
+  assert_eq(nb_sorted_count(&buffer), 0);
+
+  nb_sort(&buffer, int_compare);
+  assert_eq(nb_sorted_count(&buffer), 20);
+
+  int value = 100;
+  nb_push(&buffer, &value);
+  assert_eq(nb_sorted_count(&buffer), 20);
+
+  nb_remove_front(&buffer);
+  assert_eq(nb_sorted_count(&buffer), 19);
+
+  nb_remove_range(&buffer, 15, 10);
+  assert_eq(nb_sorted_count(&buffer), 15);
+
+  size_t indices[] = {0, 14};
+  nb_remove_indices(&buffer, indices, 2);
+  assert_eq(nb_sorted_count(&buffer), 13);
+
+  nb_remove_if(&buffer, is_odd, NULL);
+  assert_eq(nb_block_count(&buffer), 7);
+  assert_eq(nb_sorted_count(&buffer), 7);
+
+  nb_insert(&buffer, 5, &value);
+  assert_eq(nb_sorted_count(&buffer), 5);
+
+  nb_assign(&buffer, 3, &value);
+  assert_eq(nb_sorted_count(&buffer), 3);
+
+  nb_swap_remove(&buffer, 1);
+  assert_eq(nb_sorted_count(&buffer), 1);
+
+  nb_push_front(&buffer, &value);
+  assert_eq(nb_sorted_count(&buffer), 0);
+
+  nb_set_sorted_count(&buffer, 1000);
+  assert_eq(nb_sorted_count(&buffer), nb_block_count(&buffer));
+
+  nb_release(&buffer);
+}
+
+void sort_incremental_sorts_the_tail_and_merges_it() {
+  struct nb_buffer buffer;
+  struct nb_buffer expected;
+  nb_init(&buffer, sizeof(struct record));
+  nb_init(&expected, sizeof(struct record));
+
+  srand(5);
+  uint32_t sequence = 0;
+  for (int round = 0; round < 20; round++) {
+    const size_t appended = round == 0 ? 2000 : (size_t)(rand() % 300);
+    for (size_t i = 0; i < appended; i++) {
+      struct record item = {.key = (uint32_t)(rand() % 500), .sequence = sequence++};
+      nb_push(&buffer, &item);
+      nb_push(&expected, &item);
+    }
+    if (round % 5 == 4) nb_remove_range(&buffer, 10, 100);
+    if (round % 5 == 4) nb_remove_range(&expected, 10, 100);
+
+    enum NB_SORT_RESULT result = nb_sort_incremental(&buffer, record_compare);
+    assert_eq(result, NB_SORT_OK);
+    result = nb_stable_sort(&expected, record_compare, NULL);
+    assert_eq(result, NB_SORT_OK);
+    assert_eq(nb_sorted_count(&buffer), nb_block_count(&buffer));
+    check_stable_order(&buffer, nb_block_count(&expected));
+    for (size_t i = 0; i < nb_block_count(&buffer); i++) {
+      assert_eq(((struct record *)nb_at(&buffer, i))->sequence, ((struct record *)nb_at(&expected, i))->sequence);
+    }
+  }
+
+  nb_release(&buffer);
+  nb_release(&expected);
+}
+
 int main(void) {
   sort_sorts();
   sort_calls_compare_fn();
+  sort_by_key_sorts_every_key_type();
+  sort_by_key_rejects_invalid_keys();
+  sort_parallel_sorts();
+  argsort_and_apply_permutation_sort();
+  stable_sort_keeps_equal_blocks_in_order();
+  sorted_count_follows_modifications();
+  sort_incremental_sorts_the_tail_and_merges_it();
 
   return 0;
 }
\ No newline at end of file
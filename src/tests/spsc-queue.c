@@ -0,0 +1,224 @@
+#include "naughty-buffers/queue.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test-thread.h"
+
+#define assert_eq(a, b) assert((a) == (b))
+
+struct message {
+  uint64_t sequence;
+  uint64_t check;
+  uint8_t payload[16];
+};
+
+static uint64_t message_check(uint64_t sequence) { return sequence * 0x9E3779B97F4A7C15ull; }
+
+size_t alloc_call_count = 0;
+size_t release_call_count = 0;
+
+void * counting_alloc(size_t size, void * _) {
+  (void) _;
+  alloc_call_count++;
+  return malloc(size);
+}
+
+void * counting_realloc(void * ptr, size_t size, void * _) {
+  (void) _;
+  if (ptr == NULL) alloc_call_count++;
+  return realloc(ptr, size);
+}
+
+void counting_release(void * ptr, void * _) {
+  (void) _;
+  if (ptr != NULL) release_call_count++;
+  free(ptr);
+}
+
+void * counting_copy(void * destination, const void * source, size_t size, void * _) {
+  (void) _;
+  return memcpy(destination, source, size);
+}
+
+void * counting_move(void * destination, const void * source, size_t size, void * _) {
+  (void) _;
+  return memmove(destination, source, size);
+}
+
+void queue_capacity_is_rounded_up() {
+  struct nb_spsc_queue * queue = nb_spsc_queue_create(sizeof(int), 5);
+  assert(queue != NULL);
+  assert_eq(nb_spsc_queue_capacity(queue), 8);
+  nb_spsc_queue_destroy(queue);
+
+  queue = nb_spsc_queue_create(sizeof(int), 0);
+  assert(queue != NULL);
+  assert_eq(nb_spsc_queue_capacity(queue), 1);
+  nb_spsc_queue_destroy(queue);
+
+  queue = nb_spsc_queue_create(sizeof(int), 64);
+  assert_eq(nb_spsc_queue_capacity(queue), 64);
+  nb_spsc_queue_destroy(queue);
+
+  queue = nb_spsc_queue_create(sizeof(int), SIZE_MAX);
+  assert(queue == NULL);
+}
+
+void queue_keeps_blocks_in_order() {
+  struct nb_spsc_queue * queue = nb_spsc_queue_create(sizeof(int), 4);
+  int value = 0;
+
+  enum NB_DEQUEUE_RESULT dequeue_result = nb_spsc_dequeue(queue, &value);
+  assert_eq(dequeue_result, NB_DEQUEUE_EMPTY);
+  enum NB_ENQUEUE_RESULT enqueue_result;
+  for (int i = 0; i < 4; i++) {
+    enqueue_result = nb_spsc_enqueue(queue, &i);
+    assert_eq(enqueue_result, NB_ENQUEUE_OK);
+  }
+  value = 4;
+  enqueue_result = nb_spsc_enqueue(queue, &value);
+  assert_eq(enqueue_result, NB_ENQUEUE_FULL);
+
+  for (int i = 0; i < 4; i++) {
+    dequeue_result = nb_spsc_dequeue(queue, &value);
+    assert_eq(dequeue_result, NB_DEQUEUE_OK);
+    assert_eq(value, i);
+  }
+  dequeue_result = nb_spsc_dequeue(queue, &value);
+  assert_eq(dequeue_result, NB_DEQUEUE_EMPTY);
+
+  nb_spsc_queue_destroy(queue);
+}
+
+void queue_batches_wrap_around() {
+  struct nb_spsc_queue * queue = nb_spsc_queue_create(sizeof(int), 8);
+  int in[20];
+  int out[20];
+  for (int i = 0; i < 20; i++) in[i] = i;
+
+  // moves the indices to the middle of the ring so the next batches wrap around its end
+  size_t moved = nb_spsc_enqueue_many(queue, in, 5);
+  assert_eq(moved, 5);
+  moved = nb_spsc_dequeue_many(queue, out, 5);
+  assert_eq(moved, 5);
+
+  moved = nb_spsc_enqueue_many(queue, in, 20);
+  assert_eq(moved, 8);
+  moved = nb_spsc_enqueue_many(queue, in, 1);
+  assert_eq(moved, 0);
+  moved = nb_spsc_dequeue_many(queue, out, 3);
+  assert_eq(moved, 3);
+  for (int i = 0; i < 3; i++) assert_eq(out[i], i);
+
+  moved = nb_spsc_enqueue_many(queue, in + 8, 12);
+  assert_eq(moved, 3);
+  moved = nb_spsc_dequeue_many(queue, out, 20);
+  assert_eq(moved, 8);
+  for (int i = 0; i < 8; i++) assert_eq(out[i], i + 3);
+  moved = nb_spsc_dequeue_many(queue, out, 20);
+  assert_eq(moved, 0);
+
+  nb_spsc_queue_destroy(queue);
+}
+
+void queue_uses_the_memory_context() {
+  struct nb_buffer_memory_context memory_context = {
+      .alloc_fn = counting_alloc,
+      .realloc_fn = counting_realloc,
+      .free_fn = counting_release,
+      .copy_fn = counting_copy,
+      .move_fn = counting_move,
+      .context = NULL
+  };
+
+  struct nb_spsc_queue * queue = nb_spsc_queue_create_advanced(sizeof(struct message), 100, &memory_context);
+  assert(queue != NULL);
+  assert_eq(nb_spsc_queue_capacity(queue), 128);
+  assert(alloc_call_count >= 2);
+
+  struct message message = {1, message_check(1), {0}};
+  const enum NB_ENQUEUE_RESULT enqueue_result = nb_spsc_enqueue(queue, &message);
+  assert_eq(enqueue_result, NB_ENQUEUE_OK);
+  const enum NB_DEQUEUE_RESULT dequeue_result = nb_spsc_dequeue(queue, &message);
+  assert_eq(dequeue_result, NB_DEQUEUE_OK);
+  assert_eq(message.check, message_check(1));
+
+  nb_spsc_queue_destroy(queue);
+  assert_eq(alloc_call_count, release_call_count);
+}
+
+#define STRESS_MESSAGES 2000000
+
+// batch sizes follow a small xorshift sequence so both sides keep catching the ring full, empty and wrapping around
+static size_t next_batch(uint32_t * state, size_t max) {
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return 1 + (*state % max);
+}
+
+static void stress_producer(void * argument) {
+  struct nb_spsc_queue * queue = argument;
+  struct message batch[37];
+  uint32_t state = 12345;
+  uint64_t sequence = 0;
+
+  while (sequence < STRESS_MESSAGES) {
+    size_t count = next_batch(&state, 37);
+    if (count > STRESS_MESSAGES - sequence) count = (size_t) (STRESS_MESSAGES - sequence);
+    for (size_t i = 0; i < count; i++) {
+      batch[i].sequence = sequence + i;
+      batch[i].check = message_check(sequence + i);
+      memset(batch[i].payload, (int) ((sequence + i) & 0xFF), sizeof(batch[i].payload));
+    }
+
+    size_t sent = 0;
+    while (sent < count) {
+      size_t enqueued;
+      if (count - sent == 1) enqueued = nb_spsc_enqueue(queue, &batch[sent]) == NB_ENQUEUE_OK;
+      else enqueued = nb_spsc_enqueue_many(queue, &batch[sent], count - sent);
+      if (enqueued == 0) test_thread_yield();
+      sent += enqueued;
+    }
+    sequence += count;
+  }
+}
+
+void queue_survives_concurrent_use() {
+  struct nb_spsc_queue * queue = nb_spsc_queue_create(sizeof(struct message), 64);
+  struct test_call call = {stress_producer, queue};
+  test_thread producer;
+  test_thread_start(&producer, &call);
+
+  struct message batch[29];
+  uint32_t state = 54321;
+  uint64_t expected = 0;
+  while (expected < STRESS_MESSAGES) {
+    size_t count = nb_spsc_dequeue_many(queue, batch, next_batch(&state, 29));
+    if (count == 0) test_thread_yield();
+    for (size_t i = 0; i < count; i++) {
+      assert_eq(batch[i].sequence, expected);
+      assert_eq(batch[i].check, message_check(expected));
+      assert_eq(batch[i].payload[15], (uint8_t) (expected & 0xFF));
+      expected++;
+    }
+  }
+
+  test_thread_join(producer);
+  struct message message;
+  const enum NB_DEQUEUE_RESULT result = nb_spsc_dequeue(queue, &message);
+  assert_eq(result, NB_DEQUEUE_EMPTY);
+  nb_spsc_queue_destroy(queue);
+}
+
+int main(void) {
+  queue_capacity_is_rounded_up();
+  queue_keeps_blocks_in_order();
+  queue_batches_wrap_around();
+  queue_uses_the_memory_context();
+  queue_survives_concurrent_use();
+
+  return 0;
+}
@@ -0,0 +1,67 @@
+#ifndef NAUGHTY_BUFFERS_TEST_THREAD_H
+#define NAUGHTY_BUFFERS_TEST_THREAD_H
+
+#include <assert.h>
+
+// just enough of pthreads and Win32 threads (and a clock) for the tests that need more than one thread
+
+struct test_call {
+  void (*fn)(void *);
+  void * argument;
+};
+
+#if defined(_WIN32)
+#include <windows.h>
+
+typedef HANDLE test_thread;
+
+static inline DWORD WINAPI test_thread_entry(LPVOID argument) {
+  struct test_call * call = argument;
+  call->fn(call->argument);
+  return 0;
+}
+
+static inline void test_thread_start(test_thread * thread, struct test_call * call) {
+  *thread = CreateThread(NULL, 0, test_thread_entry, call, 0, NULL);
+  assert(*thread != NULL);
+}
+
+static inline void test_thread_join(test_thread thread) {
+  WaitForSingleObject(thread, INFINITE);
+  CloseHandle(thread);
+}
+
+static inline void test_thread_yield(void) { SwitchToThread(); }
+
+static inline unsigned long long test_clock_ms(void) { return GetTickCount64(); }
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+typedef pthread_t test_thread;
+
+static inline void * test_thread_entry(void * argument) {
+  struct test_call * call = argument;
+  call->fn(call->argument);
+  return NULL;
+}
+
+static inline void test_thread_start(test_thread * thread, struct test_call * call) {
+  int result = pthread_create(thread, NULL, test_thread_entry, call);
+  assert(result == 0);
+  (void) result;
+}
+
+static inline void test_thread_join(test_thread thread) { pthread_join(thread, NULL); }
+
+static inline void test_thread_yield(void) { sched_yield(); }
+
+static inline unsigned long long test_clock_ms(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (unsigned long long) now.tv_sec * 1000 + (unsigned long long) now.tv_nsec / 1000000;
+}
+#endif
+
+#endif // NAUGHTY_BUFFERS_TEST_THREAD_H
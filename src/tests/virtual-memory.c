@@ -0,0 +1,213 @@
+#include "naughty-buffers/virtual-memory.h"
+#include "naughty-buffers/sort.h"
+#include <assert.h>
+#include <stdio.h>
+
+#define assert_eq(a, b) assert((a) == (b))
+
+void remap_small_buffers_work() {
+  struct nb_buffer buffer;
+  nb_init_advanced(&buffer, sizeof(uint32_t), nb_remap_memory_context());
+
+  for (uint32_t i = 0; i < 1000; i++) nb_push(&buffer, &i);
+  for (uint32_t i = 0; i < 1000; i++) assert_eq(*(uint32_t *)nb_at(&buffer, i), i);
+
+  nb_release(&buffer);
+}
+
+void remap_large_buffers_keep_values_across_growth() {
+  struct nb_buffer buffer;
+  nb_init_advanced(&buffer, sizeof(uint64_t), nb_remap_memory_context());
+
+  const uint64_t count = (NB_REMAP_THRESHOLD / sizeof(uint64_t)) * 8;
+  for (uint64_t i = 0; i < count; i++) nb_push(&buffer, &i);
+  for (uint64_t i = 0; i < count; i += 997) assert_eq(*(uint64_t *)nb_at(&buffer, i), i);
+  assert_eq(*(uint64_t *)nb_back(&buffer), count - 1);
+
+  nb_pop_many(&buffer, NULL, count - 10);
+  const enum NB_SHRINK_RESULT result = nb_shrink_to_fit(&buffer);
+  assert_eq(result, NB_SHRINK_OK);
+  for (uint64_t i = 0; i < 10; i++) assert_eq(*(uint64_t *)nb_at(&buffer, i), i);
+
+  nb_release(&buffer);
+}
+
+void remap_usable_size_is_reported() {
+  struct nb_buffer_memory_context * ctx = nb_remap_memory_context();
+
+  void * ptr = ctx->alloc_fn(100, ctx->context);
+  assert(ctx->usable_size_fn(ptr, ctx->context) >= 100);
+  ptr = ctx->realloc_fn(ptr, NB_REMAP_THRESHOLD + 1, ctx->context);
+  assert(ctx->usable_size_fn(ptr, ctx->context) >= NB_REMAP_THRESHOLD + 1);
+  ctx->free_fn(ptr, ctx->context);
+}
+
+void reserved_buffers_keep_their_address() {
+  struct nb_reserved_memory reserved;
+  nb_reserved_memory_init(&reserved, (size_t) 64 << 20);
+
+  struct nb_buffer buffer;
+  nb_init_advanced(&buffer, sizeof(uint64_t), &reserved.memory_context);
+
+  uint64_t value = 0;
+  nb_push(&buffer, &value);
+  uint64_t * first = nb_front(&buffer);
+
+  for (uint64_t i = 1; i < 1000000; i++) nb_push(&buffer, &i);
+  assert(first == nb_front(&buffer));
+  for (uint64_t i = 0; i < 1000000; i += 997) assert_eq(first[i], i);
+
+  nb_pop_many(&buffer, NULL, 1000000 - 10);
+  const enum NB_SHRINK_RESULT result = nb_shrink_to_fit(&buffer);
+  assert_eq(result, NB_SHRINK_OK);
+  assert(first == nb_front(&buffer));
+  for (uint64_t i = 0; i < 10; i++) assert_eq(first[i], i);
+
+  nb_release(&buffer);
+}
+
+void reserved_buffers_do_not_slide_removed_room() {
+  struct nb_reserved_memory reserved;
+  nb_reserved_memory_init(&reserved, (size_t) 64 << 20);
+
+  struct nb_buffer buffer;
+  nb_init_advanced(&buffer, sizeof(uint64_t), &reserved.memory_context);
+  for (uint64_t i = 0; i < 1000; i++) nb_push(&buffer, &i);
+  nb_remove_range(&buffer, 0, 600);
+  uint64_t * first = nb_front(&buffer);
+
+  // the room left by the removed blocks is larger than the blocks left, which would slide them back
+  const size_t block_capacity = nb_block_capacity(&buffer);
+  for (uint64_t i = 1000; nb_block_count(&buffer) <= block_capacity; i++) nb_push(&buffer, &i);
+  assert(first == nb_front(&buffer));
+  assert_eq(*first, 600);
+
+  const enum NB_RESERVE_RESULT reserve_result = nb_reserve(&buffer, nb_block_count(&buffer) * 4);
+  assert_eq(reserve_result, NB_RESERVE_OK);
+  assert(first == nb_front(&buffer));
+  const enum NB_SHRINK_RESULT shrink_result = nb_shrink_to_fit(&buffer);
+  assert_eq(shrink_result, NB_SHRINK_OK);
+  assert(first == nb_front(&buffer));
+  for (uint64_t i = 0; i < nb_block_count(&buffer); i++) assert_eq(first[i], i + 600);
+
+  nb_release(&buffer);
+}
+
+void reserved_buffers_fail_past_the_reservation() {
+  struct nb_reserved_memory reserved;
+  nb_reserved_memory_init(&reserved, 1 << 20);
+
+  struct nb_buffer buffer;
+  nb_init_advanced(&buffer, 1, &reserved.memory_context);
+
+  // the growth policy asks for more than the reservation; the buffer still fills it up to the last byte
+  uint8_t value = 42;
+  size_t pushed = 0;
+  while (nb_push(&buffer, &value) == NB_PUSH_OK) pushed++;
+  assert(pushed >= 1 << 20);
+  assert(pushed < (1 << 20) + (1 << 16));
+  assert_eq(nb_block_count(&buffer), pushed);
+  assert_eq(*(uint8_t *)nb_back(&buffer), 42);
+
+  nb_release(&buffer);
+}
+
+#if !defined(_WIN32)
+void mapped_buffers_survive_reopening() {
+  const char * path = "test-virtual-memory-mapped.nb";
+  struct nb_buffer buffer;
+  enum NB_MAP_RESULT map_result = nb_init_mapped(&buffer, sizeof(uint32_t), path, NB_MAP_CREATE | NB_MAP_TRUNCATE);
+  assert_eq(map_result, NB_MAP_OK);
+  assert_eq(nb_block_count(&buffer), 0);
+
+  for (uint32_t i = 0; i < 100000; i++) nb_push(&buffer, &i);
+  const enum NB_SYNC_RESULT sync_result = nb_sync(&buffer);
+  assert_eq(sync_result, NB_SYNC_OK);
+  nb_release(&buffer);
+
+  map_result = nb_init_mapped(&buffer, sizeof(uint32_t), path, 0);
+  assert_eq(map_result, NB_MAP_OK);
+  assert_eq(nb_block_count(&buffer), 100000);
+  for (uint32_t i = 0; i < 100000; i += 7) assert_eq(*(uint32_t *)nb_at(&buffer, i), i);
+
+  nb_pop_many(&buffer, NULL, 100000 - 10);
+  const enum NB_SHRINK_RESULT shrink_result = nb_shrink_to_fit(&buffer);
+  assert_eq(shrink_result, NB_SHRINK_OK);
+  uint32_t value = 1234;
+  nb_push(&buffer, &value);
+  nb_release(&buffer);
+
+  map_result = nb_init_mapped(&buffer, sizeof(uint32_t), path, 0);
+  assert_eq(map_result, NB_MAP_OK);
+  assert_eq(nb_block_count(&buffer), 11);
+  for (uint32_t i = 0; i < 10; i++) assert_eq(*(uint32_t *)nb_at(&buffer, i), i);
+  assert_eq(*(uint32_t *)nb_back(&buffer), 1234);
+  nb_pop_front(&buffer, NULL);
+  nb_pop_front(&buffer, NULL);
+  nb_release(&buffer);
+
+  map_result = nb_init_mapped(&buffer, sizeof(uint32_t), path, 0);
+  assert_eq(map_result, NB_MAP_OK);
+  assert_eq(nb_block_count(&buffer), 9);
+  assert_eq(*(uint32_t *)nb_front(&buffer), 2);
+  assert_eq(*(uint32_t *)nb_back(&buffer), 1234);
+  nb_release(&buffer);
+
+  map_result = nb_init_mapped(&buffer, sizeof(uint64_t), path, 0);
+  assert_eq(map_result, NB_MAP_INVALID_FILE);
+  remove(path);
+  map_result = nb_init_mapped(&buffer, sizeof(uint32_t), path, 0);
+  assert_eq(map_result, NB_MAP_IO_ERROR);
+  map_result = nb_init_mapped(&buffer, 0, path, NB_MAP_CREATE);
+  assert_eq(map_result, NB_MAP_INVALID_FILE);
+}
+
+static int uint32_compare(const void * a, const void * b) {
+  const uint32_t x = *(const uint32_t *) a;
+  const uint32_t y = *(const uint32_t *) b;
+  return (x > y) - (x < y);
+}
+
+void mapped_buffers_can_be_sorted() {
+  const char * path = "test-virtual-memory-sorted.nb";
+  struct nb_buffer buffer;
+  enum NB_MAP_RESULT map_result = nb_init_mapped(&buffer, sizeof(uint32_t), path, NB_MAP_CREATE | NB_MAP_TRUNCATE);
+  assert_eq(map_result, NB_MAP_OK);
+
+  // both sorts take scratch memory from the buffer memory context
+  for (uint32_t i = 0; i < 5000; i++) {
+    uint32_t value = 5000 - i;
+    nb_push(&buffer, &value);
+  }
+  enum NB_SORT_RESULT sort_result = nb_sort_by_key(&buffer, 0, sizeof(uint32_t), NB_KEY_UNSIGNED);
+  assert_eq(sort_result, NB_SORT_OK);
+  for (uint32_t i = 0; i < 5000; i++) assert_eq(*(uint32_t *)nb_at(&buffer, i), i + 1);
+
+  for (uint32_t i = 0; i < 5000; i++) *(uint32_t *)nb_at(&buffer, i) = (i * 7919) % 5000;
+  sort_result = nb_stable_sort(&buffer, uint32_compare, NULL);
+  assert_eq(sort_result, NB_SORT_OK);
+  nb_release(&buffer);
+
+  map_result = nb_init_mapped(&buffer, sizeof(uint32_t), path, 0);
+  assert_eq(map_result, NB_MAP_OK);
+  assert_eq(nb_block_count(&buffer), 5000);
+  for (uint32_t i = 0; i < 5000; i++) assert_eq(*(uint32_t *)nb_at(&buffer, i), i);
+  nb_release(&buffer);
+  remove(path);
+}
+#endif
+
+int main(void) {
+  remap_small_buffers_work();
+  remap_large_buffers_keep_values_across_growth();
+  remap_usable_size_is_reported();
+  reserved_buffers_keep_their_address();
+  reserved_buffers_do_not_slide_removed_room();
+  reserved_buffers_fail_past_the_reservation();
+#if !defined(_WIN32)
+  mapped_buffers_survive_reopening();
+  mapped_buffers_can_be_sorted();
+#endif
+
+  return 0;
+}